@@ -0,0 +1,61 @@
+#include "kwa_core/batch_estimation.h"
+#include "calculations.h"
+#include "benchmark/benchmark.h"
+#include <random>
+
+namespace {
+const kwa::BetSystemPoints SYSTEM_POINTS{4.0f, 3.0f, 2.0f};
+const size_t MATCH_COUNT = 1024;
+
+void randomEvs(std::vector<float>& home_evs, std::vector<float>& guest_evs)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> ev_distr(0.3f, 3.5f);
+    for (size_t i = 0; i < MATCH_COUNT; ++i) {
+        home_evs.push_back(ev_distr(rng));
+        guest_evs.push_back(ev_distr(rng));
+    }
+}
+
+void BM_SingleEstimations(benchmark::State& state)
+{
+    std::vector<float> home_evs, guest_evs;
+    randomEvs(home_evs, guest_evs);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < MATCH_COUNT; ++i) {
+            kwa::GoalDistribution home_distr, guest_distr;
+            kwa::FillPoissonDistribution(home_distr, home_evs[i]);
+            kwa::FillPoissonDistribution(guest_distr, guest_evs[i]);
+            kwa::ScoreMatrix scores;
+            kwa::FillScoreMatrix(scores, home_distr, guest_distr, home_evs[i], guest_evs[i]);
+            benchmark::DoNotOptimize(kwa::CalculateThreeWayBet(scores));
+            benchmark::DoNotOptimize(kwa::CalculateBestBet(scores, SYSTEM_POINTS));
+        }
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * MATCH_COUNT));
+}
+BENCHMARK(BM_SingleEstimations);
+
+void BM_EstimateBatch(benchmark::State& state)
+{
+    auto kernel = (kwa::eBatchKernel)state.range(0);
+    if (!kwa::IsBatchKernelSupported(kernel)) {
+        state.SkipWithError("kernel not supported");
+        return;
+    }
+    std::vector<float> home_evs, guest_evs;
+    randomEvs(home_evs, guest_evs);
+    kwa::MatchEstimationBatch batch;
+
+    for (auto _ : state) {
+        kwa::EstimateBatch(home_evs, guest_evs, SYSTEM_POINTS, batch, kernel);
+        benchmark::DoNotOptimize(batch.best_result_bet_ev.data());
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * MATCH_COUNT));
+}
+BENCHMARK(BM_EstimateBatch)
+    ->Arg(kwa::BATCH_KERNEL_SCALAR)
+    ->Arg(kwa::BATCH_KERNEL_SSE2)
+    ->Arg(kwa::BATCH_KERNEL_AVX2);
+} // namespace
@@ -0,0 +1,104 @@
+#include "calculations.h"
+#include "estimation_table.h"
+#include "benchmark/benchmark.h"
+#include <algorithm>
+
+namespace {
+const kwa::BetSystemPoints SYSTEM_POINTS{4.0f, 3.0f, 2.0f};
+
+void BM_CalculateBetEV_all_results(benchmark::State& state)
+{
+    kwa::GoalDistribution home_distr, guest_distr;
+    kwa::FillPoissonDistribution(home_distr, 1.6f);
+    kwa::FillPoissonDistribution(guest_distr, 1.1f);
+
+    for (auto _ : state) {
+        float best = 0.0f;
+        for (int i = 0; i < (int)home_distr.size(); ++i) {
+            for (int j = 0; j < (int)guest_distr.size(); ++j) {
+                best = std::max(best, kwa::CalculateBetEV(i, j, home_distr, guest_distr, 1.6f,
+                                                          1.1f, SYSTEM_POINTS));
+            }
+        }
+        benchmark::DoNotOptimize(best);
+    }
+}
+BENCHMARK(BM_CalculateBetEV_all_results);
+
+void BM_CalculateBestBet(benchmark::State& state)
+{
+    kwa::GoalDistribution home_distr, guest_distr;
+    kwa::FillPoissonDistribution(home_distr, 1.6f);
+    kwa::FillPoissonDistribution(guest_distr, 1.1f);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            kwa::CalculateBestBet(home_distr, guest_distr, 1.6f, 1.1f, SYSTEM_POINTS));
+    }
+}
+BENCHMARK(BM_CalculateBestBet);
+
+void BM_EstimateLowScoringMatch(benchmark::State& state)
+{
+    const float epsilon = state.range(0) == 0 ? 0.0f : 1e-4f;
+    for (auto _ : state) {
+        kwa::GoalDistribution home_distr, guest_distr;
+        kwa::FillPoissonDistribution(home_distr, 1.1f);
+        kwa::FillPoissonDistribution(guest_distr, 0.8f);
+        int home_cap = (int)home_distr.size();
+        int guest_cap = (int)guest_distr.size();
+        if (epsilon > 0.0f) {
+            float tail;
+            home_cap = kwa::TruncateDistribution(home_distr, epsilon, tail);
+            guest_cap = kwa::TruncateDistribution(guest_distr, epsilon, tail);
+        }
+        kwa::ScoreMatrix scores;
+        kwa::FillScoreMatrix(scores, kwa::make_span(home_distr, home_cap),
+                             kwa::make_span(guest_distr, guest_cap), 1.1f, 0.8f);
+        benchmark::DoNotOptimize(kwa::CalculateThreeWayBet(scores));
+        benchmark::DoNotOptimize(kwa::CalculateBestBet(scores, SYSTEM_POINTS));
+    }
+}
+BENCHMARK(BM_EstimateLowScoringMatch)->Arg(0)->Arg(1);
+
+void BM_EstimationTable_lookup(benchmark::State& state)
+{
+    const bool interpolated = state.range(0) != 0;
+    auto table = kwa::EstimationTable::shared(SYSTEM_POINTS);
+    float lambda = 0.3f;
+    for (auto _ : state) {
+        kwa::EstimationTable::Entry entry;
+        if (interpolated)
+            table->lookupInterpolated(lambda, 1.3f, entry);
+        else
+            table->lookupNearest(lambda, 1.3f, entry);
+        benchmark::DoNotOptimize(entry);
+        lambda = lambda > 3.0f ? 0.3f : lambda + 0.013f;
+    }
+}
+BENCHMARK(BM_EstimationTable_lookup)->Arg(0)->Arg(1);
+void BM_FillPoissonDistribution(benchmark::State& state)
+{
+    kwa::GoalDistribution distr;
+    float lambda = 0.5f;
+    for (auto _ : state) {
+        kwa::FillPoissonDistribution(distr, lambda);
+        benchmark::DoNotOptimize(distr);
+        lambda = lambda > 4.0f ? 0.5f : lambda + 0.01f;
+    }
+}
+BENCHMARK(BM_FillPoissonDistribution);
+
+void BM_PoissonCache_fill(benchmark::State& state)
+{
+    kwa::PoissonCache cache;
+    kwa::GoalDistribution distr;
+    float lambda = 0.5f;
+    for (auto _ : state) {
+        cache.fill(distr, lambda);
+        benchmark::DoNotOptimize(distr);
+        lambda = lambda > 4.0f ? 0.5f : lambda + 0.01f;
+    }
+}
+BENCHMARK(BM_PoissonCache_fill);
+} // namespace
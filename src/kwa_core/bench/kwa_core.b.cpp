@@ -0,0 +1,290 @@
+#include "kwa_core/kwa_core.h"
+#include "benchmark/benchmark.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+const char* const BENCH_FILE_NAME = "kwa_core_bench_matches.csv";
+
+/**
+ * Writes a file in the football-data.co.uk format with several seasons of a
+ * league of 20 teams.
+ */
+void writeBenchFile(int seasons)
+{
+    std::ofstream file(BENCH_FILE_NAME, std::ios::binary);
+    file << "Div,Date,HomeTeam,AwayTeam,FTHG,FTAG,FTR,HTHG,HTAG,HTR\n";
+    const int team_count = 20;
+    for (int season = 0; season < seasons; ++season) {
+        int match_day = 0;
+        for (int home = 0; home < team_count; ++home) {
+            for (int guest = 0; guest < team_count; ++guest) {
+                if (home == guest) continue;
+                int day = 1 + (match_day / 9) % 28;
+                int month = 1 + (match_day / 252) % 12;
+                int year = (season + 95) % 100;
+                int home_goals = (home * 7 + guest * 3 + season) % 5;
+                int guest_goals = (home * 3 + guest * 5 + season) % 4;
+                char line[128];
+                std::snprintf(line, sizeof(line),
+                              "D1,%02d/%02d/%02d,Team %02d FC,Team %02d FC,%d,%d,%c,%d,%d,D\n",
+                              day, month, year, home, guest, home_goals, guest_goals,
+                              home_goals > guest_goals ? 'H' : home_goals < guest_goals ? 'A' : 'D',
+                              home_goals / 2, guest_goals / 2);
+                file << line;
+                ++match_day;
+            }
+        }
+    }
+}
+
+void BM_loadMatchesFromCSVFile(benchmark::State& state)
+{
+    writeBenchFile((int)state.range(0));
+    for (auto _ : state) {
+        kwa::MatchEstimator estimator;
+        benchmark::DoNotOptimize(kwa::loadMatchesFromCSVFile(estimator, BENCH_FILE_NAME));
+    }
+    std::remove(BENCH_FILE_NAME);
+}
+BENCHMARK(BM_loadMatchesFromCSVFile)->Arg(1)->Arg(25)->Unit(benchmark::kMillisecond);
+
+void BM_loadMatchesFromMappedCSVFile(benchmark::State& state)
+{
+    writeBenchFile((int)state.range(0));
+    for (auto _ : state) {
+        kwa::MatchEstimator estimator;
+        benchmark::DoNotOptimize(kwa::loadMatchesFromMappedCSVFile(estimator, BENCH_FILE_NAME));
+    }
+    std::remove(BENCH_FILE_NAME);
+}
+BENCHMARK(BM_loadMatchesFromMappedCSVFile)->Arg(1)->Arg(25)->Unit(benchmark::kMillisecond);
+
+void BM_loadSnapshot(benchmark::State& state)
+{
+    const char* const snapshot_name = "kwa_core_bench_matches.kwa";
+    writeBenchFile((int)state.range(0));
+    {
+        kwa::MatchEstimator estimator;
+        kwa::loadMatchesFromMappedCSVFile(estimator, BENCH_FILE_NAME);
+        kwa::saveSnapshot(estimator, snapshot_name);
+    }
+    for (auto _ : state) {
+        kwa::MatchEstimator estimator;
+        benchmark::DoNotOptimize(kwa::loadSnapshot(estimator, snapshot_name));
+    }
+    std::remove(BENCH_FILE_NAME);
+    std::remove(snapshot_name);
+}
+BENCHMARK(BM_loadSnapshot)->Arg(1)->Arg(25)->Unit(benchmark::kMillisecond);
+
+/**
+ * Estimates all pairs of a league of 20 teams, one by one or at once.
+ */
+void BM_estimateLeagueMatrix(benchmark::State& state)
+{
+    writeBenchFile(3);
+    kwa::MatchEstimator estimator;
+    kwa::loadMatchesFromMappedCSVFile(estimator, BENCH_FILE_NAME);
+    std::remove(BENCH_FILE_NAME);
+    estimator.setDateRange(kwa::match_date(1997, 1, 1), -1);
+    estimator.recalculateTeamStatistics();
+
+    std::vector<std::pair<kwa::TeamId, kwa::TeamId>> matches;
+    const auto team_count = (kwa::TeamId)estimator.teamRegister().size();
+    for (kwa::TeamId h = 0; h < team_count; ++h) {
+        for (kwa::TeamId g = 0; g < team_count; ++g) {
+            if (h != g) matches.emplace_back(h, g);
+        }
+    }
+
+    kwa::MatchEstimationBatch batch;
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            for (auto& match : matches) {
+                kwa::MatchEstimation estimation;
+                estimator.estimate(estimation, match.first, match.second);
+                benchmark::DoNotOptimize(estimation);
+            }
+        } else {
+            estimator.estimateMany(matches, batch);
+            benchmark::DoNotOptimize(batch.best_result_bet_ev.data());
+        }
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * matches.size()));
+}
+BENCHMARK(BM_estimateLeagueMatrix)->Arg(0)->Arg(1);
+
+/**
+ * Updates the prediction matrix of a league of 20 teams after a new result,
+ * arg 0 recomputes the whole matrix, arg 1 adds a match after the max date.
+ */
+void BM_predictionMatrix(benchmark::State& state)
+{
+    writeBenchFile(3);
+    kwa::MatchEstimator estimator;
+    kwa::loadMatchesFromMappedCSVFile(estimator, BENCH_FILE_NAME);
+    std::remove(BENCH_FILE_NAME);
+    estimator.setMaxDate(kwa::match_date(1998, 1, 1));
+    estimator.predictionMatrix();
+
+    const int date = state.range(0) == 0 ? kwa::match_date(1997, 12, 31)
+                                          : kwa::match_date(1998, 2, 1);
+    for (auto _ : state) {
+        estimator.addMatch(date, "Team 01 FC", "Team 02 FC", 1, 0);
+        benchmark::DoNotOptimize(&estimator.predictionMatrix());
+    }
+}
+BENCHMARK(BM_predictionMatrix)->Arg(0)->Arg(1);
+
+/**
+ * Estimates the same 12 fixtures over and over, arg is the capacity of the
+ * estimation cache.
+ */
+void BM_estimateFixtures(benchmark::State& state)
+{
+    writeBenchFile(3);
+    kwa::MatchEstimator estimator;
+    kwa::loadMatchesFromMappedCSVFile(estimator, BENCH_FILE_NAME);
+    std::remove(BENCH_FILE_NAME);
+    estimator.useEstimationCache((size_t)state.range(0));
+
+    int fixture = 0;
+    for (auto _ : state) {
+        kwa::MatchEstimation estimation;
+        estimator.estimate(estimation, fixture, (fixture + 7) % 20);
+        benchmark::DoNotOptimize(estimation);
+        fixture = (fixture + 1) % 12;
+    }
+}
+BENCHMARK(BM_estimateFixtures)->Arg(0)->Arg(64);
+
+/**
+ * Backtests 25 seasons, arg is the number of threads.
+ */
+void BM_backtest(benchmark::State& state)
+{
+    writeBenchFile(25);
+    kwa::MatchEstimator estimator;
+    kwa::loadMatchesFromMappedCSVFile(estimator, BENCH_FILE_NAME);
+    std::remove(BENCH_FILE_NAME);
+
+    kwa::Backtester backtester((size_t)state.range(0));
+    kwa::BacktestResult result;
+    for (auto _ : state) {
+        backtester.run(estimator, kwa::BacktestSettings(), result);
+        benchmark::DoNotOptimize(result.total.points);
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * estimator.matchCount()));
+}
+BENCHMARK(BM_backtest)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/**
+ * Backtests 24 parameter sets over 5 seasons.
+ */
+void BM_parameterSweep(benchmark::State& state)
+{
+    writeBenchFile(5);
+    kwa::MatchEstimator estimator;
+    kwa::loadMatchesFromMappedCSVFile(estimator, BENCH_FILE_NAME);
+    std::remove(BENCH_FILE_NAME);
+
+    kwa::SweepGrid grid;
+    grid.goal_caps = {3, 4, 0};
+    grid.window_sizes = {0, 10};
+    grid.goal_models = {kwa::MatchEstimator::SIMPLE, kwa::MatchEstimator::COMBINED};
+    grid.corrections = {0.0f, 0.1f};
+    std::vector<kwa::SweepParameters> parameters;
+    kwa::MakeSweepGrid(grid, parameters);
+
+    kwa::ParameterSweep sweep;
+    std::vector<kwa::SweepResult> results;
+    for (auto _ : state) {
+        sweep.run(estimator, parameters, kwa::BacktestSettings(), results);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(
+        (int64_t)(state.iterations() * parameters.size() * estimator.matchCount()));
+}
+BENCHMARK(BM_parameterSweep)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/**
+ * Simulates 10000 seasons of 380 fixtures, arg is the number of threads.
+ */
+void BM_simulateSeason(benchmark::State& state)
+{
+    writeBenchFile(3);
+    kwa::MatchEstimator estimator;
+    kwa::loadMatchesFromMappedCSVFile(estimator, BENCH_FILE_NAME);
+    std::remove(BENCH_FILE_NAME);
+
+    std::vector<std::pair<kwa::TeamId, kwa::TeamId>> fixtures;
+    for (kwa::TeamId h = 0; h < 20; ++h) {
+        for (kwa::TeamId g = 0; g < 20; ++g) {
+            if (h != g) fixtures.emplace_back(h, g);
+        }
+    }
+    kwa::SeasonSimulationSettings settings;
+    settings.season_count = 10000;
+    kwa::SeasonSimulator simulator((size_t)state.range(0));
+    kwa::SeasonSimulationResult result;
+    for (auto _ : state) {
+        simulator.run(estimator, fixtures, settings, result);
+        benchmark::DoNotOptimize(result.position_counts.data());
+    }
+    state.SetItemsProcessed(
+        (int64_t)(state.iterations() * settings.season_count * fixtures.size()));
+}
+BENCHMARK(BM_simulateSeason)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+/**
+ * Point distribution of a season of 34 matchdays with 9 tips each.
+ */
+void BM_seasonPointDistribution(benchmark::State& state)
+{
+    std::vector<kwa::TipOutcome> matchday;
+    for (int i = 0; i < 9; ++i) {
+        const float result = 0.08f + 0.01f * (float)i;
+        matchday.push_back({0.5f - result, 0.3f, 0.2f, result});
+    }
+    const kwa::BetSystemPoints points{4.0f, 3.0f, 2.0f};
+    kwa::PointDistribution matchday_points, season;
+    for (auto _ : state) {
+        season.clear();
+        for (int day = 0; day < 34; ++day) {
+            matchday_points.clear();
+            matchday_points.addMatches(matchday, points);
+            season.add(matchday_points);
+        }
+        benchmark::DoNotOptimize(season.probabilityAtLeast(450));
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * 34 * matchday.size()));
+}
+BENCHMARK(BM_seasonPointDistribution);
+
+/**
+ * Optimizes the 10 tips of a matchday against 29 opponents, arg is the number
+ * of threads.
+ */
+void BM_optimizeTips(benchmark::State& state)
+{
+    writeBenchFile(3);
+    kwa::MatchEstimator estimator;
+    kwa::loadMatchesFromMappedCSVFile(estimator, BENCH_FILE_NAME);
+    std::remove(BENCH_FILE_NAME);
+
+    std::vector<kwa::PoolMatch> matches;
+    for (kwa::TeamId h = 0; h < 20; h += 2)
+        matches.push_back({h, h + 1, {{2, 1, 0.5f}, {1, 1, 0.3f}, {1, 2, 0.2f}}});
+    kwa::TipOptimizerSettings settings;
+    kwa::TipOptimizer optimizer((size_t)state.range(0));
+    kwa::TipOptimizerResult result;
+    for (auto _ : state) {
+        optimizer.run(estimator, matches, settings, result);
+        benchmark::DoNotOptimize(result.win_probability);
+    }
+    state.SetItemsProcessed((int64_t)(state.iterations() * settings.scenario_count));
+}
+BENCHMARK(BM_optimizeTips)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+} // namespace
@@ -0,0 +1,87 @@
+#include "kwa_core/columnar_stats_provider.h"
+#include "kwa_core/stats_provider.h"
+#include "benchmark/benchmark.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+const int TEAM_COUNT = 2000;
+const size_t MATCH_COUNT = 500000;
+
+struct BenchData
+{
+    std::vector<kwa::MatchData> matches;
+    std::vector<std::pair<kwa::TeamId, int>> queries;
+};
+
+/**
+ * Many teams with 25 years of matches and random queries of team and date.
+ */
+const BenchData& benchData()
+{
+    static const BenchData data = [] {
+        BenchData out;
+        std::mt19937 rng(42);
+        for (size_t i = 0; i < MATCH_COUNT; ++i) {
+            kwa::MatchData m;
+            m.day = kwa::match_date(1993 + (int)(i * 25 / MATCH_COUNT), 1 + (int)(rng() % 12),
+                                    1 + (int)(rng() % 28));
+            m.home_team = (int)(rng() % TEAM_COUNT);
+            m.guest_team = (int)(rng() % TEAM_COUNT);
+            m.home_goals = (int)(rng() % 5);
+            m.guest_goals = (int)(rng() % 4);
+            out.matches.push_back(m);
+        }
+        std::sort(out.matches.begin(), out.matches.end(),
+                  [](auto lhs, auto rhs) { return lhs.day < rhs.day; });
+        for (size_t i = 0; i < 4096; ++i) {
+            auto& m = out.matches[rng() % MATCH_COUNT];
+            out.queries.emplace_back((int)(rng() % TEAM_COUNT), m.day);
+        }
+        return out;
+    }();
+    return data;
+}
+
+template<typename Provider>
+void runQueries(benchmark::State& state, const Provider& provider)
+{
+    auto& queries = benchData().queries;
+    size_t i = 0;
+    for (auto _ : state) {
+        auto& query = queries[i++ % queries.size()];
+        kwa::TeamStats home, guest;
+        kwa::LeagueStats league;
+        provider.getHomeStatsBefore(query.first, query.second, home);
+        provider.getGuestStatsBefore((query.first + 1) % TEAM_COUNT, query.second, guest);
+        provider.getLeagueStatsBefore(query.second, league);
+        benchmark::DoNotOptimize(home);
+        benchmark::DoNotOptimize(guest);
+        benchmark::DoNotOptimize(league);
+    }
+}
+
+void BM_StatsProvider_queries(benchmark::State& state)
+{
+    kwa::StatsProvider provider{};
+    provider.addMatches(benchData().matches, 4);
+    runQueries(state, provider);
+}
+BENCHMARK(BM_StatsProvider_queries);
+
+void BM_ColumnarStatsProvider_queries(benchmark::State& state)
+{
+    kwa::ColumnarStatsProvider provider{};
+    provider.build(benchData().matches, 4);
+    runQueries(state, provider);
+}
+BENCHMARK(BM_ColumnarStatsProvider_queries);
+
+void BM_CompactStatsProvider_queries(benchmark::State& state)
+{
+    kwa::CompactStatsProvider provider{};
+    provider.build(benchData().matches, 4);
+    runQueries(state, provider);
+}
+BENCHMARK(BM_CompactStatsProvider_queries);
+} // namespace
@@ -0,0 +1,43 @@
+#include "kwa_core/team_register.h"
+#include "benchmark/benchmark.h"
+#include <string>
+#include <unordered_map>
+
+namespace {
+std::vector<std::string> teamNames(size_t count)
+{
+    std::vector<std::string> out;
+    for (size_t i = 0; i < count; ++i)
+        out.push_back("Sportverein Team " + std::to_string(i));
+    return out;
+}
+
+void BM_TeamRegister_getId(benchmark::State& state)
+{
+    auto names = teamNames((size_t)state.range(0));
+    kwa::TeamRegister team_register;
+    for (auto& name : names) team_register.registerTeam(name.c_str());
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(team_register.getId(names[i].c_str()));
+        i = i + 1 == names.size() ? 0 : i + 1;
+    }
+}
+BENCHMARK(BM_TeamRegister_getId)->Arg(20)->Arg(2000);
+
+// the former implementation, for comparison
+void BM_UnorderedMap_getId(benchmark::State& state)
+{
+    auto names = teamNames((size_t)state.range(0));
+    std::unordered_map<std::string, kwa::TeamId> ids;
+    for (auto& name : names) ids.emplace(name, (kwa::TeamId)ids.size());
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ids.find(names[i].c_str()));
+        i = i + 1 == names.size() ? 0 : i + 1;
+    }
+}
+BENCHMARK(BM_UnorderedMap_getId)->Arg(20)->Arg(2000);
+} // namespace
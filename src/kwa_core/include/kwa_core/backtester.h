@@ -0,0 +1,133 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "match_estimator.h"
+
+namespace kwa {
+class ThreadPool;
+
+/**
+ * @brief      Calculates the points of a bet in the betting game, the same
+ *             rules CalculateBestBet() optimizes for: the exact result gives
+ *             result points, else the right goal difference of a win gives
+ *             difference points, else the right tendency gives tendency
+ *             points.
+ *
+ * @param[in]  bet_home_goals   The bet home goals.
+ * @param[in]  bet_guest_goals  The bet guest goals.
+ * @param[in]  home_goals       The real home goals.
+ * @param[in]  guest_goals      The real guest goals.
+ * @param[in]  system_points    The points of the bet system.
+ *
+ * @return     the points.
+ */
+extern float CalculateBetPoints(int bet_home_goals, int bet_guest_goals, int home_goals,
+                                int guest_goals, const BetSystemPoints& system_points);
+
+/**
+ * @brief      Points of a set of bets, see Backtester.
+ */
+struct BacktestPoints
+{
+    /// Matches in the set, with or without a bet.
+    size_t match_count = 0;
+    /// Matches with statistics for both teams, i.e. with a bet.
+    size_t bet_count = 0;
+    float points = 0.0f;
+    size_t result_hits = 0;
+    size_t difference_hits = 0;
+    size_t tendency_hits = 0;
+};
+
+/**
+ * @brief      Points of one season.
+ */
+struct BacktestSeason
+{
+    /// The year the season starts in.
+    int season;
+    BacktestPoints points;
+};
+
+/**
+ * @brief      Settings of Backtester::run().
+ */
+struct BacktestSettings
+{
+    /// Statistics settings of the bets. max_date is replaced by the date of
+    /// each match, min_date and window_size are used as they are.
+    QueryContext context;
+    /// Only matches in [first_date, last_date) are bet on, -1 for no limit.
+    int first_date = -1;
+    int last_date = -1;
+    /// Month a season starts in, 1 for calendar years. Dates MUST be created
+    /// via match_date().
+    int season_start_month = 7;
+};
+
+/**
+ * @brief      Result of Backtester::run().
+ */
+struct BacktestResult
+{
+    BacktestPoints total;
+    /// Sorted by season.
+    std::vector<BacktestSeason> seasons;
+    /// Points of the matches of each team, home and away, indexed by TeamId.
+    std::vector<BacktestPoints> teams;
+};
+
+/**
+ * @brief      Replays the history of an estimator matchday by matchday: every
+ *             match is estimated only from the matches before its date, the
+ *             best result bet is scored against the real result. Matchdays
+ *             are independent and run on a work stealing thread pool, the
+ *             result does not depend on the number of threads.
+ */
+class Backtester
+{
+public:
+    /**
+     * @brief      Constructor.
+     *
+     * @param[in]  thread_count  The number of threads, 0 for as many as there
+     *                           are cores.
+     */
+    explicit Backtester(size_t thread_count = 0);
+    ~Backtester();
+
+    Backtester(const Backtester&) = delete;
+    Backtester& operator=(const Backtester&) = delete;
+
+    size_t threadCount() const;
+
+    /**
+     * @brief      Bets on all matches of an estimator in the date range of the
+     *             settings. The team statistics MUST be up to date, see
+     *             MatchEstimator::recalculateTeamStatistics(). The estimator
+     *             MUST NOT be changed during the call.
+     *
+     * @param[in]  estimator  The estimator with the history.
+     * @param[in]  settings   The settings.
+     * @param      out        Output.
+     */
+    void run(const MatchEstimator& estimator, const BacktestSettings& settings,
+             BacktestResult& out);
+
+    /**
+     * @brief      Same as run() for many settings at once, e.g. to compare
+     *             parameters. The matchdays of all settings share one pool
+     *             run.
+     *
+     * @param[in]  estimator  The estimator with the history.
+     * @param[in]  settings   The settings.
+     * @param      out        Output, one result per settings.
+     */
+    void run(const MatchEstimator& estimator, gsl::span<const BacktestSettings> settings,
+             std::vector<BacktestResult>& out);
+
+private:
+    std::unique_ptr<ThreadPool> m_pool;
+};
+} // namespace kwa
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include "kwa_common.h"
+
+namespace kwa {
+/**
+ * @brief      Results of EstimateBatch(), one entry per match in each array.
+ */
+struct MatchEstimationBatch
+{
+    std::vector<float> home_win;
+    std::vector<float> draw;
+    std::vector<float> guest_win;
+
+    std::vector<int> best_result_bet_home_goals;
+    std::vector<int> best_result_bet_guest_goals;
+    std::vector<float> best_result_bet_ev;
+
+    /// @see MatchEstimation::truncation_error
+    std::vector<float> truncation_error;
+
+    void resize(size_t count);
+    size_t size() const { return home_win.size(); }
+};
+
+/**
+ * @brief      Instruction sets of the batch kernel.
+ */
+enum eBatchKernel
+{
+    /// The best kernel the CPU supports.
+    BATCH_KERNEL_AUTO = 0,
+    BATCH_KERNEL_SCALAR,
+    BATCH_KERNEL_SSE2,
+    BATCH_KERNEL_AVX2,
+};
+
+/**
+ * @brief      Checks if a kernel has been compiled in and is supported by the
+ *             CPU.
+ *
+ * @param[in]  kernel  The kernel.
+ *
+ * @return     true if the kernel can be used.
+ */
+extern bool IsBatchKernelSupported(eBatchKernel kernel);
+
+/**
+ * @brief      Estimates many matches from the expected goals of both teams at
+ *             once. Computes the same values as CalculateThreeWayBet() and
+ *             CalculateBestBet() with the poisson correction, but several
+ *             matches per instruction.
+ *
+ * @param[in]  home_evs       The expected goals of the home teams.
+ * @param[in]  guest_evs      The expected goals of the guest teams, same size
+ *                            as home_evs.
+ * @param[in]  system_points  The points of the bet system.
+ * @param      out            Output, resized to the number of matches.
+ * @param[in]  kernel         The kernel to use. MUST be supported, see
+ *                            IsBatchKernelSupported().
+ * @param[in]  correction     The strength of the poisson correction.
+ */
+extern void EstimateBatch(gsl::span<const float> home_evs, gsl::span<const float> guest_evs,
+                          const BetSystemPoints& system_points, MatchEstimationBatch& out,
+                          eBatchKernel kernel = BATCH_KERNEL_AUTO,
+                          float correction = DEFAULT_POISSON_CORRECTION);
+} // namespace kwa
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "kwa_common.h"
+
+namespace kwa {
+/**
+ * @brief      Read-only StatsProvider with a structure of arrays layout: the
+ *             prefix sums and dates of all teams are packed into a few
+ *             contiguous arrays, each team owns a range given by an offsets
+ *             array. Answers the same queries as StatsProvider.
+ *
+ *             SumT is the type of the per team goal prefix sums, DateT the
+ *             type of the per team dates. With DateT = int dates are stored as
+ *             created via match_date(), any other DateT stores day ordinals
+ *             relative to the first match (see match_ordinal()) which requires
+ *             valid dates. League wide data is always stored with 32 bits.
+ *
+ * @tparam     SumT   Type of the per team goal sums.
+ * @tparam     DateT  Type of the per team dates.
+ */
+template<typename SumT, typename DateT>
+class BasicColumnarStatsProvider
+{
+public:
+    /**
+     * @brief      Default constructor, creates an empty provider. Use build()
+     *             to add data.
+     */
+    BasicColumnarStatsProvider() : m_date_base(0) {}
+
+    /**
+     * @brief      Replaces all data with a range of matches. The range MUST be
+     *             sorted by date in ascending order.
+     *
+     * @param[in]  matches   The range of matches. SORTED by date.
+     * @param[in]  goal_cap  An optional goal cap, see StatsProvider::addMatches().
+     *
+     * @return     false if a goal sum or a date does not fit into SumT or
+     *             DateT. The provider is empty in that case.
+     */
+    bool build(gsl::span<const MatchData> matches, int goal_cap = 0);
+
+    /**
+     * @brief      Clears all data.
+     */
+    void clear();
+
+    size_t matchCount() const { return m_league_dates.size(); }
+    size_t teamCount() const { return m_home.offsets.empty() ? 0 : m_home.offsets.size() - 1; }
+
+    /**
+     * @brief      Returns the number of bytes used by the packed arrays.
+     */
+    size_t memoryUsage() const;
+
+    /// @see StatsProvider::hasHomeStats()
+    bool hasHomeStats(TeamId team, int max_date = -1) const;
+    /// @see StatsProvider::hasGuestStats()
+    bool hasGuestStats(TeamId team, int max_date = -1) const;
+
+    /// @see StatsProvider::getHomeStats()
+    int getHomeStats(TeamId team, TeamStats& out) const;
+    /// @see StatsProvider::getGuestStats()
+    int getGuestStats(TeamId team, TeamStats& out) const;
+    /// @see StatsProvider::getHomeStats()
+    int getHomeStats(TeamId team, size_t num_matches, TeamStats& out) const;
+    /// @see StatsProvider::getGuestStats()
+    int getGuestStats(TeamId team, size_t num_matches, TeamStats& out) const;
+    /// @see StatsProvider::getHomeStatsBefore()
+    int getHomeStatsBefore(TeamId team, int before_date, TeamStats& out) const;
+    /// @see StatsProvider::getGuestStatsBefore()
+    int getGuestStatsBefore(TeamId team, int before_date, TeamStats& out) const;
+    /// @see StatsProvider::getHomeStatsBefore()
+    int getHomeStatsBefore(TeamId team, int before_date, size_t num_matches, TeamStats& out) const;
+    /// @see StatsProvider::getGuestStatsBefore()
+    int getGuestStatsBefore(TeamId team, int before_date, size_t num_matches,
+                            TeamStats& out) const;
+
+    /// @see StatsProvider::getLeagueStats()
+    int getLeagueStats(LeagueStats& out) const;
+    /// @see StatsProvider::getLeagueStats()
+    int getLeagueStats(size_t num_matches, LeagueStats& out) const;
+    /// @see StatsProvider::getLeagueStatsBefore()
+    int getLeagueStatsBefore(int before_date, LeagueStats& out) const;
+    /// @see StatsProvider::getLeagueStatsBefore()
+    int getLeagueStatsBefore(int before_date, size_t num_matches, LeagueStats& out) const;
+
+private:
+    template<typename T>
+    struct GoalSums
+    {
+        T goals;
+        T against;
+    };
+
+    /**
+     * Prefix sums and dates of one location (home or guest) for all teams.
+     * The data of team t is in [offsets[t], offsets[t + 1]).
+     */
+    struct Columns
+    {
+        std::vector<uint32_t> offsets;
+        std::vector<GoalSums<SumT>> sums;
+        std::vector<DateT> dates;
+    };
+
+    Columns m_home;
+    Columns m_guest;
+    std::vector<GoalSums<int>> m_league_sums;
+    std::vector<int> m_league_dates;
+    int m_date_base;
+
+    static constexpr bool stores_match_dates = std::is_same<DateT, int>::value;
+
+    bool encodeDate(int date, DateT& out) const;
+    int queryDate(int date) const;
+    bool hasStats(const Columns& columns, TeamId team, int max_date) const;
+    int getStats(const Columns& columns, TeamId team, int before_date, size_t num_matches,
+                 TeamStats::eLocation location, TeamStats& out) const;
+    int getLeagueStats(size_t end, size_t num_matches, LeagueStats& out) const;
+};
+
+/**
+ * @brief      Columnar layout with 32 bit sums and match_date() dates.
+ */
+using ColumnarStatsProvider = BasicColumnarStatsProvider<int, int>;
+
+/**
+ * @brief      Compact columnar layout with 16 bit goal sums and 16 bit day
+ *             ordinals. Covers about 179 years and 65535 goals per team and
+ *             location.
+ */
+using CompactStatsProvider = BasicColumnarStatsProvider<uint16_t, uint16_t>;
+} // namespace kwa
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "kwa_common.h"
+
+namespace kwa {
+/**
+ * @brief      Maps dates to positions in a sorted array of dates in O(1). The
+ *             covered days are split into buckets of 2^bucket_shift days, each
+ *             bucket stores the number of dates before its first day. A lookup
+ *             reads the bucket and skips the few dates inside of it.
+ *
+ *             The index is built alongside the dates array via append(). As
+ *             soon as a date is not a valid calendar date (see
+ *             is_valid_match_date()) the index disables itself and lowerBound()
+ *             falls back to a binary search.
+ */
+class DateIndex
+{
+public:
+    /**
+     * @brief      Constructor.
+     *
+     * @param[in]  bucket_shift  log2 of the number of days per bucket. 0 gives
+     *                           one bucket per day.
+     */
+    explicit DateIndex(int bucket_shift = 0) : m_bucket_shift(bucket_shift) {}
+
+    /**
+     * @brief      Clears the index, keeps the bucket size.
+     */
+    void clear();
+
+    /**
+     * @brief      Must be called for each date appended to the indexed array.
+     *
+     * @param[in]  date      The appended date. MUST NOT be before the last one.
+     * @param[in]  position  The position of the date in the indexed array.
+     */
+    void append(int date, size_t position);
+
+    /**
+     * @brief      Rebuilds the index for an array of dates.
+     *
+     * @param[in]  dates  The indexed dates. SORTED in ascending order.
+     */
+    void rebuild(gsl::span<const int> dates);
+
+    /**
+     * @brief      Same as std::lower_bound on the indexed dates.
+     *
+     * @param[in]  dates        The indexed dates.
+     * @param[in]  before_date  The date to look for.
+     *
+     * @return     the number of dates before before_date.
+     */
+    size_t lowerBound(const std::vector<int>& dates, int before_date) const;
+
+    /**
+     * @brief      Returns whether lookups use the index. false if a date is not
+     *             a valid calendar date.
+     */
+    bool isEnabled() const { return m_enabled; }
+
+private:
+    int m_bucket_shift;
+    bool m_enabled = true;
+    DayOrdinal m_first_day = 0;
+    std::vector<uint32_t> m_positions;
+};
+} // namespace kwa
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <vector>
+#include "kwa_common.h"
+
+namespace kwa {
+/**
+ * @brief      Alternative to StatsProvider for data that changes after it has
+ *             been added: matches can be inserted in any order, corrected and
+ *             removed in O(log n). The statistics are stored in Fenwick trees
+ *             keyed by the day ordinal of the match date (see match_ordinal()),
+ *             so all dates MUST be valid dates created via match_date().
+ *
+ *             Memory grows with the date range covered by each team instead of
+ *             with the number of matches. Use StatsProvider for large
+ *             historic data that does not change.
+ */
+class DynamicStatsProvider
+{
+public:
+    /**
+     * @brief      Constructor.
+     *
+     * @param[in]  goal_cap  An optional goal cap, see StatsProvider::addMatches().
+     */
+    explicit DynamicStatsProvider(int goal_cap = 0) : m_goal_cap(goal_cap), m_match_count(0) {}
+
+    /**
+     * @brief      Clears all added match data and deletes all registered teams.
+     */
+    void clear();
+
+    /**
+     * @brief      Adds a match. The match does not need to be newer than the
+     *             matches added before. Teams are registered automatically.
+     *
+     * @param[in]  match  The match.
+     */
+    void addMatch(const MatchData& match);
+
+    /**
+     * @brief      Adds a range of matches in any order.
+     *
+     * @param[in]  matches  The matches.
+     */
+    void addMatches(gsl::span<const MatchData> matches);
+
+    /**
+     * @brief      Removes a match. The match MUST have been added before with
+     *             exactly the same data.
+     *
+     * @param[in]  match  The match.
+     */
+    void removeMatch(const MatchData& match);
+
+    /**
+     * @brief      Replaces a match, e.g. to correct a result or to move a
+     *             postponed fixture. Same as removeMatch(old_match) followed
+     *             by addMatch(new_match).
+     *
+     * @param[in]  old_match  The match as it has been added before.
+     * @param[in]  new_match  The corrected match.
+     */
+    void updateMatch(const MatchData& old_match, const MatchData& new_match);
+
+    /**
+     * @brief      Returns the total number of matches.
+     *
+     * @return     match count.
+     */
+    size_t matchCount() const { return m_match_count; }
+
+    /**
+     * @brief      Returns the number of teams that have been registered.
+     *
+     * @return     registered teams.
+     */
+    size_t teamCount() const { return m_team_data.size(); }
+
+    /**
+     * @brief      Checks if there is data of home matches for a team, see
+     *             StatsProvider::hasHomeStats().
+     */
+    bool hasHomeStats(TeamId team, int max_date = -1) const;
+
+    /**
+     * @brief      Checks if there is data of guest matches for a team, see
+     *             StatsProvider::hasGuestStats().
+     */
+    bool hasGuestStats(TeamId team, int max_date = -1) const;
+
+    /**
+     * @brief      Gets the home stats from one team. Including all matches.
+     *             The team MUST have match data.
+     *
+     * @return     the number of matches considered.
+     */
+    int getHomeStats(TeamId team, TeamStats& out) const;
+
+    /**
+     * @brief      Gets the guest stats from one team. Including all matches.
+     *             The team MUST have match data.
+     *
+     * @return     the number of matches considered.
+     */
+    int getGuestStats(TeamId team, TeamStats& out) const;
+
+    /**
+     * @brief      Gets the home stats from one team. Including only matches
+     *             before the specified date.
+     *
+     * @return     the number of matches considered or -1 if there is none.
+     */
+    int getHomeStatsBefore(TeamId team, int before_date, TeamStats& out) const;
+
+    /**
+     * @brief      Gets the guest stats from one team. Including only matches
+     *             before the specified date.
+     *
+     * @return     the number of matches considered or -1 if there is none.
+     */
+    int getGuestStatsBefore(TeamId team, int before_date, TeamStats& out) const;
+
+    /**
+     * @brief      Gets the home stats from one team. Including only the most
+     *             recent matches before the specified date, at most
+     *             num_matches. Matches on the same day are taken or skipped
+     *             together.
+     *
+     * @return     the number of matches actually considered or -1 if there is
+     *             none.
+     */
+    int getHomeStatsBefore(TeamId team, int before_date, size_t num_matches, TeamStats& out) const;
+
+    /**
+     * @brief      Gets the guest stats from one team. Including only the most
+     *             recent matches before the specified date, at most
+     *             num_matches. Matches on the same day are taken or skipped
+     *             together.
+     *
+     * @return     the number of matches actually considered or -1 if there is
+     *             none.
+     */
+    int getGuestStatsBefore(TeamId team, int before_date, size_t num_matches,
+                            TeamStats& out) const;
+
+    /**
+     * @brief      Gets the overall stats of all matches. There MUST be match
+     *             data.
+     *
+     * @return     The number of matches considered.
+     */
+    int getLeagueStats(LeagueStats& out) const;
+
+    /**
+     * @brief      Gets the overall stats of all matches before the specified
+     *             date.
+     *
+     * @return     The number of matches considered or -1 if there is none.
+     */
+    int getLeagueStatsBefore(int before_date, LeagueStats& out) const;
+
+private:
+    struct Sums
+    {
+        int goals;
+        int against;
+        int count;
+    };
+
+    /**
+     * Fenwick tree over the days [base, base + size). Grows when a match
+     * outside of the covered range is added.
+     */
+    struct DayTree
+    {
+        int base = 0;
+        std::vector<Sums> tree;
+
+        void add(int ordinal, const Sums& delta);
+        Sums prefix(int ordinal) const;
+        int firstIndexReaching(int count) const;
+        Sums prefixAt(int index) const;
+        int indexOf(int ordinal) const;
+
+    private:
+        void cover(int ordinal);
+    };
+
+    struct PerTeamData
+    {
+        DayTree home;
+        DayTree guest;
+    };
+
+    int m_goal_cap;
+    size_t m_match_count;
+    std::vector<PerTeamData> m_team_data;
+    DayTree m_overall_stats;
+
+    void applyMatch(const MatchData& match, int sign);
+    const PerTeamData* findTeamData(TeamId team) const;
+    static int getStatsBefore(const DayTree& tree, int before_date, size_t num_matches,
+                              TeamStats::eLocation location, TeamStats& out);
+};
+} // namespace kwa
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <memory>
+#include "match_estimator.h"
+
+namespace kwa {
+/**
+ * @brief      Immutable copy of the statistics and settings of a
+ *             MatchEstimator. All queries are const and can be called from any
+ *             number of threads at once. Does not keep the matches, only what
+ *             estimations need.
+ *
+ *             Readers usually hold a snapshot via SharedEstimatorSnapshot
+ *             while another thread builds the next one.
+ */
+class EstimatorSnapshot
+{
+public:
+    /**
+     * @brief      Copies the state of an estimator and brings the statistics
+     *             up to date. The estimation cache and the prediction matrix
+     *             are not copied.
+     *
+     * @param[in]  estimator  The estimator.
+     */
+    explicit EstimatorSnapshot(const MatchEstimator& estimator);
+
+    EstimatorSnapshot(const EstimatorSnapshot&) = delete;
+    EstimatorSnapshot& operator=(const EstimatorSnapshot&) = delete;
+
+    /// @see MatchEstimator::matchCount()
+    size_t matchCount() const { return m_match_count; }
+    const TeamRegister& teamRegister() const { return m_estimator.teamRegister(); }
+
+    /// @see MatchEstimator::hasHomeStatistics()
+    bool hasHomeStatistics(const char* team_name) const;
+    /// @see MatchEstimator::hasGuestStatistics()
+    bool hasGuestStatistics(const char* team_name) const;
+
+    /// @see MatchEstimator::estimate()
+    void estimate(MatchEstimation& out, const char* home_team, const char* guest_team) const;
+    /// @see MatchEstimator::estimate()
+    void estimate(MatchEstimation& out, TeamId home_team, TeamId guest_team) const;
+    /// @see MatchEstimator::hasHomeStatistics()
+    bool hasHomeStatistics(const char* team_name, const QueryContext& context) const;
+    /// @see MatchEstimator::hasGuestStatistics()
+    bool hasGuestStatistics(const char* team_name, const QueryContext& context) const;
+    /// @see MatchEstimator::estimate()
+    void estimate(MatchEstimation& out, const char* home_team, const char* guest_team,
+                  const QueryContext& context) const;
+    /// @see MatchEstimator::estimate()
+    void estimate(MatchEstimation& out, TeamId home_team, TeamId guest_team,
+                  const QueryContext& context) const;
+    /// @see MatchEstimator::estimateMany()
+    void estimateMany(gsl::span<const std::pair<TeamId, TeamId>> matches,
+                      MatchEstimationBatch& out) const;
+
+private:
+    MatchEstimator m_estimator;
+    size_t m_match_count;
+};
+
+/**
+ * @brief      Publishes the current EstimatorSnapshot to many reader threads.
+ *             Readers load() a reference counted pointer and keep using their
+ *             snapshot as long as they like, a writer builds the next snapshot
+ *             on its own and store()s it. Old snapshots are freed by the last
+ *             reader. Readers never wait for a writer to build a snapshot,
+ *             load() and store() only exchange the pointer. The standard
+ *             library may guard that exchange with a short lock, atomic
+ *             shared_ptr operations are not lock free in libstdc++ or MSVC.
+ */
+class SharedEstimatorSnapshot
+{
+public:
+    SharedEstimatorSnapshot() = default;
+    explicit SharedEstimatorSnapshot(std::shared_ptr<const EstimatorSnapshot> snapshot)
+        : m_snapshot(std::move(snapshot))
+    {}
+
+    SharedEstimatorSnapshot(const SharedEstimatorSnapshot&) = delete;
+    SharedEstimatorSnapshot& operator=(const SharedEstimatorSnapshot&) = delete;
+
+    /**
+     * @brief      Returns the current snapshot, nullptr if none has been
+     *             stored. Thread safe.
+     */
+    std::shared_ptr<const EstimatorSnapshot> load() const { return std::atomic_load(&m_snapshot); }
+
+    /**
+     * @brief      Replaces the current snapshot. Thread safe.
+     *
+     * @param[in]  snapshot  The new snapshot.
+     */
+    void store(std::shared_ptr<const EstimatorSnapshot> snapshot)
+    {
+        std::atomic_store(&m_snapshot, std::move(snapshot));
+    }
+
+    /**
+     * @brief      Builds a snapshot of an estimator and stores it. The
+     *             estimator MUST NOT be changed during the call.
+     *
+     * @param[in]  estimator  The estimator.
+     */
+    void update(const MatchEstimator& estimator)
+    {
+        store(std::make_shared<const EstimatorSnapshot>(estimator));
+    }
+
+private:
+    std::shared_ptr<const EstimatorSnapshot> m_snapshot;
+};
+} // namespace kwa
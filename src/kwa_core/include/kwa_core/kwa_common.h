@@ -12,6 +12,8 @@ using ThreeWayBet = std::array<float, 3>;
 constexpr const unsigned int MAX_GOALS = 10;
 constexpr const unsigned int MAX_POSSIBLE_RESULTS = (MAX_GOALS + 1) * (MAX_GOALS + 1);
 using GoalDistribution = std::array<float, MAX_GOALS + 1>;
+/// Strength of the correction of the results 0:0, 1:0, 0:1 and 1:1.
+constexpr const float DEFAULT_POISSON_CORRECTION = 0.1f;
 
 // Data struct definitions
 struct KicktippBet
@@ -29,6 +31,33 @@ struct BetSystemPoints
     float tendency;
 };
 
+/**
+ * @brief      Probabilities of the outcomes of one tip: no points, the right
+ *             tendency, the right goal difference or the exact result. They
+ *             sum up to one.
+ */
+struct TipOutcome
+{
+    float miss;
+    float tendency;
+    float difference;
+    float result;
+};
+
+/**
+ * @brief      Maximum errors of an approximate estimation compared to the
+ *             exact one.
+ */
+struct EstimationError
+{
+    /// Absolute error of a three way probability.
+    float three_way;
+    /// Absolute error of the expected points of the best result bet.
+    float best_bet_ev;
+    /// Expected points lost by betting the approximated best result.
+    float best_bet_loss;
+};
+
 struct TeamStats
 {
     enum eLocation
@@ -52,6 +81,17 @@ struct MatchData
     int guest_goals;
 };
 
+/**
+ * @brief      A tip on a match, see MatchEstimator::estimateTipOutcomes().
+ */
+struct MatchTip
+{
+    TeamId home_team;
+    TeamId guest_team;
+    int home_goals;
+    int guest_goals;
+};
+
 struct LeagueStats
 {
     enum eLocation
@@ -103,4 +143,63 @@ inline int match_day(int val)
 {
     return (val % 100);
 }
+
+/**
+ * @brief      Day ordinal: the number of days since 1970-01-01. Unlike dates
+ *             created via match_date() the distance of two ordinals is the
+ *             number of days between them.
+ */
+using DayOrdinal = int;
+
+/**
+ * @brief      Checks if a value created via match_date() is a real calendar
+ *             date. Only valid dates can be converted to a DayOrdinal.
+ */
+inline bool is_valid_match_date(int val)
+{
+    const int year = match_year(val);
+    const int month = match_month(val);
+    const int day = match_day(val);
+    if (val < 0 || month < 1 || month > 12 || day < 1) return false;
+
+    const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    const int days_in_month = month == 2 ? (leap ? 29 : 28) : 30 + ((month + month / 8) % 2);
+    return day <= days_in_month;
+}
+
+/**
+ * @brief      Converts a valid date created via match_date() to the number of
+ *             days since 1970-01-01, so date differences become subtractions.
+ */
+inline DayOrdinal match_ordinal(int val)
+{
+    int year = match_year(val);
+    const int month = match_month(val);
+    const int day = match_day(val);
+    year -= month <= 2 ? 1 : 0;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int year_of_era = year - era * 400;
+    const int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+/**
+ * @brief      Converts a day ordinal back to a date as created via
+ *             match_date(). Inverse of match_ordinal().
+ */
+inline int ordinal_match_date(DayOrdinal ordinal)
+{
+    const int shifted = ordinal + 719468;
+    const int era = (shifted >= 0 ? shifted : shifted - 146096) / 146097;
+    const int day_of_era = shifted - era * 146097;
+    const int year_of_era =
+        (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const int day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const int mp = (5 * day_of_year + 2) / 153;
+    const int day = day_of_year - (153 * mp + 2) / 5 + 1;
+    const int month = mp < 10 ? mp + 3 : mp - 9;
+    const int year = year_of_era + era * 400 + (month <= 2 ? 1 : 0);
+    return match_date(year, month, day);
+}
 } // namespace kwa
@@ -2,7 +2,16 @@
 #include "kwa_common.h"
 #include "team_register.h"
 #include "stats_provider.h"
+#include "dynamic_stats_provider.h"
+#include "columnar_stats_provider.h"
 #include "match_estimator.h"
+#include "batch_estimation.h"
+#include "estimator_snapshot.h"
+#include "backtester.h"
+#include "parameter_sweep.h"
+#include "season_simulator.h"
+#include "point_distribution.h"
+#include "tip_optimizer.h"
 
 namespace kwa {
 /**
@@ -17,4 +26,44 @@ namespace kwa {
  * @return     true if success
  */
 extern bool loadMatchesFromCSVFile(MatchEstimator& estimator, const char* file_name);
+
+/**
+ * @brief      Same as loadMatchesFromCSVFile() but maps the file into memory
+ *             and tokenizes it in place. Dates and goals are parsed without
+ *             allocations. Malformed rows make the function return false
+ *             instead of throwing, no matches are added in that case.
+ *
+ * @param      estimator  The destination estimator.
+ * @param[in]  file_name  file name.
+ *
+ * @return     true if success
+ */
+extern bool loadMatchesFromMappedCSVFile(MatchEstimator& estimator, const char* file_name);
+
+/**
+ * @brief      Writes the matches, the team register and the team statistics of
+ *             an estimator to a versioned binary snapshot file. The file
+ *             consists of flat, aligned arrays so it can be memory mapped and
+ *             restored with bulk copies. The team statistics MUST be up to
+ *             date, see MatchEstimator::recalculateTeamStatistics().
+ *
+ * @param[in]  estimator  The source estimator.
+ * @param[in]  file_name  file name.
+ *
+ * @return     true if success
+ */
+extern bool saveSnapshot(const MatchEstimator& estimator, const char* file_name);
+
+/**
+ * @brief      Replaces the state of an estimator with a snapshot written by
+ *             saveSnapshot(). No parsing and no statistics rebuild is needed,
+ *             estimate() can be called right away. The estimator is left
+ *             unchanged if the file is invalid or has a different version.
+ *
+ * @param      estimator  The destination estimator.
+ * @param[in]  file_name  file name.
+ *
+ * @return     true if success
+ */
+extern bool loadSnapshot(MatchEstimator& estimator, const char* file_name);
 } // namespace kwa
@@ -1,9 +1,19 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include "batch_estimation.h"
 #include "stats_provider.h"
 #include "team_register.h"
 
 namespace kwa {
+class PoissonCache;
+class EstimationTable;
+class EstimationCache;
+class ThreadPool;
+struct ScoreMatrix;
+
 struct MatchEstimation
 {
     ThreeWayBet three_way_probabilities;
@@ -16,24 +26,239 @@ struct MatchEstimation
     int best_result_bet_guest_goals;
     float best_result_bet_ev;
     float best_result_bet_probability;
+
+    /// Probability of all results outside of the evaluated score grid, i.e.
+    /// more than MAX_GOALS goals or cut off by MatchEstimator::setTailEpsilon().
+    float truncation_error;
+};
+
+/**
+ * @brief      A match result referencing the team names, used to add many
+ *             matches at once via MatchEstimator::addMatches(). The names do
+ *             not need to be zero terminated.
+ */
+struct MatchResult
+{
+    int date;
+    gsl::cstring_span<> home_team;
+    gsl::cstring_span<> guest_team;
+    int home_goals;
+    int guest_goals;
+};
+
+struct QueryContext;
+
+/**
+ * @brief      Predictions of all pairs of teams of a MatchEstimator, see
+ *             MatchEstimator::predictionMatrix().
+ */
+class PredictionMatrix
+{
+public:
+    size_t teamCount() const { return m_team_count; }
+
+    /**
+     * @brief      Checks if both teams have statistics, i.e. if the prediction
+     *             of the pair is valid.
+     */
+    bool isValid(TeamId home_team, TeamId guest_team) const
+    {
+        return home_team != guest_team && m_has_home_stats[(size_t)home_team] &&
+               m_has_guest_stats[(size_t)guest_team];
+    }
+
+    /**
+     * @brief      Returns the prediction of a pair. MUST be valid, see
+     *             isValid(). Same as MatchEstimator::estimateMany().
+     */
+    const MatchEstimation& at(TeamId home_team, TeamId guest_team) const
+    {
+        assert(isValid(home_team, guest_team));
+        return m_estimations[(size_t)home_team * m_team_count + (size_t)guest_team];
+    }
+
+private:
+    friend class MatchEstimator;
+
+    /// Estimator settings the predictions depend on.
+    struct Settings
+    {
+        int min_date;
+        int max_date;
+        int goal_model;
+        float location_weight;
+        float total_weight;
+        int table_lookup;
+    };
+
+    size_t m_team_count = 0;
+    Settings m_settings{};
+    std::vector<MatchEstimation> m_estimations;
+    std::vector<TeamStats> m_home_stats;
+    std::vector<TeamStats> m_guest_stats;
+    std::vector<char> m_has_home_stats;
+    std::vector<char> m_has_guest_stats;
+    LeagueStats m_league_stats{};
 };
 
 class MatchEstimator
 {
 public:
+    /**
+     * Model used to calculate the expected goals of both teams.
+     */
+    enum eGoalModel
+    {
+        /// Home stats of the home team vs. away stats of the guest team.
+        SIMPLE = 0,
+        /// Weighted sum of SIMPLE and the home and away combined stats.
+        COMBINED = 1,
+    };
+
+    /**
+     * Lookup mode of the precomputed estimation table.
+     */
+    enum eTableLookup
+    {
+        /// Exact estimations, no table.
+        TABLE_OFF = 0,
+        /// Estimation of the nearest grid node.
+        TABLE_NEAREST = 1,
+        /// Bilinear interpolation between the surrounding grid nodes.
+        TABLE_INTERPOLATED = 2,
+    };
+
     /**
      * @brief      Default constructor. Add matches via addMatch() before using
      *             estimate()
      */
-    MatchEstimator() : m_team_statistics{0}, m_system_points{4.0f, 3.0f, 2.0f}, m_max_date(-1) {}
+    MatchEstimator();
+    ~MatchEstimator();
+
+    /**
+     * @brief      Copies all matches and settings. The copy gets an empty
+     *             estimation cache of the same capacity.
+     */
+    MatchEstimator(const MatchEstimator& other);
+    MatchEstimator& operator=(const MatchEstimator& other);
+    MatchEstimator(MatchEstimator&&);
+    MatchEstimator& operator=(MatchEstimator&&);
 
     /**
      * @brief      Sets the maximum date. Only matches on dates before it will
-     *             be used for estimations.
+     *             be used for estimations. Removes the lower limit of a date
+     *             range, same as setDateRange(-1, date).
      *
      * @param[in]  date  The date.
      */
-    void setMaxDate(int date) { m_max_date = date; }
+    void setMaxDate(int date) { setDateRange(-1, date); }
+
+    /**
+     * @brief      Sets a date range. Only matches on dates in [from_date,
+     *             to_date) will be used for estimations, e.g. to use only the
+     *             current season.
+     *
+     * @param[in]  from_date  First date of the range, inclusive. -1 for no
+     *                        lower limit.
+     * @param[in]  to_date    Date after the range, exclusive. -1 for no upper
+     *                        limit.
+     */
+    void setDateRange(int from_date, int to_date)
+    {
+        m_min_date = from_date;
+        m_max_date = to_date;
+    }
+
+    /**
+     * @brief      Sets the model used to calculate the expected goals.
+     *
+     * @param[in]  model            The model.
+     * @param[in]  location_weight  COMBINED only: weight of the home or away
+     *                              stats of the teams.
+     * @param[in]  total_weight     COMBINED only: weight of the stats over all
+     *                              matches of the teams.
+     */
+    void setGoalModel(eGoalModel model, float location_weight = 0.5f, float total_weight = 0.5f);
+
+    /**
+     * @brief      Sets the cap of the goals of a match in the statistics, e.g.
+     *             with a cap of 4 a 7:0 counts as 4:0. Rebuilds the statistics
+     *             on the next call of recalculateTeamStatistics().
+     *
+     * @param[in]  goal_cap  The cap, 0 for none. Default is 4.
+     */
+    void setGoalCap(int goal_cap);
+    int goalCap() const { return m_goal_cap; }
+
+    /**
+     * @brief      Enables a cache of goal distributions keyed by the expected
+     *             goals rounded to 0.001. Speeds up many estimations, the
+     *             probabilities differ slightly from the exact ones. The cache
+     *             is created on first use and shared by all estimators.
+     *
+     * @param[in]  enabled  true to use the cache.
+     */
+    void usePoissonCache(bool enabled);
+
+    /**
+     * @brief      Truncates the goal distributions of both teams as soon as
+     *             the probability of more goals is below epsilon. The kept
+     *             probabilities are renormalized and only the reduced score
+     *             grid is evaluated, which is a lot cheaper for low scoring
+     *             matches. The dropped probability is reported as
+     *             MatchEstimation::truncation_error.
+     *
+     * @param[in]  epsilon  The maximum dropped tail probability per team. 0
+     *                      evaluates the full grid.
+     */
+    void setTailEpsilon(float epsilon)
+    {
+        m_tail_epsilon = epsilon;
+        ++m_data_generation;
+    }
+
+    /**
+     * @brief      Enables a fast path that looks the estimations up in a table
+     *             over a grid of the expected goals of both teams with steps of
+     *             0.05 up to 6 goals. The table is built on first use, once
+     *             per system points, and shared by all estimators. Expected
+     *             goals out of the grid are estimated exactly. Takes precedence
+     *             over setTailEpsilon() and usePoissonCache().
+     *
+     * @param[in]  lookup  The lookup mode, TABLE_OFF for exact estimations.
+     */
+    void useEstimationTable(eTableLookup lookup);
+
+    /**
+     * @brief      Enables a bounded LRU cache of estimate() results keyed by
+     *             the teams and the date range. Adding matches, clear(),
+     *             recalculateTeamStatistics() and changing any other setting
+     *             invalidate all cached results.
+     *
+     * @param[in]  capacity  The maximum number of cached results, 0 disables
+     *                       the cache.
+     */
+    void useEstimationCache(size_t capacity);
+
+    /**
+     * @brief      Returns the number of estimate() calls answered from the
+     *             estimation cache.
+     */
+    size_t estimationCacheHits() const { return m_cache_hits; }
+
+    /**
+     * @brief      Returns the number of estimate() calls the estimation cache
+     *             could not answer.
+     */
+    size_t estimationCacheMisses() const { return m_cache_misses; }
+
+    /**
+     * @brief      Measures the maximum error of the estimation table in the
+     *             current lookup mode against exact estimations. Expensive.
+     *
+     * @return     the errors, all 0 if no table is used.
+     */
+    EstimationError measureEstimationTableError() const;
 
     /**
      * @brief      Returns the number of added matches.
@@ -62,14 +287,28 @@ public:
                   int guest_goals);
 
     /**
-     * @brief      HAS TO be called after new matches have been added.
+     * @brief      Adds a range of matches to the database. The range does not
+     *             need to be sorted. Equivalent to calling addMatch() for each
+     *             match in order, but sorts and merges once instead of
+     *             inserting every match separately. recalculateTeamStatistics()
+     *             MUST BE called afterwards to update statistics.
+     *
+     * @param[in]  matches  The matches.
+     */
+    void addMatches(gsl::span<const MatchResult> matches);
+
+    /**
+     * @brief      HAS TO be called after new matches have been added. Matches
+     *             dated on or after the last match already in the statistics
+     *             are appended in O(k). Only matches inserted before it cause
+     *             a full rebuild.
      */
     void recalculateTeamStatistics();
 
     /**
      * @brief      Checks if team has statistics for home matches. If max date
-     *             is set this method will only check if the has statistics
-     *             BEFORE the max date.
+     *             or a date range is set this method will only check if the
+     *             team has statistics in the range.
      *
      * @param[in]  team_name  Team name.
      *
@@ -79,8 +318,8 @@ public:
 
     /**
      * @brief      Checks if team has statistics for away matches. If max date
-     *             is set this method will only check if the has statistics
-     *             BEFORE the max date.
+     *             or a date range is set this method will only check if the
+     *             team has statistics in the range.
      *
      * @param[in]  team_name  Team name.
      *
@@ -88,6 +327,15 @@ public:
      */
     bool hasGuestStatistics(const char* team_name) const;
 
+    /// @brief Same as hasHomeStatistics() with the date range of a context.
+    bool hasHomeStatistics(const char* team_name, const QueryContext& context) const;
+    /// @brief Same as hasGuestStatistics() with the date range of a context.
+    bool hasGuestStatistics(const char* team_name, const QueryContext& context) const;
+    /// @brief Same as hasHomeStatistics() with a context, by team id.
+    bool hasHomeStatistics(TeamId team, const QueryContext& context) const;
+    /// @brief Same as hasGuestStatistics() with a context, by team id.
+    bool hasGuestStatistics(TeamId team, const QueryContext& context) const;
+
     /**
      * @brief      Estimates the match. There MUST BE statistics for both teams.
      *
@@ -106,17 +354,175 @@ public:
      */
     void estimate(MatchEstimation& out, TeamId home_team, TeamId guest_team);
 
+    /**
+     * @brief      Estimates the match with the settings of a context instead of
+     *             the ones of the estimator. Does not use the estimation cache
+     *             and does not change the estimator, it can be called from many
+     *             threads at once. The statistics MUST be up to date, see
+     *             recalculateTeamStatistics(). There MUST BE statistics for
+     *             both teams in the context.
+     *
+     * @param      out         output
+     * @param[in]  home_team   Home team name.
+     * @param[in]  guest_team  Guest team name.
+     * @param[in]  context     The query settings.
+     */
+    void estimate(MatchEstimation& out, const char* home_team, const char* guest_team,
+                  const QueryContext& context) const;
+
+    /// @brief Same as estimate() with a context, by team id.
+    void estimate(MatchEstimation& out, TeamId home_team, TeamId guest_team,
+                  const QueryContext& context) const;
+
+    /**
+     * @brief      Returns the current settings of the estimator as a context:
+     *             date range, no window, the bet system points and the goal
+     *             model.
+     */
+    QueryContext queryContext() const;
+
+    /**
+     * @brief      Estimates many matches at once, e.g. a whole matchday or all
+     *             pairs of a league. Queries the league statistics once and the
+     *             statistics of every team once per location, then estimates
+     *             all matches with EstimateBatch() or the estimation table.
+     *             Gives the same results as estimate() up to rounding, but
+     *             always evaluates the full score grid, see setTailEpsilon().
+     *             There MUST BE statistics for all teams.
+     *
+     * @param[in]  matches  The pairs of home and guest team ids.
+     * @param      out      Output, one entry per match.
+     */
+    void estimateMany(gsl::span<const std::pair<TeamId, TeamId>> matches,
+                      MatchEstimationBatch& out);
+
+    /**
+     * @brief      Calculates the probabilities of the outcomes of tips, e.g. to
+     *             get the distribution of the points of a matchday, see
+     *             PointDistribution. Uses the full score grid of estimate()
+     *             without truncation or caches. There MUST BE statistics for
+     *             all teams.
+     *
+     * @param[in]  tips  The tips.
+     * @param      out   Output, one entry per tip.
+     */
+    void estimateTipOutcomes(gsl::span<const MatchTip> tips, std::vector<TipOutcome>& out);
+
+    /// @brief Same as estimateTipOutcomes() with a context, see estimate().
+    void estimateTipOutcomes(gsl::span<const MatchTip> tips, const QueryContext& context,
+                             std::vector<TipOutcome>& out) const;
+
+    /**
+     * @brief      Calculates the expected goals of both teams, the means of the
+     *             goal distributions the full score grid of estimate() is built
+     *             from, e.g. to sample results of the match. There MUST BE
+     *             statistics for both teams.
+     *
+     * @param[in]  home_id   The home team.
+     * @param[in]  guest_id  The guest team.
+     * @param[in]  context   The settings of the query.
+     * @param      home_ev   Output, the expected goals of the home team.
+     * @param      guest_ev  Output, the expected goals of the guest team.
+     */
+    void expectedGoals(TeamId home_id, TeamId guest_id, const QueryContext& context,
+                       float& home_ev, float& guest_ev) const;
+
+    /**
+     * @brief      Returns the predictions of all pairs of teams. The matrix is
+     *             cached, after adding matches only the rows and columns of
+     *             teams whose statistics changed are recomputed, or all of them
+     *             if the league statistics changed. Matches outside of the date
+     *             range change nothing. Changing the date range, goal model or
+     *             estimation table recomputes the whole matrix. Predictions are
+     *             computed in parallel.
+     *
+     * @return     the matrix, valid until the estimator is changed.
+     */
+    const PredictionMatrix& predictionMatrix();
+
     const TeamRegister& teamRegister() const { return m_team_register; }
     const gsl::span<const MatchData> matches() const { return m_matches; }
 
 private:
+    friend struct SnapshotAccess;
+    friend class EstimatorSnapshot;
+
     std::vector<MatchData> m_matches;
     TeamRegister m_team_register;
     StatsProvider m_team_statistics;
     kwa::BetSystemPoints m_system_points;
+    int m_min_date;
     int m_max_date;
+    eGoalModel m_goal_model;
+    float m_location_weight;
+    float m_total_weight;
+    int m_goal_cap;
+    float m_tail_epsilon;
+    const PoissonCache* m_poisson_cache;
+    std::shared_ptr<const EstimationTable> m_estimation_table;
+    eTableLookup m_table_lookup;
+    bool m_requires_rebuild;
+    PredictionMatrix m_prediction_matrix;
+    /// teams of the matches added since the last update of the matrix
+    std::vector<TeamId> m_changed_teams;
+    /// bumped on every change of matches or settings the estimations depend on
+    uint64_t m_data_generation;
+    std::unique_ptr<EstimationCache> m_estimation_cache;
+    uint64_t m_cache_generation;
+    size_t m_cache_hits;
+    size_t m_cache_misses;
+    /// threads of predictionMatrix(), not copied
+    std::unique_ptr<ThreadPool> m_thread_pool;
 
-    void getStatistics(TeamId home_id, TeamId guest_id, TeamStats& home_stats,
-                       TeamStats& guest_stats, LeagueStats& league_stats) const;
+    void getStatistics(TeamId home_id, TeamId guest_id, const QueryContext& context,
+                       TeamStats& home_stats, TeamStats& guest_stats,
+                       LeagueStats& league_stats) const;
+    // estimations on the current statistics, which MUST be up to date
+    void estimateCurrent(MatchEstimation& out, TeamId home_id, TeamId guest_id,
+                         const QueryContext& context) const;
+    void estimateManyCurrent(gsl::span<const std::pair<TeamId, TeamId>> matches,
+                             const QueryContext& context, MatchEstimationBatch& out) const;
+    void resetCaches();
+    bool hasTeamStatistics(TeamId team, TeamStats::eLocation location,
+                           const QueryContext& context) const;
+    void getTeamStatistics(TeamId team, TeamStats::eLocation location,
+                           const QueryContext& context, TeamStats& out) const;
+    void getLeagueStatistics(const QueryContext& context, LeagueStats& out) const;
+    // the full score grid of a match without truncation or caches
+    void getScoreMatrix(TeamId home_id, TeamId guest_id, const LeagueStats& league_stats,
+                        const QueryContext& context, ScoreMatrix& out) const;
+    // the estimation table if it matches the system points of the context
+    const EstimationTable* estimationTable(const QueryContext& context) const;
+    void calculateGoalEvs(const TeamStats& home_stats, const TeamStats& guest_stats,
+                          const LeagueStats& league_stats, const QueryContext& context,
+                          float& home_ev, float& guest_ev) const;
+    void estimateGoalEvs(gsl::span<const float> home_evs, gsl::span<const float> guest_evs,
+                         const QueryContext& context, MatchEstimationBatch& out) const;
+};
+
+/**
+ * @brief      Settings of a single query, see MatchEstimator::estimate(). Lets
+ *             threads query the same estimator at different dates without
+ *             changing it. MatchEstimator::queryContext() returns the settings
+ *             of the estimator.
+ */
+struct QueryContext
+{
+    /// Only matches on or after this date are used, -1 for no limit.
+    int min_date = -1;
+    /// Only matches before this date are used, -1 for no limit, see
+    /// MatchEstimator::setMaxDate() and MatchEstimator::setDateRange().
+    int max_date = -1;
+    /// Only the last window_size matches of each team and location in the
+    /// date range are used, 0 for all. League statistics use all matches.
+    size_t window_size = 0;
+    /// The points of the bet system for the best bet.
+    BetSystemPoints system_points{4.0f, 3.0f, 2.0f};
+    /// The goal model and its weights, see MatchEstimator::setGoalModel().
+    MatchEstimator::eGoalModel goal_model = MatchEstimator::SIMPLE;
+    float location_weight = 1.0f;
+    float total_weight = 0.0f;
+    /// Strength of the correction of low scores.
+    float correction = DEFAULT_POISSON_CORRECTION;
 };
 } // namespace kwa
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "backtester.h"
+
+namespace kwa {
+/**
+ * @brief      One set of estimator parameters evaluated by ParameterSweep.
+ */
+struct SweepParameters
+{
+    /// @see MatchEstimator::setGoalCap()
+    int goal_cap = 4;
+    /// @see QueryContext::window_size
+    size_t window_size = 0;
+    /// MatchEstimator::eGoalModel and its weights, see
+    /// MatchEstimator::setGoalModel().
+    MatchEstimator::eGoalModel goal_model = MatchEstimator::SIMPLE;
+    float location_weight = 1.0f;
+    float total_weight = 0.0f;
+    /// @see QueryContext::correction
+    float correction = DEFAULT_POISSON_CORRECTION;
+};
+
+/**
+ * @brief      Values of every parameter to try, see MakeSweepGrid() and
+ *             MakeRandomSweep(). The weights are only used with the COMBINED
+ *             goal model.
+ */
+struct SweepGrid
+{
+    std::vector<int> goal_caps{4};
+    std::vector<size_t> window_sizes{0};
+    std::vector<MatchEstimator::eGoalModel> goal_models{MatchEstimator::SIMPLE};
+    std::vector<float> location_weights{0.5f};
+    std::vector<float> total_weights{0.5f};
+    std::vector<float> corrections{DEFAULT_POISSON_CORRECTION};
+};
+
+/**
+ * @brief      Result of one parameter set.
+ */
+struct SweepResult
+{
+    SweepParameters parameters;
+    BacktestPoints points;
+};
+
+/**
+ * @brief      Creates all combinations of the values of a grid. Parameter sets
+ *             of the SIMPLE goal model are created once, without the weights.
+ *
+ * @param[in]  grid  The grid.
+ * @param      out   Output.
+ */
+extern void MakeSweepGrid(const SweepGrid& grid, std::vector<SweepParameters>& out);
+
+/**
+ * @brief      Draws random parameter sets for a random search. Integer
+ *             parameters are drawn from the values of the grid, the weights
+ *             and the correction uniformly between the smallest and the
+ *             largest value of the grid. The same seed gives the same sets.
+ *
+ * @param[in]  grid   The grid. Every list MUST NOT be empty.
+ * @param[in]  count  The number of parameter sets.
+ * @param[in]  seed   The seed.
+ * @param      out    Output.
+ */
+extern void MakeRandomSweep(const SweepGrid& grid, size_t count, uint32_t seed,
+                            std::vector<SweepParameters>& out);
+
+/**
+ * @brief      Backtests many parameter sets of an estimator to tune it to a
+ *             league. Parameter sets with the same goal cap share one copy of
+ *             the statistics, all matchdays of all parameter sets run
+ *             concurrently on one thread pool, see Backtester.
+ */
+class ParameterSweep
+{
+public:
+    /**
+     * @brief      Constructor.
+     *
+     * @param[in]  thread_count  The number of threads, 0 for as many as there
+     *                           are cores.
+     */
+    explicit ParameterSweep(size_t thread_count = 0) : m_backtester(thread_count) {}
+
+    /**
+     * @brief      Backtests parameter sets. The team statistics of the
+     *             estimator MUST be up to date, see
+     *             MatchEstimator::recalculateTeamStatistics().
+     *
+     * @param[in]  estimator   The estimator with the history.
+     * @param[in]  parameters  The parameter sets.
+     * @param[in]  settings    Date range, seasons and bet system of the
+     *                         backtests. The goal model, weights, window and
+     *                         correction of its context are replaced by the
+     *                         parameter sets.
+     * @param      out         Output, one result per parameter set ranked by
+     *                         points, best first.
+     */
+    void run(const MatchEstimator& estimator, gsl::span<const SweepParameters> parameters,
+             const BacktestSettings& settings, std::vector<SweepResult>& out);
+
+private:
+    Backtester m_backtester;
+};
+
+/**
+ * @brief      Writes ranked sweep results to a .csv file, one line per result.
+ *
+ * @param[in]  results    The results, see ParameterSweep::run().
+ * @param[in]  file_name  file name.
+ *
+ * @return     true if success
+ */
+extern bool writeSweepReport(gsl::span<const SweepResult> results, const char* file_name);
+} // namespace kwa
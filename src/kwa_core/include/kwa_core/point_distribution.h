@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include "kwa_common.h"
+
+namespace kwa {
+/**
+ * @brief      Exact probability distribution of the total points of many tips,
+ *             e.g. of a matchday or a whole season. Starts with zero points
+ *             for sure, every added match or distribution is convolved in, so
+ *             questions like the probability of at least 20 points on a
+ *             matchday are answered without sampling.
+ *
+ *             The points of the bet system MUST be whole numbers, like the
+ *             ones of the betting game.
+ */
+class PointDistribution
+{
+public:
+    PointDistribution();
+
+    /**
+     * @brief      Adds the points of one tip.
+     *
+     * @param[in]  outcome        The outcome probabilities of the tip, see
+     *                            MatchEstimator::estimateTipOutcomes().
+     * @param[in]  system_points  The points of the bet system.
+     */
+    void addMatch(const TipOutcome& outcome, const BetSystemPoints& system_points);
+
+    /**
+     * @brief      Adds the points of many tips, e.g. a whole matchday.
+     *
+     * @param[in]  outcomes       The outcome probabilities of the tips.
+     * @param[in]  system_points  The points of the bet system.
+     */
+    void addMatches(gsl::span<const TipOutcome> outcomes, const BetSystemPoints& system_points);
+
+    /**
+     * @brief      Adds the points of independent tips, e.g. the distributions
+     *             of the matchdays of a season.
+     *
+     * @param[in]  other  The other distribution.
+     */
+    void add(const PointDistribution& other);
+
+    /**
+     * @brief      Resets to zero points for sure.
+     */
+    void clear();
+
+    /**
+     * @brief      Returns the largest possible total.
+     */
+    int maxPoints() const { return (int)m_probabilities.size() - 1; }
+
+    /**
+     * @brief      Returns the probability of a total of exactly points.
+     */
+    double probability(int points) const;
+
+    /**
+     * @brief      Returns the probability of a total of at least points.
+     */
+    double probabilityAtLeast(int points) const;
+
+    /**
+     * @brief      Returns the expected total.
+     */
+    double mean() const;
+
+    /**
+     * @brief      Returns the probabilities of all totals from 0 to
+     *             maxPoints().
+     */
+    gsl::span<const double> probabilities() const { return m_probabilities; }
+
+private:
+    /// probability of every total, index is the number of points
+    std::vector<double> m_probabilities;
+    /// target of the convolutions, kept to avoid allocations
+    std::vector<double> m_buffer;
+};
+} // namespace kwa
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "match_estimator.h"
+
+namespace kwa {
+class ThreadPool;
+
+/**
+ * @brief      Settings of SeasonSimulator::run().
+ */
+struct SeasonSimulationSettings
+{
+    /// Statistics of the fixture estimations. The matches of the current
+    /// season before context.max_date make up the current table.
+    QueryContext context;
+    /// First date of the current season, -1 to start with an empty table.
+    int season_start = -1;
+    /// Number of simulated seasons.
+    uint64_t season_count = 100000;
+    /// Seed of the random numbers. The same seed gives the same result on
+    /// any number of threads.
+    uint64_t seed = 0;
+};
+
+/**
+ * @brief      Final table probabilities, see SeasonSimulator::run().
+ */
+struct SeasonSimulationResult
+{
+    /// Teams of the table sorted by id, indices below refer to this array.
+    std::vector<TeamId> teams;
+    uint64_t season_count = 0;
+    /// Number of seasons team i finished on position p (0 is the champion)
+    /// at [i * teams.size() + p].
+    std::vector<uint64_t> position_counts;
+    /// Number of seasons team i scored the most goals, ties count for all
+    /// tied teams.
+    std::vector<uint64_t> most_goals_counts;
+    /// Mean final points of team i.
+    std::vector<double> expected_points;
+
+    /**
+     * @brief      Returns the probability of team index i to finish on
+     *             position p.
+     */
+    double positionProbability(size_t i, size_t p) const
+    {
+        return (double)position_counts[i * teams.size() + p] / (double)season_count;
+    }
+};
+
+/**
+ * @brief      Simulates the rest of a season many times to get the
+ *             probabilities of the final table, e.g. for bets on the champion
+ *             or the relegation. Every fixture's score is drawn from the score
+ *             matrix MatchEstimator::estimate() uses, Poisson distributions
+ *             with the low score correction, without tail truncation or
+ *             caches. Teams are ranked by points, goal difference and goals,
+ *             remaining ties are broken at random.
+ *
+ *             Each season draws from its own counter-based random stream, so
+ *             seasons run on all threads of a pool without shared state and
+ *             the result does not depend on the scheduling.
+ */
+class SeasonSimulator
+{
+public:
+    /**
+     * @brief      Constructor.
+     *
+     * @param[in]  thread_count  The number of threads, 0 for as many as there
+     *                           are cores.
+     */
+    explicit SeasonSimulator(size_t thread_count = 0);
+    ~SeasonSimulator();
+
+    SeasonSimulator(const SeasonSimulator&) = delete;
+    SeasonSimulator& operator=(const SeasonSimulator&) = delete;
+
+    /**
+     * @brief      Simulates the remaining fixtures of a season. The team
+     *             statistics MUST be up to date, see
+     *             MatchEstimator::recalculateTeamStatistics().
+     *
+     * @param[in]  estimator  The estimator with the history and the matches
+     *                        played so far.
+     * @param[in]  fixtures   The pairs of home and guest team ids of the
+     *                        remaining matches.
+     * @param[in]  settings   The settings.
+     * @param      out        Output.
+     *
+     * @return     false if a team of a fixture has no statistics in the
+     *             context, out is empty in that case.
+     */
+    bool run(const MatchEstimator& estimator,
+             gsl::span<const std::pair<TeamId, TeamId>> fixtures,
+             const SeasonSimulationSettings& settings, SeasonSimulationResult& out);
+
+private:
+    std::unique_ptr<ThreadPool> m_pool;
+};
+} // namespace kwa
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include "date_index.h"
 #include "kwa_common.h"
 
 namespace kwa {
@@ -42,9 +43,11 @@ public:
 
     /**
      * @brief      Adds a range of matches. The range MUST be sorted by date in
-     *             ascending order. Automatically registers teams with an id
-     *             greater than the specified team_count in the constructor or
-     *             via setTeamCount().
+     *             ascending order and MUST NOT start before the last match
+     *             added so far, so the prefix sums can be extended in O(k).
+     *             Automatically registers teams with an id greater than the
+     *             specified team_count in the constructor or via
+     *             setTeamCount().
      *
      * @param[in]  matches   The range of matches. SORTED by date.
      * @param[in]  goal_cap  An optional goal cap. Example: goal_cap=5, then a
@@ -238,7 +241,159 @@ public:
      */
     int getLeagueStatsBefore(int before_date, size_t num_matches, LeagueStats& out) const;
 
+    /**
+     * @brief      Checks if there is data of home matches for a team in a date
+     *             range.
+     *
+     * @param[in]  team       team id
+     * @param[in]  from_date  First date of the range, inclusive.
+     * @param[in]  to_date    Date after the range, exclusive. If set to -1 the
+     *                        range has no upper limit.
+     *
+     * @return     true if data available
+     */
+    bool hasHomeStatsBetween(TeamId team, int from_date, int to_date) const;
+
+    /**
+     * @brief      Checks if there is data of guest matches for a team in a date
+     *             range.
+     *
+     * @param[in]  team       team id
+     * @param[in]  from_date  First date of the range, inclusive.
+     * @param[in]  to_date    Date after the range, exclusive. If set to -1 the
+     *                        range has no upper limit.
+     *
+     * @return     true if data available
+     */
+    bool hasGuestStatsBetween(TeamId team, int from_date, int to_date) const;
+
+    /**
+     * @brief      Gets the home stats from one team. Including only matches
+     *             in the date range [from_date, to_date).
+     *
+     * @param[in]  team       Team id. The team MUST be in the database.
+     * @param[in]  from_date  First date of the range, inclusive.
+     * @param[in]  to_date    Date after the range, exclusive. If set to -1 the
+     *                        range has no upper limit.
+     * @param      out        Output.
+     *
+     * @return     the number of matches considered or -1 if there is none.
+     */
+    int getHomeStatsBetween(TeamId team, int from_date, int to_date, TeamStats& out) const;
+
+    /**
+     * @brief      Gets the guest stats from one team. Including only matches
+     *             in the date range [from_date, to_date).
+     *
+     * @param[in]  team       Team id. The team MUST be in the database.
+     * @param[in]  from_date  First date of the range, inclusive.
+     * @param[in]  to_date    Date after the range, exclusive. If set to -1 the
+     *                        range has no upper limit.
+     * @param      out        Output.
+     *
+     * @return     the number of matches considered or -1 if there is none.
+     */
+    int getGuestStatsBetween(TeamId team, int from_date, int to_date, TeamStats& out) const;
+
+    /**
+     * @brief      Gets the overall stats. Considering only matches in the date
+     *             range [from_date, to_date).
+     *
+     * @param[in]  from_date  First date of the range, inclusive.
+     * @param[in]  to_date    Date after the range, exclusive. If set to -1 the
+     *                        range has no upper limit.
+     * @param      out        Output.
+     *
+     * @return     the number of matches considered or -1 if there is none.
+     */
+    int getLeagueStatsBetween(int from_date, int to_date, LeagueStats& out) const;
+
+    /**
+     * @brief      Checks if there is data of any matches for a team, home and
+     *             away combined.
+     *
+     * @param[in]  team      team id
+     * @param[in]  max_date  Optional date. If set it will be checked if there
+     *                       is data before the specified date for the team. If
+     *                       set to -1 it will be ignored.
+     *
+     * @return     true if data available
+     */
+    bool hasTotalStats(TeamId team, int max_date = -1) const;
+
+    /**
+     * @brief      Gets the stats from one team over home and away matches
+     *             combined. Fills the TeamStats::TOTAL slot. Including all
+     *             matches that have been added.
+     *
+     * @param[in]  team  Team id. The team MUST be in the database and MUST have
+     *                   match data.
+     * @param      out   Output.
+     *
+     * @return     the number of matches considered.
+     */
+    int getTotalStats(TeamId team, TeamStats& out) const;
+
+    /**
+     * @brief      Gets the TOTAL stats from one team. Including only a maximal
+     *             number of recent home or away matches.
+     *
+     * @param[in]  team         Team id. The team MUST be in the database and
+     *                          MUST have match data.
+     * @param[in]  num_matches  Number of matches to consider.
+     * @param      out          Output.
+     *
+     * @return     the number of matches actually considered.
+     */
+    int getTotalStats(TeamId team, size_t num_matches, TeamStats& out) const;
+
+    /**
+     * @brief      Gets the TOTAL stats from one team. Including only matches
+     *             before the specified date.
+     *
+     * @param[in]  team         Team id. The team MUST be in the database.
+     * @param[in]  before_date  The date.
+     * @param      out          Output.
+     *
+     * @return     the number of matches considered or -1 if there is none.
+     */
+    int getTotalStatsBefore(TeamId team, int before_date, TeamStats& out) const;
+
+    /**
+     * @brief      Gets the TOTAL stats from one team. Including only matches
+     *             before the specified date and only a maximum number of
+     *             matches.
+     *
+     * @param[in]  team         Team id. The team MUST be in the database.
+     * @param[in]  before_date  The date.
+     * @param[in]  num_matches  Maximum number of matches.
+     * @param      out          Output.
+     *
+     * @return     the number of matches considered or -1 if there is none.
+     */
+    int getTotalStatsBefore(TeamId team, int before_date, size_t num_matches, TeamStats& out) const;
+
+    /**
+     * @brief      Gets the TOTAL stats from one team. Including only matches
+     *             in the date range [from_date, to_date).
+     *
+     * @param[in]  team       Team id. The team MUST be in the database.
+     * @param[in]  from_date  First date of the range, inclusive.
+     * @param[in]  to_date    Date after the range, exclusive. If set to -1 the
+     *                        range has no upper limit.
+     * @param      out        Output.
+     *
+     * @return     the number of matches considered or -1 if there is none.
+     */
+    int getTotalStatsBetween(TeamId team, int from_date, int to_date, TeamStats& out) const;
+
 private:
+    friend struct SnapshotAccess;
+
+    // a team plays about once a week at home and away, so 8 day buckets keep
+    // the per team indexes small and the scan inside a bucket short
+    static constexpr int TEAM_DATE_BUCKET_SHIFT = 3;
+
     struct PerTeamData
     {
         std::vector<int> home_goals;
@@ -247,9 +402,20 @@ private:
         std::vector<int> away_against;
         std::vector<int> home_dates;
         std::vector<int> guest_dates;
+        // home and away matches merged, only used for teams
+        std::vector<int> total_goals;
+        std::vector<int> total_against;
+        std::vector<int> total_dates;
+        DateIndex home_index{TEAM_DATE_BUCKET_SHIFT};
+        DateIndex guest_index{TEAM_DATE_BUCKET_SHIFT};
+        DateIndex total_index{TEAM_DATE_BUCKET_SHIFT};
     };
     std::vector<PerTeamData> m_team_data;
     PerTeamData m_overall_stats;
+    DateIndex m_league_index;
+
+    void rebuildDateIndexes();
+    static size_t countBefore(const DateIndex& index, const std::vector<int>& dates, int date);
 
     void registerTeam(TeamId team_id);
     PerTeamData& getTeamData(TeamId team_id);
@@ -1,13 +1,14 @@
 #pragma once
 
-#include <string>
+#include <cstdint>
 #include <vector>
-#include <unordered_map>
 #include "kwa_common.h"
 
 namespace kwa {
 /*!
- * @brief      Maps team names to unique ids.
+ * @brief      Maps team names to unique ids. The names are stored in one
+ *             contiguous buffer, the ids are found via an open addressing hash
+ *             table, so lookups do not allocate memory.
  */
 class TeamRegister
 {
@@ -16,16 +17,27 @@ public:
      * @brief      Add a new team and create a new id or return the id of an
      *             existing team.
      *
-     * @param      name  (const std::string &): Name of team.
+     * @param      name  (const char*): Name of team.
      *
      * @return     (TeamId): Valid team id.
      */
     auto registerTeam(const char* name) -> TeamId;
 
+    /*!
+     * @brief      Add a new team and create a new id or return the id of an
+     *             existing team.
+     *
+     * @param      name  (gsl::cstring_span<>): Name of team, does not need to
+     *                   be zero terminated.
+     *
+     * @return     (TeamId): Valid team id.
+     */
+    auto registerTeam(gsl::cstring_span<> name) -> TeamId;
+
     /*!
      * @brief      Get the id of an existing team.
      *
-     * @param      name  (const std::string &): Name of team.
+     * @param      name  (const char*): Name of team.
      *
      * @return     (TeamId): Valid team id if team exists or INVALID_TEAM_ID if
      *             not.
@@ -33,13 +45,26 @@ public:
     auto getId(const char* name) const -> TeamId;
 
     /*!
-     * @brief      Get the name of a team by its id.
+     * @brief      Get the id of an existing team.
+     *
+     * @param      name  (gsl::cstring_span<>): Name of team, does not need to
+     *                   be zero terminated.
+     *
+     * @return     (TeamId): Valid team id if team exists or INVALID_TEAM_ID if
+     *             not.
+     */
+    auto getId(gsl::cstring_span<> name) const -> TeamId;
+
+    /*!
+     * @brief      Get the name of a team by its id. The name is followed by a
+     *             zero, so data() can be used as C string. Valid until the
+     *             next team is registered.
      *
      * @param      id    (TeamId): Team id MUST be valid.
      *
-     * @return     (const std::string&): Team name.
+     * @return     (gsl::cstring_span<>): Team name.
      */
-    auto teamName(TeamId id) const -> const std::string&;
+    auto teamName(TeamId id) const -> gsl::cstring_span<>;
 
     /*!
      * @brief      Deletes all registered teams.
@@ -51,10 +76,22 @@ public:
      *
      * @return     (size_t): Count of teams.
      */
-    auto size() const { return m_team_names.size(); }
+    auto size() const { return m_name_offsets.size() - 1; }
 
 private:
-    std::vector<std::string> m_team_names;
-    std::unordered_map<std::string, TeamId> m_team_ids_by_name;
+    struct Slot
+    {
+        uint32_t hash;
+        TeamId id;
+    };
+
+    // names with terminating zeros, name i starts at m_name_offsets[i]
+    std::vector<char> m_names;
+    std::vector<uint32_t> m_name_offsets{0};
+    // power of two size, empty slots have id INVALID_TEAM_ID
+    std::vector<Slot> m_slots;
+
+    auto findSlot(gsl::cstring_span<> name, uint32_t hash) const -> size_t;
+    void grow();
 };
 } // namespace kwa
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "match_estimator.h"
+
+namespace kwa {
+class ThreadPool;
+
+/**
+ * @brief      A tip of the opponents in a betting pool and the share of the
+ *             opponents tipping it.
+ */
+struct CrowdTip
+{
+    int home_goals;
+    int guest_goals;
+    float share;
+};
+
+/**
+ * @brief      A match of a matchday and the model of the opponents' tips.
+ */
+struct PoolMatch
+{
+    TeamId home_team;
+    TeamId guest_team;
+    /// Every opponent draws a tip by share, e.g. {{2, 1, 1.0f}} for a crowd
+    /// that tips the favourite 2:1. The shares are scaled to sum up to one.
+    /// Empty if every opponent tips the best result bet.
+    std::vector<CrowdTip> crowd;
+};
+
+/**
+ * @brief      Settings of TipOptimizer::run().
+ */
+struct TipOptimizerSettings
+{
+    /// Statistics and bet system points of the estimations.
+    QueryContext context;
+    /// Number of opponents on equal points, used if opponent_leads is empty.
+    size_t opponent_count = 29;
+    /// Points each opponent is ahead of us before the matchday, negative if
+    /// behind, one entry per opponent.
+    std::vector<float> opponent_leads;
+    /// Number of simulated matchdays of the search and of the reported
+    /// win probabilities each.
+    uint64_t scenario_count = 20000;
+    /// Tips per match the search considers, the ones with the highest
+    /// expected points.
+    size_t candidate_count = 6;
+    /// Seed of the random numbers. The same seed gives the same result on
+    /// any number of threads.
+    uint64_t seed = 0;
+};
+
+/**
+ * @brief      Result of TipOptimizer::run().
+ */
+struct TipOptimizerResult
+{
+    /// One tip per match.
+    std::vector<MatchTip> tips;
+    /// Probability to finish first, a tie for first counts as a share.
+    /// Measured on other simulated matchdays than the search used.
+    double win_probability = 0.0;
+    double expected_points = 0.0;
+    /// Same for the best result bets, for comparison.
+    double best_bet_win_probability = 0.0;
+    double best_bet_expected_points = 0.0;
+};
+
+/**
+ * @brief      Searches the tips of a matchday that maximize the probability of
+ *             finishing first in a betting pool instead of the expected
+ *             points. Tips the crowd agrees on cannot gain ground, so behind
+ *             or in a large pool contrarian tips often win more.
+ *
+ *             The results of all matches and the tips of all opponents are
+ *             simulated once for the search, every matchday draws from its own
+ *             counter-based random stream on a thread pool. The search changes
+ *             the tip of one match at a time while it improves the probability,
+ *             every candidate is evaluated on the same simulated matchdays. The
+ *             reported win probabilities come from a second, independent set of
+ *             matchdays, on the first the chosen tips look better than they
+ *             are. The score matrix of every match is computed once for all
+ *             candidate tips.
+ */
+class TipOptimizer
+{
+public:
+    /**
+     * @brief      Constructor.
+     *
+     * @param[in]  thread_count  The number of threads, 0 for as many as there
+     *                           are cores.
+     */
+    explicit TipOptimizer(size_t thread_count = 0);
+    ~TipOptimizer();
+
+    TipOptimizer(const TipOptimizer&) = delete;
+    TipOptimizer& operator=(const TipOptimizer&) = delete;
+
+    /**
+     * @brief      Optimizes the tips of a matchday. The team statistics MUST be
+     *             up to date, see MatchEstimator::recalculateTeamStatistics().
+     *
+     * @param[in]  estimator  The estimator with the history.
+     * @param[in]  matches    The matches and the opponents' tips.
+     * @param[in]  settings   The settings.
+     * @param      out        Output.
+     *
+     * @return     false if a team of a match has no statistics in the context,
+     *             out is empty in that case.
+     */
+    bool run(const MatchEstimator& estimator, gsl::span<const PoolMatch> matches,
+             const TipOptimizerSettings& settings, TipOptimizerResult& out);
+
+private:
+    std::unique_ptr<ThreadPool> m_pool;
+};
+} // namespace kwa
@@ -0,0 +1,167 @@
+#include "backtester.h"
+#include <algorithm>
+#include "calculations.h"
+#include "thread_pool.h"
+
+namespace {
+/**
+ * Outcome of the bet on one match.
+ */
+struct Bet
+{
+    float points;
+    kwa::eTipHit hit;
+    /// false if a team has no statistics
+    bool placed;
+};
+
+void addBet(kwa::BacktestPoints& points, const Bet& bet)
+{
+    ++points.match_count;
+    if (!bet.placed) return;
+    ++points.bet_count;
+    points.points += bet.points;
+    points.result_hits += bet.hit == kwa::TIP_RESULT ? 1 : 0;
+    points.difference_hits += bet.hit == kwa::TIP_DIFFERENCE ? 1 : 0;
+    points.tendency_hits += bet.hit == kwa::TIP_TENDENCY ? 1 : 0;
+}
+
+int seasonOf(int date, int season_start_month)
+{
+    return kwa::match_year(date) -
+           (kwa::match_month(date) < season_start_month ? 1 : 0);
+}
+} // namespace
+
+float kwa::CalculateBetPoints(int bet_home_goals, int bet_guest_goals,
+                              int home_goals, int guest_goals,
+                              const BetSystemPoints& system_points)
+{
+    return CalculateTipPoints(
+        CalculateTipHit(bet_home_goals, bet_guest_goals, home_goals,
+                        guest_goals),
+        system_points);
+}
+
+kwa::Backtester::Backtester(size_t thread_count)
+    : m_pool(new ThreadPool(thread_count))
+{
+}
+
+kwa::Backtester::~Backtester() = default;
+
+size_t kwa::Backtester::threadCount() const
+{
+    return m_pool->threadCount();
+}
+
+void kwa::Backtester::run(const MatchEstimator& estimator,
+                          const BacktestSettings& settings,
+                          BacktestResult& out)
+{
+    std::vector<BacktestResult> results;
+    run(estimator, gsl::span<const BacktestSettings>(&settings, 1), results);
+    out = std::move(results.front());
+}
+
+void kwa::Backtester::run(const MatchEstimator& estimator,
+                          gsl::span<const BacktestSettings> settings,
+                          std::vector<BacktestResult>& out)
+{
+    const auto matches = estimator.matches();
+
+    /**
+     * Matches in the date range of one entry of settings ordered by date,
+     * split into matchdays.
+     */
+    struct Plan
+    {
+        std::vector<uint32_t> order;
+        std::vector<size_t> matchday_begin;
+        std::vector<Bet> bets;
+        size_t first_task;
+    };
+
+    std::vector<Plan> plans((size_t)settings.size());
+    size_t task_count = 0;
+    for (size_t s = 0; s < plans.size(); ++s) {
+        const auto& set = settings[(std::ptrdiff_t)s];
+        auto& plan = plans[s];
+        for (std::ptrdiff_t i = 0; i < matches.size(); ++i) {
+            const int date = matches[i].day;
+            if (date < set.first_date) continue;
+            if (set.last_date >= 0 && date >= set.last_date) continue;
+            plan.order.push_back((uint32_t)i);
+        }
+        std::stable_sort(plan.order.begin(), plan.order.end(),
+                         [&matches](uint32_t a, uint32_t b) {
+                             return matches[a].day < matches[b].day;
+                         });
+        for (size_t i = 0; i < plan.order.size(); ++i) {
+            if (i == 0 || matches[plan.order[i]].day !=
+                              matches[plan.order[i - 1]].day)
+                plan.matchday_begin.push_back(i);
+        }
+        plan.matchday_begin.push_back(plan.order.size());
+        // every matchday writes its own range of bets
+        plan.bets.resize(plan.order.size());
+        plan.first_task = task_count;
+        task_count += plan.matchday_begin.size() - 1;
+    }
+
+    // one task per matchday of every settings, all in the same pool run
+    m_pool->run(task_count, [&](size_t task) {
+        const auto it = std::upper_bound(
+            plans.begin(), plans.end(), task,
+            [](size_t t, const Plan& plan) { return t < plan.first_task; });
+        const size_t s = (size_t)std::distance(plans.begin(), it) - 1;
+        auto& plan = plans[s];
+        const size_t matchday = task - plan.first_task;
+
+        QueryContext context = settings[(std::ptrdiff_t)s].context;
+        for (size_t i = plan.matchday_begin[matchday];
+             i < plan.matchday_begin[matchday + 1]; ++i) {
+            const auto& match = matches[plan.order[i]];
+            context.max_date = match.day;
+            if (!estimator.hasHomeStatistics(match.home_team, context) ||
+                !estimator.hasGuestStatistics(match.guest_team, context)) {
+                plan.bets[i] = Bet{0.0f, TIP_MISS, false};
+                continue;
+            }
+
+            MatchEstimation estimation;
+            estimator.estimate(estimation, match.home_team, match.guest_team,
+                               context);
+            const eTipHit hit =
+                CalculateTipHit(estimation.best_result_bet_home_goals,
+                                estimation.best_result_bet_guest_goals,
+                                match.home_goals, match.guest_goals);
+            plan.bets[i] =
+                Bet{CalculateTipPoints(hit, context.system_points), hit, true};
+        }
+    });
+
+    // sum up in date order, the result does not depend on the scheduling
+    out.resize(plans.size());
+    for (size_t s = 0; s < plans.size(); ++s) {
+        const auto& plan = plans[s];
+        auto& result = out[s];
+        result.total = BacktestPoints();
+        result.seasons.clear();
+        result.teams.assign(estimator.teamRegister().size(), BacktestPoints());
+        for (size_t i = 0; i < plan.order.size(); ++i) {
+            const auto& match = matches[plan.order[i]];
+            const int season = seasonOf(
+                match.day, settings[(std::ptrdiff_t)s].season_start_month);
+            if (result.seasons.empty() ||
+                result.seasons.back().season != season)
+                result.seasons.push_back(
+                    BacktestSeason{season, BacktestPoints()});
+
+            addBet(result.total, plan.bets[i]);
+            addBet(result.seasons.back().points, plan.bets[i]);
+            addBet(result.teams[(size_t)match.home_team], plan.bets[i]);
+            addBet(result.teams[(size_t)match.guest_team], plan.bets[i]);
+        }
+    }
+}
@@ -0,0 +1,165 @@
+#include "batch_kernel.h"
+#include <algorithm>
+
+#if KWA_BATCH_X86
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+struct ScalarVec
+{
+    static constexpr size_t width = 1;
+    float v;
+
+    ScalarVec() = default;
+    explicit ScalarVec(float value) : v(value) {}
+
+    static ScalarVec load(const float* src) { return ScalarVec(*src); }
+    void store(float* dst) const { *dst = v; }
+    static ScalarVec select(bool mask, ScalarVec a, ScalarVec b) { return mask ? a : b; }
+
+    friend ScalarVec operator+(ScalarVec a, ScalarVec b) { return ScalarVec(a.v + b.v); }
+    friend ScalarVec operator-(ScalarVec a, ScalarVec b) { return ScalarVec(a.v - b.v); }
+    friend ScalarVec operator*(ScalarVec a, ScalarVec b) { return ScalarVec(a.v * b.v); }
+    friend bool operator>(ScalarVec a, ScalarVec b) { return a.v > b.v; }
+};
+
+#if KWA_BATCH_X86 && (defined(__SSE2__) || defined(_M_X64))
+#define KWA_BATCH_SSE2 1
+struct Sse2Vec
+{
+    static constexpr size_t width = 4;
+    __m128 v;
+
+    Sse2Vec() = default;
+    explicit Sse2Vec(float value) : v(_mm_set1_ps(value)) {}
+    explicit Sse2Vec(__m128 value) : v(value) {}
+
+    static Sse2Vec load(const float* src) { return Sse2Vec(_mm_loadu_ps(src)); }
+    void store(float* dst) const { _mm_storeu_ps(dst, v); }
+    static Sse2Vec select(Sse2Vec mask, Sse2Vec a, Sse2Vec b)
+    {
+        return Sse2Vec(_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)));
+    }
+
+    friend Sse2Vec operator+(Sse2Vec a, Sse2Vec b) { return Sse2Vec(_mm_add_ps(a.v, b.v)); }
+    friend Sse2Vec operator-(Sse2Vec a, Sse2Vec b) { return Sse2Vec(_mm_sub_ps(a.v, b.v)); }
+    friend Sse2Vec operator*(Sse2Vec a, Sse2Vec b) { return Sse2Vec(_mm_mul_ps(a.v, b.v)); }
+    friend Sse2Vec operator>(Sse2Vec a, Sse2Vec b) { return Sse2Vec(_mm_cmpgt_ps(a.v, b.v)); }
+};
+#else
+#define KWA_BATCH_SSE2 0
+#endif
+
+// all kernels work on inputs padded to this many matches
+constexpr const size_t MAX_KERNEL_WIDTH = 8;
+
+bool cpuSupportsAvx2()
+{
+    if (!kwa::IsAvx2KernelCompiled()) return false;
+#if !KWA_BATCH_X86
+    return false;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+kwa::eBatchKernel bestKernel()
+{
+    static const kwa::eBatchKernel kernel =
+        cpuSupportsAvx2() ? kwa::BATCH_KERNEL_AVX2
+                          : (KWA_BATCH_SSE2 ? kwa::BATCH_KERNEL_SSE2
+                                            : kwa::BATCH_KERNEL_SCALAR);
+    return kernel;
+}
+} // namespace
+
+void kwa::MatchEstimationBatch::resize(size_t count)
+{
+    home_win.resize(count);
+    draw.resize(count);
+    guest_win.resize(count);
+    best_result_bet_home_goals.resize(count);
+    best_result_bet_guest_goals.resize(count);
+    best_result_bet_ev.resize(count);
+    truncation_error.resize(count);
+}
+
+bool kwa::IsBatchKernelSupported(eBatchKernel kernel)
+{
+    switch (kernel) {
+    case BATCH_KERNEL_AUTO:
+    case BATCH_KERNEL_SCALAR:
+        return true;
+    case BATCH_KERNEL_SSE2:
+        return KWA_BATCH_SSE2 != 0;
+    case BATCH_KERNEL_AVX2:
+        return cpuSupportsAvx2();
+    }
+    return false;
+}
+
+void kwa::EstimateBatch(gsl::span<const float> home_evs,
+                        gsl::span<const float> guest_evs,
+                        const BetSystemPoints& system_points,
+                        MatchEstimationBatch& out, eBatchKernel kernel,
+                        float correction)
+{
+    assert(home_evs.size() == guest_evs.size());
+    assert(IsBatchKernelSupported(kernel));
+    if (kernel == BATCH_KERNEL_AUTO) kernel = bestKernel();
+
+    // pad to whole blocks, the padding lanes compute a dummy match
+    const size_t count = (size_t)home_evs.size();
+    const size_t padded =
+        (count + MAX_KERNEL_WIDTH - 1) / MAX_KERNEL_WIDTH * MAX_KERNEL_WIDTH;
+    std::vector<float> inputs(2 * padded, 1.0f);
+    std::copy(home_evs.begin(), home_evs.end(), inputs.begin());
+    std::copy(guest_evs.begin(), guest_evs.end(), inputs.begin() + padded);
+
+    out.resize(count);
+    std::vector<float> results(7 * padded);
+    BatchBlockOut block_out{results.data(),
+                            results.data() + padded,
+                            results.data() + 2 * padded,
+                            results.data() + 3 * padded,
+                            results.data() + 4 * padded,
+                            results.data() + 5 * padded,
+                            results.data() + 6 * padded};
+
+    const float* home = inputs.data();
+    const float* guest = inputs.data() + padded;
+    if (kernel == BATCH_KERNEL_AVX2) {
+        EstimateBatchAvx2(home, guest, padded, system_points, correction,
+                          block_out);
+    } else if (kernel == BATCH_KERNEL_SSE2) {
+#if KWA_BATCH_SSE2
+        estimateBlocks<Sse2Vec>(home, guest, padded, system_points, correction,
+                                block_out);
+#endif
+    } else {
+        estimateBlocks<ScalarVec>(home, guest, padded, system_points,
+                                  correction, block_out);
+    }
+
+    std::copy_n(block_out.home_win, count, out.home_win.begin());
+    std::copy_n(block_out.draw, count, out.draw.begin());
+    std::copy_n(block_out.guest_win, count, out.guest_win.begin());
+    std::copy_n(block_out.best_ev, count, out.best_result_bet_ev.begin());
+    for (size_t i = 0; i < count; ++i) {
+        out.best_result_bet_home_goals[i] = (int)block_out.best_home_goals[i];
+        out.best_result_bet_guest_goals[i] = (int)block_out.best_guest_goals[i];
+        out.truncation_error[i] = std::max(0.0f, block_out.truncation_error[i]);
+    }
+}
@@ -0,0 +1,75 @@
+// Only the kernel is compiled for AVX2, it is called after checking the CPU,
+// see EstimateBatch().
+#if defined(__GNUC__)
+#define KWA_AVX2 __attribute__((target("avx2")))
+#else
+// MSVC emits AVX2 intrinsics without /arch
+#define KWA_AVX2
+#endif
+#define KWA_BATCH_TARGET KWA_AVX2
+#include "batch_kernel.h"
+
+#if KWA_BATCH_X86 && (defined(__GNUC__) || defined(_MSC_VER))
+#include <immintrin.h>
+
+namespace {
+struct Avx2Vec
+{
+    static constexpr size_t width = 8;
+    __m256 v;
+
+    Avx2Vec() = default;
+    KWA_AVX2 explicit Avx2Vec(float value) : v(_mm256_set1_ps(value)) {}
+    KWA_AVX2 explicit Avx2Vec(__m256 value) : v(value) {}
+
+    KWA_AVX2 static Avx2Vec load(const float* src) { return Avx2Vec(_mm256_loadu_ps(src)); }
+    KWA_AVX2 void store(float* dst) const { _mm256_storeu_ps(dst, v); }
+    KWA_AVX2 static Avx2Vec select(Avx2Vec mask, Avx2Vec a, Avx2Vec b)
+    {
+        return Avx2Vec(_mm256_blendv_ps(b.v, a.v, mask.v));
+    }
+
+    KWA_AVX2 friend Avx2Vec operator+(Avx2Vec a, Avx2Vec b)
+    {
+        return Avx2Vec(_mm256_add_ps(a.v, b.v));
+    }
+    KWA_AVX2 friend Avx2Vec operator-(Avx2Vec a, Avx2Vec b)
+    {
+        return Avx2Vec(_mm256_sub_ps(a.v, b.v));
+    }
+    KWA_AVX2 friend Avx2Vec operator*(Avx2Vec a, Avx2Vec b)
+    {
+        return Avx2Vec(_mm256_mul_ps(a.v, b.v));
+    }
+    KWA_AVX2 friend Avx2Vec operator>(Avx2Vec a, Avx2Vec b)
+    {
+        return Avx2Vec(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ));
+    }
+};
+} // namespace
+
+KWA_AVX2 void kwa::EstimateBatchAvx2(const float* home_evs,
+                                     const float* guest_evs, size_t count,
+                                     const BetSystemPoints& system_points,
+                                     float correction, const BatchBlockOut& out)
+{
+    estimateBlocks<Avx2Vec>(home_evs, guest_evs, count, system_points,
+                            correction, out);
+}
+
+bool kwa::IsAvx2KernelCompiled()
+{
+    return true;
+}
+#else
+void kwa::EstimateBatchAvx2(const float*, const float*, size_t,
+                            const BetSystemPoints&, float, const BatchBlockOut&)
+{
+    assert(false);
+}
+
+bool kwa::IsAvx2KernelCompiled()
+{
+    return false;
+}
+#endif
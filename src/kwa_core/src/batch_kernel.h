@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cmath>
+#include "batch_estimation.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KWA_BATCH_X86 1
+#else
+#define KWA_BATCH_X86 0
+#endif
+
+// Target attribute of the kernel functions. The file is compiled for the
+// baseline instruction set, only the kernel is compiled for a wider one, so
+// no inline function shared with other files gets wider instructions.
+#ifndef KWA_BATCH_TARGET
+#define KWA_BATCH_TARGET
+#endif
+
+namespace kwa {
+/**
+ * Output pointers of one block of matches.
+ */
+struct BatchBlockOut
+{
+    float* home_win;
+    float* draw;
+    float* guest_win;
+    float* best_home_goals;
+    float* best_guest_goals;
+    float* best_ev;
+    float* truncation_error;
+};
+
+// implemented in batch_estimation_avx2.cpp, the kernel targets AVX2
+extern bool IsAvx2KernelCompiled();
+extern void EstimateBatchAvx2(const float* home_evs, const float* guest_evs, size_t count,
+                              const BetSystemPoints& system_points, float correction,
+                              const BatchBlockOut& out);
+} // namespace kwa
+
+// Internal linkage on purpose: every translation unit instantiates the kernel
+// with its own instruction set, the linker must not merge them.
+namespace {
+/**
+ * Estimates V::width matches. V is a vector of floats with the operators
+ * +, -, * and >, a broadcast constructor, load(), store() and select().
+ * Follows FillPoissonDistribution(), FillScoreMatrix(), CalculateThreeWayBet()
+ * and CalculateBestBet() lane by lane, up to rounding.
+ */
+template<typename V>
+KWA_BATCH_TARGET void estimateBlock(const float* home_evs, const float* guest_evs,
+                   const kwa::BetSystemPoints& system_points, float correction,
+                   const kwa::BatchBlockOut& out, size_t offset)
+{
+    constexpr int N = (int)kwa::MAX_GOALS + 1;
+    const V home_ev = V::load(home_evs + offset);
+    const V guest_ev = V::load(guest_evs + offset);
+
+    // exp() is needed once per distribution, scalar is fine
+    alignas(32) float exp_home[V::width];
+    alignas(32) float exp_guest[V::width];
+    for (size_t lane = 0; lane < V::width; ++lane) {
+        exp_home[lane] = std::exp(-home_evs[offset + lane]);
+        exp_guest[lane] = std::exp(-guest_evs[offset + lane]);
+    }
+
+    V home[N], guest[N];
+    home[0] = V::load(exp_home);
+    guest[0] = V::load(exp_guest);
+    for (int k = 1; k < N; ++k) {
+        home[k] = home[k - 1] * (home_ev * V(1.0f / (float)k));
+        guest[k] = guest[k - 1] * (guest_ev * V(1.0f / (float)k));
+    }
+
+    // the correction keeps the sum of all scores
+    V home_sum(0.0f), guest_sum(0.0f);
+    for (int k = 0; k < N; ++k) {
+        home_sum = home_sum + home[k];
+        guest_sum = guest_sum + guest[k];
+    }
+
+    V scores[N][N];
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) scores[i][j] = home[i] * guest[j];
+    }
+    const V rho(correction);
+    scores[0][0] = scores[0][0] * (V(1.0f) + rho * home_ev * guest_ev);
+    scores[1][1] = scores[1][1] * V(1.0f + correction);
+    scores[1][0] = scores[1][0] * (V(1.0f) - rho * guest_ev);
+    scores[0][1] = scores[0][1] * (V(1.0f) - rho * home_ev);
+
+    V diff_props[2 * N - 1];
+    for (auto& prop : diff_props) prop = V(0.0f);
+    V home_win(0.0f), draw(0.0f), guest_win(0.0f);
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+            diff_props[i - j + N - 1] = diff_props[i - j + N - 1] + scores[i][j];
+            if (i > j)
+                home_win = home_win + scores[i][j];
+            else if (i == j)
+                draw = draw + scores[i][j];
+            else
+                guest_win = guest_win + scores[i][j];
+        }
+    }
+
+    const V result_points(system_points.result);
+    const V difference_points(system_points.difference);
+    const V tendency_points(system_points.tendency);
+    V best_ev(0.0f), best_home(0.0f), best_guest(0.0f);
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+            const int diff = i - j;
+            const V exact = scores[i][j];
+            const V same_diff = diff_props[diff + N - 1];
+
+            V ev = exact * result_points;
+            if (diff == 0) {
+                ev = ev + (same_diff - exact) * tendency_points;
+            } else {
+                const V tendency = diff > 0 ? home_win : guest_win;
+                ev = ev + (same_diff - exact) * difference_points;
+                ev = ev + (tendency - same_diff) * tendency_points;
+            }
+
+            const auto better = ev > best_ev;
+            best_ev = V::select(better, ev, best_ev);
+            best_home = V::select(better, V((float)i), best_home);
+            best_guest = V::select(better, V((float)j), best_guest);
+        }
+    }
+
+    home_win.store(out.home_win + offset);
+    draw.store(out.draw + offset);
+    guest_win.store(out.guest_win + offset);
+    best_home.store(out.best_home_goals + offset);
+    best_guest.store(out.best_guest_goals + offset);
+    best_ev.store(out.best_ev + offset);
+    (V(1.0f) - home_sum * guest_sum).store(out.truncation_error + offset);
+}
+
+/**
+ * Runs estimateBlock() over all matches. The inputs and outputs MUST be
+ * padded to a multiple of V::width.
+ */
+template<typename V>
+KWA_BATCH_TARGET void estimateBlocks(const float* home_evs, const float* guest_evs,
+                    size_t count, const kwa::BetSystemPoints& system_points,
+                    float correction, const kwa::BatchBlockOut& out)
+{
+    for (size_t offset = 0; offset < count; offset += V::width)
+        estimateBlock<V>(home_evs, guest_evs, system_points, correction, out,
+                         offset);
+}
+} // namespace
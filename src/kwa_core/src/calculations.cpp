@@ -1,28 +1,46 @@
 #include "calculations.h"
-
-static int factorial(int n)
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace {
+// 1/k! is a normal float up to k = 33
+constexpr const int RECIPROCAL_FACTORIAL_COUNT = 34;
+static_assert(kwa::MAX_GOALS < RECIPROCAL_FACTORIAL_COUNT,
+              "MAX_GOALS exceeds the reciprocal factorial table");
+
+constexpr double reciprocal_factorial(int n)
 {
-    return (n == 1 || n == 0) ? 1 : factorial(n - 1) * n;
+    return n <= 1 ? 1.0 : reciprocal_factorial(n - 1) / n;
 }
 
-static float poisson_prop(float lambda, int k)
+template<size_t... K>
+constexpr std::array<float, sizeof...(K)>
+make_reciprocal_factorials(std::index_sequence<K...>)
 {
-    return powf(lambda, (float)k) / (float)factorial(k) * expf(-lambda);
+    return {{(float)reciprocal_factorial((int)K)...}};
 }
 
-static float poisson_correction_factor(int home_goals, int guest_goals,
-                                       float home_ev, float guest_ev)
+constexpr const std::array<float, RECIPROCAL_FACTORIAL_COUNT>
+    RECIPROCAL_FACTORIALS = make_reciprocal_factorials(
+        std::make_index_sequence<RECIPROCAL_FACTORIAL_COUNT>{});
+} // namespace
+
+static float poisson_correction_factor(
+    int home_goals, int guest_goals, float home_ev, float guest_ev,
+    float correction = kwa::DEFAULT_POISSON_CORRECTION)
 {
     if (home_goals > 1 || guest_goals > 1)
         return 1.0f;
     else if (home_goals == 0 && guest_goals == 0)
-        return 1.0f + 0.1f * home_ev * guest_ev;
+        return 1.0f + correction * home_ev * guest_ev;
     else if (home_goals == 1 && guest_goals == 1)
-        return 1.1f;
+        return 1.0f + correction;
     else if (home_goals == 1 && guest_goals == 0)
-        return 1.0f - 0.1f * guest_ev;
+        return 1.0f - correction * guest_ev;
     else if (home_goals == 0 && guest_goals == 1)
-        return 1.0f - 0.1f * home_ev;
+        return 1.0f - correction * home_ev;
 
     return 1.0f;
 }
@@ -36,25 +54,11 @@ float kwa::CalculateBetEV(int home_goals, int guest_goals,
     assert(guest_goals < guest_distr.size());
 
     float ev = 0.0f;
-    int diff = home_goals - guest_goals;
     for (int ia = 0; ia < home_distr.size(); ++ia) {
         for (int ib = 0; ib < guest_distr.size(); ++ib) {
-            int act_diff = ia - ib;
-
-            float points = 0.0f;
-
-            // correct tip
-            if (ia == home_goals && ib == guest_goals)
-                points = system_points.result;
-
-            // correct difference
-            else if (act_diff == diff)
-                points = diff == 0 ? system_points.tendency
-                                   : system_points.difference;
-
-            // correct tendency
-            else if (act_diff * diff > 0)
-                points = diff == 0 ? 0 : system_points.tendency;
+            const float points = CalculateTipPoints(
+                CalculateTipHit(home_goals, guest_goals, ia, ib),
+                system_points);
 
             float prop = home_distr[ia] * guest_distr[ib];
             prop *= poisson_correction_factor(ia, ib, home_ev, guest_ev);
@@ -64,6 +68,94 @@ float kwa::CalculateBetEV(int home_goals, int guest_goals,
     return ev;
 }
 
+void kwa::FillScoreMatrix(ScoreMatrix& out, gsl::span<const float> home_distr,
+                          gsl::span<const float> guest_distr, float home_ev,
+                          float guest_ev, float correction)
+{
+    assert(home_distr.size() * guest_distr.size() <=
+           (std::ptrdiff_t)out.probabilities.size());
+
+    out.home_size = (int)home_distr.size();
+    out.guest_size = (int)guest_distr.size();
+    auto prop = out.probabilities.begin();
+    for (int i = 0; i < out.home_size; ++i) {
+        for (int j = 0; j < out.guest_size; ++j)
+            *prop++ = home_distr[i] * guest_distr[j];
+    }
+
+    // the correction only touches the results 0:0, 1:0, 0:1 and 1:1
+    for (int i = 0; i < 2 && i < out.home_size; ++i) {
+        for (int j = 0; j < 2 && j < out.guest_size; ++j) {
+            out.probabilities[(size_t)(i * out.guest_size + j)] *=
+                poisson_correction_factor(i, j, home_ev, guest_ev, correction);
+        }
+    }
+}
+
+void kwa::FillScoreMatrix(ScoreMatrix& out, float home_ev, float guest_ev,
+                          float correction)
+{
+    GoalDistribution home_distr, guest_distr;
+    FillPoissonDistribution(home_distr, home_ev);
+    FillPoissonDistribution(guest_distr, guest_ev);
+    FillScoreMatrix(out, home_distr, guest_distr, home_ev, guest_ev,
+                    correction);
+}
+
+kwa::KicktippBet kwa::CalculateBestBet(const ScoreMatrix& scores,
+                                       const BetSystemPoints& system_points)
+{
+    // probability of every goal difference, index home - guest + guest_size
+    // - 1, and of home win and guest win
+    std::array<float, 2 * (MAX_GOALS + 1) - 1> diff_props{};
+    float home_win = 0.0f;
+    float guest_win = 0.0f;
+    const int diff_offset = scores.guest_size - 1;
+    for (int i = 0; i < scores.home_size; ++i) {
+        for (int j = 0; j < scores.guest_size; ++j) {
+            float prop = scores.at(i, j);
+            diff_props[(size_t)(i - j + diff_offset)] += prop;
+            if (i > j)
+                home_win += prop;
+            else if (i < j)
+                guest_win += prop;
+        }
+    }
+
+    KicktippBet out;
+    out.home_goals = 0;
+    out.guest_goals = 0;
+    out.ev = 0.0f;
+    out.odds = 0.0f;
+
+    // the points of CalculateTipHit() summed up per difference and tendency
+    for (int i = 0; i < scores.home_size; ++i) {
+        for (int j = 0; j < scores.guest_size; ++j) {
+            const int diff = i - j;
+            const float exact = scores.at(i, j);
+            const float same_diff = diff_props[(size_t)(diff + diff_offset)];
+
+            float ev = exact * system_points.result;
+            if (diff == 0) {
+                ev += (same_diff - exact) * system_points.tendency;
+            } else {
+                const float tendency = diff > 0 ? home_win : guest_win;
+                ev += (same_diff - exact) * system_points.difference;
+                ev += (tendency - same_diff) * system_points.tendency;
+            }
+
+            if (ev > out.ev) {
+                out.home_goals = i;
+                out.guest_goals = j;
+                out.ev = ev;
+            }
+        }
+    }
+
+    out.odds = scores.at(out.home_goals, out.guest_goals);
+    return out;
+}
+
 kwa::KicktippBet kwa::CalculateBestBet(const GoalDistribution& home_distr,
                                        const GoalDistribution& guest_distr,
                                        float home_ev, float guest_ev,
@@ -78,38 +170,75 @@ kwa::KicktippBet kwa::CalculateBestBet(const GoalDistribution& home_distr,
     out.guest_goals = 0;
     out.ev = 0.0f;
     out.odds = 0.0f;
+    if (home_cap == 0 || guest_cap == 0) return out;
 
-    float ev = 0.0f;
-    for (int i = 0; i < home_cap; ++i) {
-        for (int j = 0; j < guest_cap; ++j) {
-            ev = CalculateBetEV(i, j, make_span(home_distr, home_cap),
-                                {guest_distr.data(), guest_cap}, home_ev,
-                                guest_ev, system_points);
-            if (ev > out.ev) {
-                out.home_goals = i;
-                out.guest_goals = j;
-                out.ev = ev;
-            }
+    ScoreMatrix scores;
+    FillScoreMatrix(scores, make_span(home_distr, home_cap),
+                    make_span(guest_distr, guest_cap), home_ev, guest_ev);
+    return CalculateBestBet(scores, system_points);
+}
+
+kwa::eTipHit kwa::CalculateTipHit(int tip_home_goals, int tip_guest_goals,
+                                  int home_goals, int guest_goals)
+{
+    if (tip_home_goals == home_goals && tip_guest_goals == guest_goals)
+        return TIP_RESULT;
+    const int tip_diff = tip_home_goals - tip_guest_goals;
+    const int diff = home_goals - guest_goals;
+    if (tip_diff == diff && diff != 0) return TIP_DIFFERENCE;
+    if ((tip_diff > 0) == (diff > 0) && (tip_diff < 0) == (diff < 0))
+        return TIP_TENDENCY;
+    return TIP_MISS;
+}
+
+float kwa::CalculateTipPoints(eTipHit hit,
+                              const BetSystemPoints& system_points)
+{
+    switch (hit) {
+    case TIP_RESULT: return system_points.result;
+    case TIP_DIFFERENCE: return system_points.difference;
+    case TIP_TENDENCY: return system_points.tendency;
+    default: return 0.0f;
+    }
+}
+
+float kwa::CalculateTipEV(const TipOutcome& outcome,
+                          const BetSystemPoints& system_points)
+{
+    return outcome.result * system_points.result +
+           outcome.difference * system_points.difference +
+           outcome.tendency * system_points.tendency;
+}
+
+auto kwa::CalculateTipOutcome(const ScoreMatrix& scores, int home_goals,
+                              int guest_goals) -> TipOutcome
+{
+    float total = 0.0f;
+    float hits[TIP_RESULT + 1] = {};
+    for (int i = 0; i < scores.home_size; ++i) {
+        for (int j = 0; j < scores.guest_size; ++j) {
+            const float prop = scores.at(i, j);
+            total += prop;
+            hits[CalculateTipHit(home_goals, guest_goals, i, j)] += prop;
         }
     }
 
-    out.odds = home_distr[(size_t)out.home_goals] *
-               guest_distr[(size_t)out.guest_goals];
-    out.odds *= poisson_correction_factor(out.home_goals, out.guest_goals,
-                                          home_ev, guest_ev);
+    TipOutcome out;
+    out.result = hits[TIP_RESULT] / total;
+    out.difference = hits[TIP_DIFFERENCE] / total;
+    out.tendency = hits[TIP_TENDENCY] / total;
+    out.miss = std::max(
+        0.0f, 1.0f - out.result - out.difference - out.tendency);
     return out;
 }
 
-auto kwa::CalculateThreeWayBet(const GoalDistribution& home_distr,
-                               const GoalDistribution& guest_distr)
-    -> ThreeWayBet
+auto kwa::CalculateThreeWayBet(const ScoreMatrix& scores) -> ThreeWayBet
 {
     ThreeWayBet out{};
 
-    for (size_t i = 0; i < home_distr.size(); ++i) {
-        for (size_t j = 0; j < guest_distr.size(); ++j) {
-
-            float odds = home_distr[i] * guest_distr[j];
+    for (int i = 0; i < scores.home_size; ++i) {
+        for (int j = 0; j < scores.guest_size; ++j) {
+            float odds = scores.at(i, j);
             if (i > j)
                 out[0] += odds;
             else if (i == j)
@@ -122,8 +251,8 @@ auto kwa::CalculateThreeWayBet(const GoalDistribution& home_distr,
 }
 
 auto kwa::CalculateThreeWayBet(const GoalDistribution& home_distr,
-                               const GoalDistribution& guest_distr,
-                               float home_ev, float guest_ev) -> ThreeWayBet
+                               const GoalDistribution& guest_distr)
+    -> ThreeWayBet
 {
     ThreeWayBet out{};
 
@@ -131,8 +260,6 @@ auto kwa::CalculateThreeWayBet(const GoalDistribution& home_distr,
         for (size_t j = 0; j < guest_distr.size(); ++j) {
 
             float odds = home_distr[i] * guest_distr[j];
-            odds *=
-                poisson_correction_factor((int)i, (int)j, home_ev, guest_ev);
             if (i > j)
                 out[0] += odds;
             else if (i == j)
@@ -144,17 +271,71 @@ auto kwa::CalculateThreeWayBet(const GoalDistribution& home_distr,
     return out;
 }
 
+auto kwa::CalculateThreeWayBet(const GoalDistribution& home_distr,
+                               const GoalDistribution& guest_distr,
+                               float home_ev, float guest_ev) -> ThreeWayBet
+{
+    ScoreMatrix scores;
+    FillScoreMatrix(scores, home_distr, guest_distr, home_ev, guest_ev);
+    return CalculateThreeWayBet(scores);
+}
+
+float kwa::CalculatePoissonProbability(float lambda, int k)
+{
+    assert(k >= 0 && k < RECIPROCAL_FACTORIAL_COUNT);
+    return powf(lambda, (float)k) * RECIPROCAL_FACTORIALS[(size_t)k] *
+           expf(-lambda);
+}
+
 int kwa::FillPoissonDistribution(gsl::span<float> out, float lmbda,
                                  float thresh_hold /*= 0.0f*/)
 {
+    // p(k) = p(k - 1) * lambda / k, only one transcendental call
     int cap = 1;
+    float prop = expf(-lmbda);
     for (int i = 0; i < (int)out.size(); ++i) {
-        out[i] = poisson_prop(lmbda, i);
+        if (i > 0) prop *= lmbda / (float)i;
+        out[i] = prop;
         if (out[i] > thresh_hold) ++cap;
     }
     return cap;
 }
 
+int kwa::TruncateDistribution(gsl::span<float> distr, float epsilon,
+                              float& tail_out)
+{
+    assert(distr.size() > 0);
+    int cap = 0;
+    float kept = 0.0f;
+    while (cap < (int)distr.size() && (cap == 0 || 1.0f - kept >= epsilon))
+        kept += distr[cap++];
+
+    tail_out = std::max(0.0f, 1.0f - kept);
+    const float scale = 1.0f / kept;
+    for (int i = 0; i < cap; ++i) distr[i] *= scale;
+    return cap;
+}
+
+kwa::PoissonCache::PoissonCache(float max_lambda, int resolution)
+    : m_resolution((float)resolution),
+      m_distributions((size_t)(max_lambda * (float)resolution) + 1)
+{
+    assert(max_lambda > 0.0f && resolution > 0);
+    for (size_t i = 0; i < m_distributions.size(); ++i) {
+        FillPoissonDistribution(m_distributions[i],
+                                (float)i / m_resolution);
+    }
+}
+
+void kwa::PoissonCache::fill(GoalDistribution& out, float lambda) const
+{
+    const float index = lambda * m_resolution + 0.5f;
+    if (index >= 0.0f && index < (float)m_distributions.size())
+        out = m_distributions[(size_t)index];
+    else
+        FillPoissonDistribution(out, lambda);
+}
+
 extern float kwa::CalculateGoalEv(float attacker_goal_avg,
                                   float defender_against_avg,
                                   float league_goal_avg)
@@ -3,6 +3,70 @@
 #include <vector>
 
 namespace kwa {
+/**
+ * Joint probabilities of the results home_goals:guest_goals for
+ * home_goals < home_size and guest_goals < guest_size, including the poisson
+ * correction for low scores.
+ */
+struct ScoreMatrix
+{
+    std::array<float, MAX_POSSIBLE_RESULTS> probabilities;
+    int home_size;
+    int guest_size;
+
+    float at(int home_goals, int guest_goals) const
+    {
+        assert(home_goals < home_size && guest_goals < guest_size);
+        return probabilities[(size_t)(home_goals * guest_size + guest_goals)];
+    }
+};
+
+extern void FillScoreMatrix(ScoreMatrix& out, gsl::span<const float> home_distr,
+                            gsl::span<const float> guest_distr, float home_ev, float guest_ev,
+                            float correction = DEFAULT_POISSON_CORRECTION);
+
+/**
+ * The full score grid of the expected goals, from the untruncated poisson
+ * distributions of both teams.
+ */
+extern void FillScoreMatrix(ScoreMatrix& out, float home_ev, float guest_ev,
+                            float correction = DEFAULT_POISSON_CORRECTION);
+
+extern auto CalculateBestBet(const ScoreMatrix& scores, const BetSystemPoints& system_points)
+    -> KicktippBet;
+
+extern auto CalculateThreeWayBet(const ScoreMatrix& scores) -> ThreeWayBet;
+
+/**
+ * The kicktipp rules, everything that scores tips uses them: the exact
+ * result, else the correct difference, else the correct tendency. A draw with
+ * the wrong result only has the right tendency.
+ */
+enum eTipHit : char
+{
+    TIP_MISS = 0,
+    TIP_TENDENCY,
+    TIP_DIFFERENCE,
+    TIP_RESULT,
+};
+
+extern eTipHit CalculateTipHit(int tip_home_goals, int tip_guest_goals, int home_goals,
+                               int guest_goals);
+
+extern float CalculateTipPoints(eTipHit hit, const BetSystemPoints& system_points);
+
+/**
+ * Expected points of a tip with the probabilities of its outcomes.
+ */
+extern float CalculateTipEV(const TipOutcome& outcome, const BetSystemPoints& system_points);
+
+/**
+ * Probabilities of the outcomes of the tip home_goals:guest_goals, see
+ * CalculateTipHit(). The scores are scaled to sum up to one.
+ */
+extern auto CalculateTipOutcome(const ScoreMatrix& scores, int home_goals, int guest_goals)
+    -> TipOutcome;
+
 extern float CalculateBetEV(int home_goals, int guest_goals, gsl::span<const float> home_distr,
                             gsl::span<const float> guest_distr, float home_ev, float guest_ev,
                             const BetSystemPoints& system_points);
@@ -23,8 +87,38 @@ extern auto CalculateThreeWayBet(const GoalDistribution& home_distr,
                                  const GoalDistribution& guest_distr, float home_ev, float guest_ev)
     -> ThreeWayBet;
 
+extern float CalculatePoissonProbability(float lambda, int k);
+
 extern int FillPoissonDistribution(gsl::span<float> out, float lmbda, float thresh_hold = 0.0f);
 
+/**
+ * Drops the tail of a distribution as soon as the probability of all further
+ * goals, including those beyond the end of distr, is below epsilon, and scales
+ * the kept probabilities to sum up to one. Returns the number of kept goals,
+ * at least one. tail_out receives the dropped probability.
+ */
+extern int TruncateDistribution(gsl::span<float> distr, float epsilon, float& tail_out);
+
+/**
+ * Poisson distributions of all lambdas in [0, max_lambda] quantized to steps
+ * of 1 / resolution, computed once. Lambdas out of that range are computed on
+ * demand.
+ */
+class PoissonCache
+{
+public:
+    explicit PoissonCache(float max_lambda = 8.0f, int resolution = 1000);
+
+    /**
+     * Fills out with the distribution of the nearest quantized lambda.
+     */
+    void fill(GoalDistribution& out, float lambda) const;
+
+private:
+    float m_resolution;
+    std::vector<GoalDistribution> m_distributions;
+};
+
 extern float CalculateGoalEv(float attacker_goal_avg, float defender_against_avg,
                              float league_goal_avg);
 
@@ -0,0 +1,303 @@
+#include "columnar_stats_provider.h"
+#include <algorithm>
+#include <limits>
+
+template<typename SumT, typename DateT>
+void kwa::BasicColumnarStatsProvider<SumT, DateT>::clear()
+{
+    m_home = Columns{};
+    m_guest = Columns{};
+    m_league_sums.clear();
+    m_league_dates.clear();
+    m_date_base = 0;
+}
+
+template<typename SumT, typename DateT>
+bool kwa::BasicColumnarStatsProvider<SumT, DateT>::build(
+    gsl::span<const MatchData> matches, int goal_cap)
+{
+    clear();
+
+    size_t team_count = 0;
+    for (auto& m : matches) {
+        team_count = std::max(team_count, (size_t)m.home_team + 1);
+        team_count = std::max(team_count, (size_t)m.guest_team + 1);
+    }
+
+    // count matches per team, then turn the counts into offsets
+    m_home.offsets.assign(team_count + 1, 0);
+    m_guest.offsets.assign(team_count + 1, 0);
+    for (auto& m : matches) {
+        ++m_home.offsets[(size_t)m.home_team + 1];
+        ++m_guest.offsets[(size_t)m.guest_team + 1];
+    }
+    for (size_t t = 0; t < team_count; ++t) {
+        m_home.offsets[t + 1] += m_home.offsets[t];
+        m_guest.offsets[t + 1] += m_guest.offsets[t];
+    }
+
+    for (auto* columns : {&m_home, &m_guest}) {
+        columns->sums.resize(columns->offsets.back());
+        columns->dates.resize(columns->offsets.back());
+    }
+    m_league_sums.reserve((size_t)matches.size());
+    m_league_dates.reserve((size_t)matches.size());
+    if (matches.size() > 0) m_date_base = match_ordinal(matches[0].day);
+
+    std::vector<uint32_t> home_pos(m_home.offsets.begin(),
+                                   m_home.offsets.end() - 1);
+    std::vector<uint32_t> guest_pos(m_guest.offsets.begin(),
+                                    m_guest.offsets.end() - 1);
+
+    auto append = [this](Columns& columns, uint32_t first, uint32_t pos,
+                         int date, int goals, int against) {
+        const auto& prev = columns.sums[pos > first ? pos - 1 : pos];
+        int sum_goals = (pos > first ? (int)prev.goals : 0) + goals;
+        int sum_against = (pos > first ? (int)prev.against : 0) + against;
+        if (sum_goals > (int)std::numeric_limits<SumT>::max() ||
+            sum_against > (int)std::numeric_limits<SumT>::max())
+            return false;
+        columns.sums[pos] = {(SumT)sum_goals, (SumT)sum_against};
+        return encodeDate(date, columns.dates[pos]);
+    };
+
+    for (auto& m : matches) {
+        int home_goals =
+            goal_cap > 0 && m.home_goals > goal_cap ? goal_cap : m.home_goals;
+        int guest_goals =
+            goal_cap > 0 && m.guest_goals > goal_cap ? goal_cap : m.guest_goals;
+
+        auto home = (size_t)m.home_team;
+        auto guest = (size_t)m.guest_team;
+        if (!append(m_home, m_home.offsets[home], home_pos[home]++, m.day,
+                    home_goals, guest_goals) ||
+            !append(m_guest, m_guest.offsets[guest], guest_pos[guest]++,
+                    m.day, guest_goals, home_goals)) {
+            clear();
+            return false;
+        }
+
+        auto prev = m_league_sums.empty() ? GoalSums<int>{0, 0}
+                                          : m_league_sums.back();
+        m_league_sums.push_back(
+            {prev.goals + home_goals, prev.against + guest_goals});
+        m_league_dates.push_back(m.day);
+    }
+    return true;
+}
+
+template<typename SumT, typename DateT>
+size_t kwa::BasicColumnarStatsProvider<SumT, DateT>::memoryUsage() const
+{
+    size_t out = 0;
+    for (auto* columns : {&m_home, &m_guest}) {
+        out += columns->offsets.size() * sizeof(uint32_t);
+        out += columns->sums.size() * sizeof(GoalSums<SumT>);
+        out += columns->dates.size() * sizeof(DateT);
+    }
+    out += m_league_sums.size() * sizeof(GoalSums<int>);
+    out += m_league_dates.size() * sizeof(int);
+    return out;
+}
+
+template<typename SumT, typename DateT>
+bool kwa::BasicColumnarStatsProvider<SumT, DateT>::encodeDate(
+    int date, DateT& out) const
+{
+    if (stores_match_dates) {
+        out = (DateT)date;
+        return true;
+    }
+    int value = match_ordinal(date) - m_date_base;
+    if (value < 0 || value > (int)std::numeric_limits<DateT>::max())
+        return false;
+    out = (DateT)value;
+    return true;
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::queryDate(int date) const
+{
+    return stores_match_dates ? date : match_ordinal(date) - m_date_base;
+}
+
+template<typename SumT, typename DateT>
+bool kwa::BasicColumnarStatsProvider<SumT, DateT>::hasStats(
+    const Columns& columns, TeamId team, int max_date) const
+{
+    if (team < 0 || (size_t)team >= teamCount()) return false;
+    auto first = columns.dates.begin() + columns.offsets[(size_t)team];
+    auto last = columns.dates.begin() + columns.offsets[(size_t)team + 1];
+    if (max_date < 0) return first != last;
+    return std::lower_bound(first, last, queryDate(max_date)) != first;
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getStats(
+    const Columns& columns, TeamId team, int before_date, size_t num_matches,
+    TeamStats::eLocation location, TeamStats& out) const
+{
+    assert((size_t)team < teamCount());
+    const size_t first = columns.offsets[(size_t)team];
+    size_t end = columns.offsets[(size_t)team + 1];
+    if (before_date >= 0) {
+        auto dates_first = columns.dates.begin() + (std::ptrdiff_t)first;
+        auto dates_end = columns.dates.begin() + (std::ptrdiff_t)end;
+        end = first + (size_t)std::distance(
+                          dates_first, std::lower_bound(dates_first, dates_end,
+                                                        queryDate(before_date)));
+    }
+
+    const size_t available = end - first;
+    if (available < 1) return -1;
+
+    const size_t count = std::min(num_matches, available);
+    const auto& last_sums = columns.sums[end - 1];
+    int sum_goals = last_sums.goals;
+    int sum_against = last_sums.against;
+    if (count < available) {
+        sum_goals -= columns.sums[end - 1 - count].goals;
+        sum_against -= columns.sums[end - 1 - count].against;
+    }
+
+    out.goal_avg[location] = (float)sum_goals / (float)count;
+    out.against_avg[location] = (float)sum_against / (float)count;
+    out.match_count[location] = (float)count;
+
+    return (int)count;
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getLeagueStats(
+    size_t end, size_t num_matches, LeagueStats& out) const
+{
+    if (end < 1) return -1;
+
+    const size_t count = std::min(num_matches, end);
+    int sum_goals = m_league_sums[end - 1].goals;
+    int sum_against = m_league_sums[end - 1].against;
+    if (count < end) {
+        sum_goals -= m_league_sums[end - 1 - count].goals;
+        sum_against -= m_league_sums[end - 1 - count].against;
+    }
+
+    out.goal_avg[LeagueStats::HOME] = (float)sum_goals / (float)count;
+    out.goal_avg[LeagueStats::AWAY] = (float)sum_against / (float)count;
+    out.goal_avg[LeagueStats::TOTAL] = 0.5f * (out.goal_avg[LeagueStats::HOME] +
+                                               out.goal_avg[LeagueStats::AWAY]);
+    out.match_count = (float)count;
+
+    return (int)count;
+}
+
+template<typename SumT, typename DateT>
+bool kwa::BasicColumnarStatsProvider<SumT, DateT>::hasHomeStats(
+    TeamId team, int max_date) const
+{
+    return hasStats(m_home, team, max_date);
+}
+
+template<typename SumT, typename DateT>
+bool kwa::BasicColumnarStatsProvider<SumT, DateT>::hasGuestStats(
+    TeamId team, int max_date) const
+{
+    return hasStats(m_guest, team, max_date);
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getHomeStats(
+    TeamId team, TeamStats& out) const
+{
+    return getStats(m_home, team, -1, std::numeric_limits<size_t>::max(),
+                    TeamStats::HOME, out);
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getGuestStats(
+    TeamId team, TeamStats& out) const
+{
+    return getStats(m_guest, team, -1, std::numeric_limits<size_t>::max(),
+                    TeamStats::AWAY, out);
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getHomeStats(
+    TeamId team, size_t num_matches, TeamStats& out) const
+{
+    return getStats(m_home, team, -1, num_matches, TeamStats::HOME, out);
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getGuestStats(
+    TeamId team, size_t num_matches, TeamStats& out) const
+{
+    return getStats(m_guest, team, -1, num_matches, TeamStats::AWAY, out);
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getHomeStatsBefore(
+    TeamId team, int before_date, TeamStats& out) const
+{
+    return getStats(m_home, team, before_date,
+                    std::numeric_limits<size_t>::max(), TeamStats::HOME, out);
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getGuestStatsBefore(
+    TeamId team, int before_date, TeamStats& out) const
+{
+    return getStats(m_guest, team, before_date,
+                    std::numeric_limits<size_t>::max(), TeamStats::AWAY, out);
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getHomeStatsBefore(
+    TeamId team, int before_date, size_t num_matches, TeamStats& out) const
+{
+    return getStats(m_home, team, before_date, num_matches, TeamStats::HOME,
+                    out);
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getGuestStatsBefore(
+    TeamId team, int before_date, size_t num_matches, TeamStats& out) const
+{
+    return getStats(m_guest, team, before_date, num_matches, TeamStats::AWAY,
+                    out);
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getLeagueStats(
+    LeagueStats& out) const
+{
+    return getLeagueStats(m_league_dates.size(),
+                          std::numeric_limits<size_t>::max(), out);
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getLeagueStats(
+    size_t num_matches, LeagueStats& out) const
+{
+    return getLeagueStats(m_league_dates.size(), num_matches, out);
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getLeagueStatsBefore(
+    int before_date, LeagueStats& out) const
+{
+    return getLeagueStatsBefore(before_date,
+                                std::numeric_limits<size_t>::max(), out);
+}
+
+template<typename SumT, typename DateT>
+int kwa::BasicColumnarStatsProvider<SumT, DateT>::getLeagueStatsBefore(
+    int before_date, size_t num_matches, LeagueStats& out) const
+{
+    auto it = std::lower_bound(m_league_dates.begin(), m_league_dates.end(),
+                               before_date);
+    return getLeagueStats((size_t)std::distance(m_league_dates.begin(), it),
+                          num_matches, out);
+}
+
+template class kwa::BasicColumnarStatsProvider<int, int>;
+template class kwa::BasicColumnarStatsProvider<uint16_t, uint16_t>;
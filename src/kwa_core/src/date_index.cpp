@@ -0,0 +1,57 @@
+#include "date_index.h"
+#include <algorithm>
+
+void kwa::DateIndex::clear()
+{
+    m_enabled = true;
+    m_first_day = 0;
+    m_positions.clear();
+}
+
+void kwa::DateIndex::append(int date, size_t position)
+{
+    if (!m_enabled) return;
+    if (!is_valid_match_date(date)) {
+        m_enabled = false;
+        m_positions.clear();
+        return;
+    }
+
+    const DayOrdinal day = match_ordinal(date);
+    if (m_positions.empty()) m_first_day = day;
+    assert(day >= m_first_day);
+
+    // every bucket starting after the previous date and not after this one
+    // begins with this date
+    const size_t bucket = (size_t)((day - m_first_day) >> m_bucket_shift);
+    while (m_positions.size() <= bucket)
+        m_positions.push_back((uint32_t)position);
+}
+
+void kwa::DateIndex::rebuild(gsl::span<const int> dates)
+{
+    clear();
+    for (std::ptrdiff_t i = 0; i < dates.size(); ++i)
+        append(dates[i], (size_t)i);
+}
+
+size_t kwa::DateIndex::lowerBound(const std::vector<int>& dates,
+                                  int before_date) const
+{
+    if (!m_enabled || !is_valid_match_date(before_date)) {
+        return (size_t)std::distance(
+            dates.begin(),
+            std::lower_bound(dates.begin(), dates.end(), before_date));
+    }
+
+    const DayOrdinal day = match_ordinal(before_date);
+    if (m_positions.empty() || day <= m_first_day) return 0;
+
+    const size_t bucket = (size_t)((day - m_first_day) >> m_bucket_shift);
+    // all indexed dates are in buckets before m_positions.size()
+    if (bucket >= m_positions.size()) return dates.size();
+
+    size_t pos = m_positions[bucket];
+    while (pos < dates.size() && dates[pos] < before_date) ++pos;
+    return pos;
+}
@@ -0,0 +1,301 @@
+#include "dynamic_stats_provider.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+constexpr const int INITIAL_DAY_RANGE = 512;
+
+int lowBit(int i)
+{
+    return i & -i;
+}
+} // namespace
+
+void kwa::DynamicStatsProvider::DayTree::add(int ordinal, const Sums& delta)
+{
+    cover(ordinal);
+    const int size = (int)tree.size();
+    for (int i = ordinal - base + 1; i <= size; i += lowBit(i)) {
+        auto& node = tree[(size_t)i - 1];
+        node.goals += delta.goals;
+        node.against += delta.against;
+        node.count += delta.count;
+    }
+}
+
+auto kwa::DynamicStatsProvider::DayTree::prefixAt(int index) const -> Sums
+{
+    Sums out{0, 0, 0};
+    for (int i = index; i > 0; i -= lowBit(i)) {
+        auto& node = tree[(size_t)i - 1];
+        out.goals += node.goals;
+        out.against += node.against;
+        out.count += node.count;
+    }
+    return out;
+}
+
+auto kwa::DynamicStatsProvider::DayTree::prefix(int ordinal) const -> Sums
+{
+    return prefixAt(indexOf(ordinal));
+}
+
+int kwa::DynamicStatsProvider::DayTree::indexOf(int ordinal) const
+{
+    const int size = (int)tree.size();
+    if (ordinal <= base) return 0;
+    return ordinal - base >= size ? size : ordinal - base;
+}
+
+int kwa::DynamicStatsProvider::DayTree::firstIndexReaching(int count) const
+{
+    if (count <= 0) return 0;
+
+    const int size = (int)tree.size();
+    int step = 1;
+    while (step * 2 <= size) step *= 2;
+
+    int pos = 0;
+    for (; step > 0; step /= 2) {
+        if (pos + step <= size && tree[(size_t)(pos + step) - 1].count < count) {
+            pos += step;
+            count -= tree[(size_t)pos - 1].count;
+        }
+    }
+    return pos + 1;
+}
+
+void kwa::DynamicStatsProvider::DayTree::cover(int ordinal)
+{
+    if (tree.empty()) {
+        base = ordinal - INITIAL_DAY_RANGE / 2;
+        tree.assign(INITIAL_DAY_RANGE, Sums{0, 0, 0});
+        return;
+    }
+
+    const int low = base;
+    const int high = base + (int)tree.size();
+    if (ordinal >= low && ordinal < high) return;
+
+    // grow at least by factor two to keep rebuilds amortized
+    int new_low = low;
+    int new_high = high;
+    if (ordinal < low)
+        new_low = std::min(ordinal, high - 2 * (high - low));
+    else
+        new_high = std::max(ordinal + 1, low + 2 * (high - low));
+
+    // recover the per day values, then build the larger tree in O(n)
+    const int size = (int)tree.size();
+    for (int i = size; i > 0; --i) {
+        const int parent = i + lowBit(i);
+        if (parent > size) continue;
+        auto& node = tree[(size_t)parent - 1];
+        node.goals -= tree[(size_t)i - 1].goals;
+        node.against -= tree[(size_t)i - 1].against;
+        node.count -= tree[(size_t)i - 1].count;
+    }
+
+    std::vector<Sums> grown((size_t)(new_high - new_low), Sums{0, 0, 0});
+    std::copy(tree.begin(), tree.end(), grown.begin() + (low - new_low));
+
+    const int new_size = (int)grown.size();
+    for (int i = 1; i <= new_size; ++i) {
+        const int parent = i + lowBit(i);
+        if (parent > new_size) continue;
+        auto& node = grown[(size_t)parent - 1];
+        node.goals += grown[(size_t)i - 1].goals;
+        node.against += grown[(size_t)i - 1].against;
+        node.count += grown[(size_t)i - 1].count;
+    }
+
+    base = new_low;
+    tree = std::move(grown);
+}
+
+void kwa::DynamicStatsProvider::clear()
+{
+    m_team_data.clear();
+    m_overall_stats = DayTree{};
+    m_match_count = 0;
+}
+
+void kwa::DynamicStatsProvider::addMatch(const MatchData& match)
+{
+    auto max_id = std::max(match.home_team, match.guest_team);
+    if ((size_t)max_id >= m_team_data.size())
+        m_team_data.resize((size_t)max_id + 1);
+
+    applyMatch(match, 1);
+    ++m_match_count;
+}
+
+void kwa::DynamicStatsProvider::addMatches(gsl::span<const MatchData> matches)
+{
+    for (auto& m : matches) addMatch(m);
+}
+
+void kwa::DynamicStatsProvider::removeMatch(const MatchData& match)
+{
+    assert(m_match_count > 0);
+    assert((size_t)match.home_team < m_team_data.size());
+    assert((size_t)match.guest_team < m_team_data.size());
+
+    applyMatch(match, -1);
+    --m_match_count;
+}
+
+void kwa::DynamicStatsProvider::updateMatch(const MatchData& old_match,
+                                            const MatchData& new_match)
+{
+    removeMatch(old_match);
+    addMatch(new_match);
+}
+
+void kwa::DynamicStatsProvider::applyMatch(const MatchData& m, int sign)
+{
+    int home_goals =
+        m_goal_cap > 0 && m.home_goals > m_goal_cap ? m_goal_cap : m.home_goals;
+    int guest_goals = m_goal_cap > 0 && m.guest_goals > m_goal_cap
+                          ? m_goal_cap
+                          : m.guest_goals;
+    const int ordinal = match_ordinal(m.day);
+
+    m_team_data[(size_t)m.home_team].home.add(
+        ordinal, {sign * home_goals, sign * guest_goals, sign});
+    m_team_data[(size_t)m.guest_team].guest.add(
+        ordinal, {sign * guest_goals, sign * home_goals, sign});
+    m_overall_stats.add(ordinal,
+                        {sign * home_goals, sign * guest_goals, sign});
+}
+
+auto kwa::DynamicStatsProvider::findTeamData(TeamId team) const
+    -> const PerTeamData*
+{
+    if (team < 0 || (size_t)team >= m_team_data.size()) return nullptr;
+    return &m_team_data[(size_t)team];
+}
+
+bool kwa::DynamicStatsProvider::hasHomeStats(TeamId team, int max_date) const
+{
+    auto team_data = findTeamData(team);
+    if (team_data == nullptr) return false;
+    auto& tree = team_data->home;
+    if (max_date < 0) return tree.prefixAt((int)tree.tree.size()).count > 0;
+    return tree.prefix(match_ordinal(max_date)).count > 0;
+}
+
+bool kwa::DynamicStatsProvider::hasGuestStats(TeamId team, int max_date) const
+{
+    auto team_data = findTeamData(team);
+    if (team_data == nullptr) return false;
+    auto& tree = team_data->guest;
+    if (max_date < 0) return tree.prefixAt((int)tree.tree.size()).count > 0;
+    return tree.prefix(match_ordinal(max_date)).count > 0;
+}
+
+int kwa::DynamicStatsProvider::getStatsBefore(const DayTree& tree,
+                                              int before_date,
+                                              size_t num_matches,
+                                              TeamStats::eLocation location,
+                                              TeamStats& out)
+{
+    const int end_index = before_date < 0
+                              ? (int)tree.tree.size()
+                              : tree.indexOf(match_ordinal(before_date));
+    const Sums end = tree.prefixAt(end_index);
+    Sums begin{0, 0, 0};
+    if (num_matches < (size_t)end.count)
+        begin = tree.prefixAt(
+            tree.firstIndexReaching(end.count - (int)num_matches));
+
+    const int count = end.count - begin.count;
+    if (count < 1) return -1;
+
+    out.goal_avg[location] = (float)(end.goals - begin.goals) / (float)count;
+    out.against_avg[location] =
+        (float)(end.against - begin.against) / (float)count;
+    out.match_count[location] = (float)count;
+
+    return count;
+}
+
+int kwa::DynamicStatsProvider::getHomeStats(TeamId team, TeamStats& out) const
+{
+    assert(findTeamData(team) != nullptr);
+    int count = getStatsBefore(findTeamData(team)->home, -1,
+                               std::numeric_limits<size_t>::max(),
+                               TeamStats::HOME, out);
+    assert(count > 0);
+    return count;
+}
+
+int kwa::DynamicStatsProvider::getGuestStats(TeamId team, TeamStats& out) const
+{
+    assert(findTeamData(team) != nullptr);
+    int count = getStatsBefore(findTeamData(team)->guest, -1,
+                               std::numeric_limits<size_t>::max(),
+                               TeamStats::AWAY, out);
+    assert(count > 0);
+    return count;
+}
+
+int kwa::DynamicStatsProvider::getHomeStatsBefore(TeamId team, int before_date,
+                                                  TeamStats& out) const
+{
+    return getHomeStatsBefore(team, before_date,
+                              std::numeric_limits<size_t>::max(), out);
+}
+
+int kwa::DynamicStatsProvider::getGuestStatsBefore(TeamId team,
+                                                   int before_date,
+                                                   TeamStats& out) const
+{
+    return getGuestStatsBefore(team, before_date,
+                               std::numeric_limits<size_t>::max(), out);
+}
+
+int kwa::DynamicStatsProvider::getHomeStatsBefore(TeamId team, int before_date,
+                                                  size_t num_matches,
+                                                  TeamStats& out) const
+{
+    assert(findTeamData(team) != nullptr);
+    assert(before_date >= 0);
+    return getStatsBefore(findTeamData(team)->home, before_date, num_matches,
+                          TeamStats::HOME, out);
+}
+
+int kwa::DynamicStatsProvider::getGuestStatsBefore(TeamId team,
+                                                   int before_date,
+                                                   size_t num_matches,
+                                                   TeamStats& out) const
+{
+    assert(findTeamData(team) != nullptr);
+    assert(before_date >= 0);
+    return getStatsBefore(findTeamData(team)->guest, before_date, num_matches,
+                          TeamStats::AWAY, out);
+}
+
+int kwa::DynamicStatsProvider::getLeagueStats(LeagueStats& out) const
+{
+    assert(m_match_count > 0);
+    return getLeagueStatsBefore(-1, out);
+}
+
+int kwa::DynamicStatsProvider::getLeagueStatsBefore(int before_date,
+                                                    LeagueStats& out) const
+{
+    auto& tree = m_overall_stats;
+    const Sums sums = tree.prefixAt(
+        before_date < 0 ? (int)tree.tree.size()
+                        : tree.indexOf(match_ordinal(before_date)));
+    if (sums.count < 1) return -1;
+
+    out.goal_avg[LeagueStats::HOME] = (float)sums.goals / (float)sums.count;
+    out.goal_avg[LeagueStats::AWAY] = (float)sums.against / (float)sums.count;
+    out.goal_avg[LeagueStats::TOTAL] = 0.5f * (out.goal_avg[LeagueStats::HOME] +
+                                               out.goal_avg[LeagueStats::AWAY]);
+    out.match_count = (float)sums.count;
+
+    return sums.count;
+}
@@ -0,0 +1,125 @@
+#include "estimation_cache.h"
+#include <algorithm>
+
+namespace {
+size_t hashKey(const kwa::EstimationCache::Key& key)
+{
+    uint64_t hash = (uint64_t)(uint32_t)key.home_team << 32 |
+                    (uint32_t)key.guest_team;
+    hash ^= ((uint64_t)(uint32_t)key.min_date << 32 |
+             (uint32_t)key.max_date) *
+            0x9e3779b97f4a7c15ull;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 32;
+    return (size_t)hash;
+}
+
+bool operator==(const kwa::EstimationCache::Key& lhs,
+                const kwa::EstimationCache::Key& rhs)
+{
+    return lhs.home_team == rhs.home_team &&
+           lhs.guest_team == rhs.guest_team &&
+           lhs.min_date == rhs.min_date && lhs.max_date == rhs.max_date;
+}
+} // namespace
+
+constexpr const uint32_t kwa::EstimationCache::NO_ENTRY;
+
+kwa::EstimationCache::EstimationCache(size_t capacity) : m_capacity(capacity)
+{
+    assert(capacity > 0 && capacity < NO_ENTRY / 2);
+    size_t slot_count = 2;
+    while (slot_count < 2 * capacity) slot_count *= 2;
+    m_slots.assign(slot_count, NO_ENTRY);
+    m_entries.reserve(capacity);
+}
+
+void kwa::EstimationCache::clear()
+{
+    m_entries.clear();
+    std::fill(m_slots.begin(), m_slots.end(), NO_ENTRY);
+    m_most_recent = NO_ENTRY;
+    m_least_recent = NO_ENTRY;
+}
+
+const kwa::MatchEstimation* kwa::EstimationCache::find(const Key& key)
+{
+    const uint32_t index = m_slots[findSlot(key)];
+    if (index == NO_ENTRY) return nullptr;
+    if (index != m_most_recent) {
+        unlink(index);
+        pushFront(index);
+    }
+    return &m_entries[index].estimation;
+}
+
+void kwa::EstimationCache::insert(const Key& key,
+                                  const MatchEstimation& estimation)
+{
+    uint32_t index;
+    if (m_entries.size() < m_capacity) {
+        index = (uint32_t)m_entries.size();
+        m_entries.push_back(Entry{key, estimation, NO_ENTRY, NO_ENTRY});
+    } else {
+        index = m_least_recent;
+        eraseSlot(findSlot(m_entries[index].key));
+        unlink(index);
+        m_entries[index].key = key;
+        m_entries[index].estimation = estimation;
+    }
+
+    const size_t slot = findSlot(key);
+    assert(m_slots[slot] == NO_ENTRY);
+    m_slots[slot] = index;
+    pushFront(index);
+}
+
+size_t kwa::EstimationCache::findSlot(const Key& key) const
+{
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = hashKey(key) & mask;; i = (i + 1) & mask) {
+        const uint32_t index = m_slots[i];
+        if (index == NO_ENTRY || m_entries[index].key == key) return i;
+    }
+}
+
+void kwa::EstimationCache::eraseSlot(size_t slot)
+{
+    // backward shift deletion: move following entries of the probe sequence
+    // into the hole unless that moves them before their ideal slot
+    const size_t mask = m_slots.size() - 1;
+    size_t hole = slot;
+    for (size_t i = (hole + 1) & mask; m_slots[i] != NO_ENTRY;
+         i = (i + 1) & mask) {
+        const size_t ideal = hashKey(m_entries[m_slots[i]].key) & mask;
+        if (((i - ideal) & mask) >= ((i - hole) & mask)) {
+            m_slots[hole] = m_slots[i];
+            hole = i;
+        }
+    }
+    m_slots[hole] = NO_ENTRY;
+}
+
+void kwa::EstimationCache::unlink(uint32_t index)
+{
+    Entry& entry = m_entries[index];
+    if (entry.prev != NO_ENTRY)
+        m_entries[entry.prev].next = entry.next;
+    else
+        m_most_recent = entry.next;
+    if (entry.next != NO_ENTRY)
+        m_entries[entry.next].prev = entry.prev;
+    else
+        m_least_recent = entry.prev;
+    entry.prev = entry.next = NO_ENTRY;
+}
+
+void kwa::EstimationCache::pushFront(uint32_t index)
+{
+    Entry& entry = m_entries[index];
+    entry.prev = NO_ENTRY;
+    entry.next = m_most_recent;
+    if (m_most_recent != NO_ENTRY) m_entries[m_most_recent].prev = index;
+    m_most_recent = index;
+    if (m_least_recent == NO_ENTRY) m_least_recent = index;
+}
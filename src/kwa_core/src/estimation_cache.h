@@ -0,0 +1,67 @@
+#pragma once
+
+#include "match_estimator.h"
+#include <cstdint>
+#include <vector>
+
+namespace kwa {
+/**
+ * Bounded LRU cache of estimations. The entries are kept in a flat array
+ * linked in order of use, an open addressing hash table with linear probing
+ * maps keys to entries. The cache does not know about the estimator, the key
+ * has to cover everything the estimation depends on.
+ */
+class EstimationCache
+{
+public:
+    struct Key
+    {
+        TeamId home_team;
+        TeamId guest_team;
+        int min_date;
+        int max_date;
+    };
+
+    explicit EstimationCache(size_t capacity);
+
+    size_t capacity() const { return m_capacity; }
+    size_t size() const { return m_entries.size(); }
+
+    void clear();
+
+    /**
+     * Returns the cached estimation of key and marks it as most recently
+     * used, nullptr if key is not cached.
+     */
+    const MatchEstimation* find(const Key& key);
+
+    /**
+     * Adds an estimation, evicts the least recently used one if the cache is
+     * full. key MUST NOT be cached yet.
+     */
+    void insert(const Key& key, const MatchEstimation& estimation);
+
+private:
+    static constexpr const uint32_t NO_ENTRY = UINT32_MAX;
+
+    struct Entry
+    {
+        Key key;
+        MatchEstimation estimation;
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    size_t m_capacity;
+    std::vector<Entry> m_entries;
+    /// entry indices, NO_ENTRY for empty slots, a power of two >= 2 * capacity
+    std::vector<uint32_t> m_slots;
+    uint32_t m_most_recent = NO_ENTRY;
+    uint32_t m_least_recent = NO_ENTRY;
+
+    size_t findSlot(const Key& key) const;
+    void eraseSlot(size_t slot);
+    void unlink(uint32_t index);
+    void pushFront(uint32_t index);
+};
+} // namespace kwa
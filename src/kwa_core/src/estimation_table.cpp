@@ -0,0 +1,153 @@
+#include "estimation_table.h"
+#include "batch_estimation.h"
+#include "calculations.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <numeric>
+
+namespace {
+float lerp(float a, float b, float t) { return a + (b - a) * t; }
+} // namespace
+
+kwa::EstimationTable::EstimationTable(const BetSystemPoints& system_points,
+                                      float max_lambda, int resolution)
+    : m_system_points(system_points), m_max_lambda(max_lambda),
+      m_resolution((float)resolution),
+      m_size((int)std::ceil(max_lambda * (float)resolution) + 1)
+{
+    assert(max_lambda > 0.0f && resolution > 0);
+    // the last node may be beyond max_lambda, the grid covers all of it
+    const size_t count = (size_t)(m_size * m_size);
+    std::vector<float> home_evs(count), guest_evs(count);
+    for (int i = 0; i < m_size; ++i) {
+        for (int j = 0; j < m_size; ++j) {
+            home_evs[(size_t)(i * m_size + j)] = (float)i / m_resolution;
+            guest_evs[(size_t)(i * m_size + j)] = (float)j / m_resolution;
+        }
+    }
+
+    MatchEstimationBatch batch;
+    EstimateBatch(home_evs, guest_evs, m_system_points, batch);
+    m_entries.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto& entry = m_entries[i];
+        entry.three_way = {{batch.home_win[i], batch.draw[i], batch.guest_win[i]}};
+        entry.best_bet_ev = batch.best_result_bet_ev[i];
+        entry.best_home_goals = batch.best_result_bet_home_goals[i];
+        entry.best_guest_goals = batch.best_result_bet_guest_goals[i];
+    }
+
+    m_tails.resize((size_t)m_size);
+    for (int i = 0; i < m_size; ++i) {
+        GoalDistribution distr;
+        FillPoissonDistribution(distr, (float)i / m_resolution);
+        m_tails[(size_t)i] =
+            std::max(0.0f, 1.0f - std::accumulate(distr.begin(), distr.end(), 0.0f));
+    }
+    for (int i = 0; i < m_size; ++i) {
+        for (int j = 0; j < m_size; ++j) {
+            m_entries[(size_t)(i * m_size + j)].truncation_error =
+                1.0f - (1.0f - m_tails[(size_t)i]) * (1.0f - m_tails[(size_t)j]);
+        }
+    }
+}
+
+std::shared_ptr<const kwa::EstimationTable>
+kwa::EstimationTable::shared(const BetSystemPoints& system_points)
+{
+    static std::mutex mutex;
+    static std::vector<std::shared_ptr<const EstimationTable>> tables;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& table : tables) {
+        auto& points = table->systemPoints();
+        if (points.result == system_points.result &&
+            points.difference == system_points.difference &&
+            points.tendency == system_points.tendency)
+            return table;
+    }
+    tables.push_back(std::make_shared<const EstimationTable>(system_points));
+    return tables.back();
+}
+
+void kwa::EstimationTable::lookupNearest(float home_ev, float guest_ev,
+                                         Entry& out) const
+{
+    assert(contains(home_ev, guest_ev));
+    out = entry((int)(home_ev * m_resolution + 0.5f),
+                (int)(guest_ev * m_resolution + 0.5f));
+}
+
+void kwa::EstimationTable::lookupInterpolated(float home_ev, float guest_ev,
+                                              Entry& out) const
+{
+    assert(contains(home_ev, guest_ev));
+    const float x = home_ev * m_resolution;
+    const float y = guest_ev * m_resolution;
+    const int i = std::min((int)x, m_size - 2);
+    const int j = std::min((int)y, m_size - 2);
+    const float tx = x - (float)i;
+    const float ty = y - (float)j;
+
+    const Entry& e00 = entry(i, j);
+    const Entry& e01 = entry(i, j + 1);
+    const Entry& e10 = entry(i + 1, j);
+    const Entry& e11 = entry(i + 1, j + 1);
+    auto bilinear = [tx, ty](float v00, float v01, float v10, float v11) {
+        return lerp(lerp(v00, v01, ty), lerp(v10, v11, ty), tx);
+    };
+
+    for (size_t k = 0; k < out.three_way.size(); ++k) {
+        out.three_way[k] = bilinear(e00.three_way[k], e01.three_way[k],
+                                    e10.three_way[k], e11.three_way[k]);
+    }
+    out.best_bet_ev = bilinear(e00.best_bet_ev, e01.best_bet_ev,
+                               e10.best_bet_ev, e11.best_bet_ev);
+    out.truncation_error =
+        bilinear(e00.truncation_error, e01.truncation_error,
+                 e10.truncation_error, e11.truncation_error);
+
+    const Entry& nearest = entry(tx < 0.5f ? i : i + 1, ty < 0.5f ? j : j + 1);
+    out.best_home_goals = nearest.best_home_goals;
+    out.best_guest_goals = nearest.best_guest_goals;
+}
+
+kwa::EstimationError kwa::EstimationTable::measureError(bool interpolated) const
+{
+    EstimationError out{};
+    for (int i = 0; i + 1 < m_size; ++i) {
+        for (int j = 0; j + 1 < m_size; ++j) {
+            const float home_ev = ((float)i + 0.5f) / m_resolution;
+            const float guest_ev = ((float)j + 0.5f) / m_resolution;
+            if (!contains(home_ev, guest_ev)) continue;
+
+            GoalDistribution home_distr, guest_distr;
+            FillPoissonDistribution(home_distr, home_ev);
+            FillPoissonDistribution(guest_distr, guest_ev);
+            ScoreMatrix scores;
+            FillScoreMatrix(scores, home_distr, guest_distr, home_ev, guest_ev);
+            const auto three_way = CalculateThreeWayBet(scores);
+            const auto best_bet = CalculateBestBet(scores, m_system_points);
+
+            Entry approx;
+            if (interpolated)
+                lookupInterpolated(home_ev, guest_ev, approx);
+            else
+                lookupNearest(home_ev, guest_ev, approx);
+
+            for (size_t k = 0; k < three_way.size(); ++k) {
+                out.three_way = std::max(
+                    out.three_way, std::abs(three_way[k] - approx.three_way[k]));
+            }
+            out.best_bet_ev = std::max(
+                out.best_bet_ev, std::abs(best_bet.ev - approx.best_bet_ev));
+            const float approx_bet_ev = CalculateBetEV(
+                approx.best_home_goals, approx.best_guest_goals, home_distr,
+                guest_distr, home_ev, guest_ev, m_system_points);
+            out.best_bet_loss =
+                std::max(out.best_bet_loss, best_bet.ev - approx_bet_ev);
+        }
+    }
+    return out;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "kwa_common.h"
+#include <memory>
+#include <vector>
+
+namespace kwa {
+/**
+ * Estimations of all pairs of expected goals in [0, max_lambda] on a grid with
+ * steps of 1 / resolution, built once via EstimateBatch(). Lookups read the
+ * nearest grid node or interpolate bilinearly between the four surrounding
+ * nodes. The best result bet is always the one of the nearest node.
+ */
+class EstimationTable
+{
+public:
+    struct Entry
+    {
+        ThreeWayBet three_way;
+        float best_bet_ev;
+        int best_home_goals;
+        int best_guest_goals;
+        /// Probability of more than MAX_GOALS goals of either team.
+        float truncation_error;
+    };
+
+    explicit EstimationTable(const BetSystemPoints& system_points, float max_lambda = 6.0f,
+                             int resolution = 20);
+
+    /**
+     * Returns a table with the default grid for the system points. Tables
+     * are built once per system points and shared, thread safe.
+     */
+    static std::shared_ptr<const EstimationTable> shared(const BetSystemPoints& system_points);
+
+    const BetSystemPoints& systemPoints() const { return m_system_points; }
+
+    /**
+     * Checks if both expected goals are covered by the grid.
+     */
+    bool contains(float home_ev, float guest_ev) const
+    {
+        return home_ev >= 0.0f && home_ev <= m_max_lambda && guest_ev >= 0.0f &&
+               guest_ev <= m_max_lambda;
+    }
+
+    /**
+     * Looks up the estimation of the nearest grid node. The expected goals
+     * MUST be contained, see contains().
+     */
+    void lookupNearest(float home_ev, float guest_ev, Entry& out) const;
+
+    /**
+     * Interpolates the estimation between the surrounding grid nodes. The
+     * expected goals MUST be contained, see contains().
+     */
+    void lookupInterpolated(float home_ev, float guest_ev, Entry& out) const;
+
+    /**
+     * Compares lookups at the centers of all grid cells, where they are the
+     * least accurate, with the exact estimations. Expensive.
+     */
+    EstimationError measureError(bool interpolated) const;
+
+private:
+    BetSystemPoints m_system_points;
+    float m_max_lambda;
+    float m_resolution;
+    int m_size;
+    /// m_size * m_size entries, home_ev major
+    std::vector<Entry> m_entries;
+    /// probability of more than MAX_GOALS goals per grid node
+    std::vector<float> m_tails;
+
+    const Entry& entry(int home_node, int guest_node) const
+    {
+        return m_entries[(size_t)(home_node * m_size + guest_node)];
+    }
+};
+} // namespace kwa
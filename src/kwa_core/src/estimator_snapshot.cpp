@@ -0,0 +1,73 @@
+#include "estimator_snapshot.h"
+
+kwa::EstimatorSnapshot::EstimatorSnapshot(const MatchEstimator& estimator)
+    : m_estimator(estimator), m_match_count(estimator.matchCount())
+{
+    m_estimator.useEstimationCache(0);
+    m_estimator.recalculateTeamStatistics();
+    // queries only need the statistics
+    std::vector<MatchData>().swap(m_estimator.m_matches);
+    std::vector<TeamId>().swap(m_estimator.m_changed_teams);
+    m_estimator.m_prediction_matrix = PredictionMatrix();
+}
+
+bool kwa::EstimatorSnapshot::hasHomeStatistics(const char* team_name) const
+{
+    return m_estimator.hasHomeStatistics(team_name);
+}
+
+bool kwa::EstimatorSnapshot::hasGuestStatistics(const char* team_name) const
+{
+    return m_estimator.hasGuestStatistics(team_name);
+}
+
+void kwa::EstimatorSnapshot::estimate(MatchEstimation& out,
+                                      const char* home_team,
+                                      const char* guest_team) const
+{
+    estimate(out, teamRegister().getId(home_team),
+             teamRegister().getId(guest_team));
+}
+
+void kwa::EstimatorSnapshot::estimate(MatchEstimation& out, TeamId home_team,
+                                      TeamId guest_team) const
+{
+    m_estimator.estimateCurrent(out, home_team, guest_team,
+                                m_estimator.queryContext());
+}
+
+void kwa::EstimatorSnapshot::estimateMany(
+    gsl::span<const std::pair<TeamId, TeamId>> matches,
+    MatchEstimationBatch& out) const
+{
+    m_estimator.estimateManyCurrent(matches, m_estimator.queryContext(),
+                                    out);
+}
+
+bool kwa::EstimatorSnapshot::hasHomeStatistics(
+    const char* team_name, const QueryContext& context) const
+{
+    return m_estimator.hasHomeStatistics(team_name, context);
+}
+
+bool kwa::EstimatorSnapshot::hasGuestStatistics(
+    const char* team_name, const QueryContext& context) const
+{
+    return m_estimator.hasGuestStatistics(team_name, context);
+}
+
+void kwa::EstimatorSnapshot::estimate(MatchEstimation& out,
+                                      const char* home_team,
+                                      const char* guest_team,
+                                      const QueryContext& context) const
+{
+    estimate(out, teamRegister().getId(home_team),
+             teamRegister().getId(guest_team), context);
+}
+
+void kwa::EstimatorSnapshot::estimate(MatchEstimation& out, TeamId home_team,
+                                      TeamId guest_team,
+                                      const QueryContext& context) const
+{
+    m_estimator.estimateCurrent(out, home_team, guest_team, context);
+}
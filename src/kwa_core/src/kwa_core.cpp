@@ -1,5 +1,10 @@
 #include "kwa_core.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <sstream>
 
 bool kwa::loadMatchesFromCSVFile(MatchEstimator& estimator,
@@ -54,11 +59,188 @@ bool kwa::loadMatchesFromCSVFile(MatchEstimator& estimator,
         matches.emplace_back(std::move(m));
     }
 
+    std::vector<MatchResult> results;
+    results.reserve(matches.size());
     for (auto& m : matches) {
-        estimator.addMatch(m.date, m.home_team.c_str(), m.guest_team.c_str(),
-                           m.home_goals, m.guest_goals);
+        results.push_back({m.date, m.home_team, m.guest_team, m.home_goals,
+                           m.guest_goals});
     }
+    estimator.addMatches(results);
 
     estimator.recalculateTeamStatistics();
     return true;
 }
+
+namespace {
+using Token = gsl::cstring_span<>;
+
+/**
+ * Splits one line into ',' separated fields in place. Mirrors the behaviour
+ * of std::getline(stream, token, ',') on a line: a trailing delimiter does
+ * not start another field.
+ */
+class FieldReader
+{
+public:
+    FieldReader(const char* first, const char* last)
+        : m_pos(first), m_end(last), m_has_more(first != last)
+    {}
+
+    bool next(Token& out)
+    {
+        if (!m_has_more) return false;
+        auto delim = static_cast<const char*>(
+            std::memchr(m_pos, ',', (size_t)(m_end - m_pos)));
+        if (delim == nullptr) {
+            out = Token(m_pos, m_end - m_pos);
+            m_pos = m_end;
+            m_has_more = false;
+        } else {
+            out = Token(m_pos, delim - m_pos);
+            m_pos = delim + 1;
+            m_has_more = m_pos != m_end;
+        }
+        return true;
+    }
+
+private:
+    const char* m_pos;
+    const char* m_end;
+    bool m_has_more;
+};
+
+/**
+ * Parses a leading integer like std::stoi does: leading white space and an
+ * optional sign are skipped, parsing stops at the first non digit.
+ */
+bool parseInt(const char* first, const char* last, int& out)
+{
+    while (first != last && std::isspace((unsigned char)*first)) ++first;
+
+    bool negative = false;
+    if (first != last && (*first == '-' || *first == '+')) {
+        negative = *first == '-';
+        ++first;
+    }
+
+    if (first == last || *first < '0' || *first > '9') return false;
+
+    long long value = 0;
+    for (; first != last && *first >= '0' && *first <= '9'; ++first) {
+        value = value * 10 + (*first - '0');
+        if (value > std::numeric_limits<int>::max()) return false;
+    }
+
+    out = (int)(negative ? -value : value);
+    return true;
+}
+
+bool parseInt(Token token, int& out)
+{
+    return parseInt(token.data(), token.data() + token.size(), out);
+}
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+int twoDigits(const char* pos)
+{
+    return (pos[0] - '0') * 10 + (pos[1] - '0');
+}
+
+/**
+ * Parses dates formatted dd/mm/yy. The common fixed width forms dd/mm/yy and
+ * dd/mm/yyyy are read directly, anything else goes through parseInt().
+ */
+bool parseDate(Token token, int& out)
+{
+    const char* first = token.data();
+    const char* last = first + token.size();
+
+    const auto size = last - first;
+    if ((size == 8 || size == 10) && first[2] == '/' && first[5] == '/' &&
+        std::all_of(first + 6, last, isDigit) && isDigit(first[0]) &&
+        isDigit(first[1]) && isDigit(first[3]) && isDigit(first[4])) {
+        int year = size == 8 ? twoDigits(first + 6)
+                             : twoDigits(first + 6) * 100 + twoDigits(first + 8);
+        year += year > 18 ? 1900 : 2000;
+        out = kwa::match_date(year, twoDigits(first + 3), twoDigits(first));
+        return true;
+    }
+
+    auto slash = std::find(first, last, '/');
+    int day;
+    if (!parseInt(first, slash, day) || slash == last) return false;
+
+    first = slash + 1;
+    slash = std::find(first, last, '/');
+    int month;
+    if (!parseInt(first, slash, month) || slash == last) return false;
+
+    int year;
+    if (!parseInt(slash + 1, last, year)) return false;
+    year += year > 18 ? 1900 : 2000;
+
+    out = kwa::match_date(year, month, day);
+    return true;
+}
+
+bool parseMatch(const char* first, const char* last, kwa::MatchResult& out)
+{
+    FieldReader fields(first, last);
+    Token token;
+
+    if (!fields.next(token)) return false;
+
+    if (!fields.next(token) || !parseDate(token, out.date)) return false;
+
+    if (!fields.next(out.home_team)) return false;
+
+    if (!fields.next(out.guest_team)) return false;
+
+    if (!fields.next(token) || !parseInt(token, out.home_goals)) return false;
+
+    if (!fields.next(token) || !parseInt(token, out.guest_goals)) return false;
+
+    return true;
+}
+} // namespace
+
+bool kwa::loadMatchesFromMappedCSVFile(MatchEstimator& estimator,
+                                       const char* file_name)
+{
+    MappedFile file;
+    if (!file.open(file_name)) {
+        return false;
+    }
+
+    const char* pos = file.begin();
+    const char* end = file.end();
+    auto next_line = [&pos, end](const char*& line_end) {
+        if (pos == end) return false;
+        line_end = static_cast<const char*>(
+            std::memchr(pos, '\n', (size_t)(end - pos)));
+        if (line_end == nullptr) line_end = end;
+        return true;
+    };
+
+    std::vector<MatchResult> matches;
+    matches.reserve(file.size() / 64);
+
+    // skip header
+    const char* line_end;
+    if (next_line(line_end)) pos = line_end == end ? end : line_end + 1;
+
+    while (next_line(line_end)) {
+        MatchResult m;
+        if (!parseMatch(pos, line_end, m)) return false;
+        matches.push_back(m);
+        pos = line_end == end ? end : line_end + 1;
+    }
+
+    estimator.addMatches(matches);
+    estimator.recalculateTeamStatistics();
+    return true;
+}
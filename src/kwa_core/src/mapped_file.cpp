@@ -0,0 +1,101 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+bool kwa::MappedFile::open(const char* file_name)
+{
+    close();
+
+    HANDLE file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file_handle = file;
+    m_is_open = true;
+    if (file_size.QuadPart == 0) return true;
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        return false;
+    }
+    m_mapping_handle = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<const char*>(view);
+    m_size = static_cast<size_t>(file_size.QuadPart);
+    return true;
+}
+
+void kwa::MappedFile::close()
+{
+    if (m_data != nullptr) UnmapViewOfFile(m_data);
+    if (m_mapping_handle != nullptr) CloseHandle(m_mapping_handle);
+    if (m_file_handle != nullptr) CloseHandle(m_file_handle);
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping_handle = nullptr;
+    m_file_handle = nullptr;
+    m_is_open = false;
+}
+#else
+bool kwa::MappedFile::open(const char* file_name)
+{
+    close();
+
+    int fd = ::open(file_name, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    if (file_stat.st_size == 0) {
+        ::close(fd);
+        m_is_open = true;
+        return true;
+    }
+
+    void* view = mmap(nullptr, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+
+    madvise(view, (size_t)file_stat.st_size, MADV_SEQUENTIAL);
+
+    m_data = static_cast<const char*>(view);
+    m_size = (size_t)file_stat.st_size;
+    m_is_open = true;
+    return true;
+}
+
+void kwa::MappedFile::close()
+{
+    if (m_data != nullptr) munmap(const_cast<char*>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+    m_is_open = false;
+}
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+
+namespace kwa {
+/**
+ * @brief      Read-only memory mapping of a whole file. The mapping is
+ *             released when the object is destroyed.
+ */
+class MappedFile
+{
+public:
+    MappedFile() {}
+    explicit MappedFile(const char* file_name) { open(file_name); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief      Maps a file into memory. An already mapped file will be
+     *             closed first.
+     *
+     * @param[in]  file_name  The file name.
+     *
+     * @return     true if success. An empty file is mapped successfully with
+     *             size() == 0.
+     */
+    bool open(const char* file_name);
+
+    /**
+     * @brief      Releases the mapping.
+     */
+    void close();
+
+    bool isOpen() const { return m_is_open; }
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    const char* begin() const { return m_data; }
+    const char* end() const { return m_data + m_size; }
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_is_open = false;
+#ifdef _WIN32
+    void* m_file_handle = nullptr;
+    void* m_mapping_handle = nullptr;
+#endif
+};
+} // namespace kwa
@@ -1,6 +1,194 @@
 #include "match_estimator.h"
 #include "calculations.h"
+#include "estimation_cache.h"
+#include "estimation_table.h"
 #include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <utility>
+#include "thread_pool.h"
+
+namespace {
+constexpr const int STATISTICS_GOAL_CAP = 4;
+// fewer estimations are not worth a thread
+constexpr const size_t MIN_ESTIMATIONS_PER_THREAD = 256;
+
+/**
+ * Calls func(begin, end) for chunks of [0, count) on the threads of a pool,
+ * at least min_chunk items per chunk. The pool is started on first use, a
+ * single chunk runs on the calling thread.
+ */
+template<typename F>
+void parallelFor(std::unique_ptr<kwa::ThreadPool>& pool, size_t count,
+                 size_t min_chunk, F func)
+{
+    if (count < 2 * min_chunk) {
+        func(0, count);
+        return;
+    }
+    if (!pool) pool.reset(new kwa::ThreadPool());
+
+    const size_t chunk_count =
+        std::max<size_t>(1, std::min(pool->threadCount(), count / min_chunk));
+    const size_t chunk = (count + chunk_count - 1) / chunk_count;
+    pool->run(chunk_count, [&](size_t i) {
+        const size_t begin = i * chunk;
+        if (begin < count) func(begin, std::min(count, begin + chunk));
+    });
+}
+
+/**
+ * The StatsProvider queries of one location.
+ */
+struct StatsQueries
+{
+    using Team = kwa::TeamId;
+    using Stats = kwa::TeamStats;
+    int (kwa::StatsProvider::*get)(Team, Stats&) const;
+    int (kwa::StatsProvider::*get_last)(Team, size_t, Stats&) const;
+    int (kwa::StatsProvider::*get_before)(Team, int, Stats&) const;
+    int (kwa::StatsProvider::*get_last_before)(Team, int, size_t, Stats&) const;
+    int (kwa::StatsProvider::*get_between)(Team, int, int, Stats&) const;
+};
+
+const StatsQueries HOME_QUERIES{
+    &kwa::StatsProvider::getHomeStats, &kwa::StatsProvider::getHomeStats,
+    &kwa::StatsProvider::getHomeStatsBefore,
+    &kwa::StatsProvider::getHomeStatsBefore,
+    &kwa::StatsProvider::getHomeStatsBetween};
+
+const StatsQueries GUEST_QUERIES{
+    &kwa::StatsProvider::getGuestStats, &kwa::StatsProvider::getGuestStats,
+    &kwa::StatsProvider::getGuestStatsBefore,
+    &kwa::StatsProvider::getGuestStatsBefore,
+    &kwa::StatsProvider::getGuestStatsBetween};
+
+const StatsQueries TOTAL_QUERIES{
+    &kwa::StatsProvider::getTotalStats, &kwa::StatsProvider::getTotalStats,
+    &kwa::StatsProvider::getTotalStatsBefore,
+    &kwa::StatsProvider::getTotalStatsBefore,
+    &kwa::StatsProvider::getTotalStatsBetween};
+
+/**
+ * Queries the stats of a team in the date range and window of a context.
+ */
+int queryTeamStats(const kwa::StatsProvider& provider,
+                   const StatsQueries& queries, kwa::TeamId team,
+                   const kwa::QueryContext& context, kwa::TeamStats& out)
+{
+    const size_t window = context.window_size;
+    if (context.min_date >= 0) {
+        const int count = (provider.*queries.get_between)(
+            team, context.min_date, context.max_date, out);
+        // else the last matches of the range are the last ones before its end
+        if (window == 0 || count <= (int)window) return count;
+    }
+    if (context.max_date < 0) {
+        return window > 0 ? (provider.*queries.get_last)(team, window, out)
+                          : (provider.*queries.get)(team, out);
+    }
+    return window > 0 ? (provider.*queries.get_last_before)(
+                            team, context.max_date, window, out)
+                      : (provider.*queries.get_before)(team, context.max_date,
+                                                       out);
+}
+} // namespace
+
+kwa::MatchEstimator::MatchEstimator()
+    : m_team_statistics{0}, m_system_points{4.0f, 3.0f, 2.0f}, m_min_date(-1),
+      m_max_date(-1), m_goal_model(SIMPLE), m_location_weight(1.0f),
+      m_total_weight(0.0f), m_goal_cap(STATISTICS_GOAL_CAP),
+      m_tail_epsilon(0.0f), m_poisson_cache(nullptr),
+      m_table_lookup(TABLE_OFF), m_requires_rebuild(false),
+      m_data_generation(0), m_cache_generation(0), m_cache_hits(0),
+      m_cache_misses(0)
+{}
+
+kwa::MatchEstimator::~MatchEstimator() = default;
+
+kwa::MatchEstimator::MatchEstimator(const MatchEstimator& other)
+    : m_matches(other.m_matches), m_team_register(other.m_team_register),
+      m_team_statistics(other.m_team_statistics),
+      m_system_points(other.m_system_points), m_min_date(other.m_min_date),
+      m_max_date(other.m_max_date), m_goal_model(other.m_goal_model),
+      m_location_weight(other.m_location_weight),
+      m_total_weight(other.m_total_weight), m_goal_cap(other.m_goal_cap),
+      m_tail_epsilon(other.m_tail_epsilon),
+      m_poisson_cache(other.m_poisson_cache),
+      m_estimation_table(other.m_estimation_table),
+      m_table_lookup(other.m_table_lookup),
+      m_requires_rebuild(other.m_requires_rebuild),
+      m_prediction_matrix(other.m_prediction_matrix),
+      m_changed_teams(other.m_changed_teams),
+      m_data_generation(other.m_data_generation),
+      m_cache_generation(other.m_data_generation), m_cache_hits(0),
+      m_cache_misses(0)
+{
+    if (other.m_estimation_cache) {
+        m_estimation_cache.reset(
+            new EstimationCache(other.m_estimation_cache->capacity()));
+    }
+}
+
+kwa::MatchEstimator& kwa::MatchEstimator::operator=(const MatchEstimator& other)
+{
+    if (this != &other) *this = MatchEstimator(other);
+    return *this;
+}
+kwa::MatchEstimator::MatchEstimator(MatchEstimator&&) = default;
+kwa::MatchEstimator& kwa::MatchEstimator::operator=(MatchEstimator&&) = default;
+
+void kwa::MatchEstimator::setGoalModel(eGoalModel model,
+                                       float location_weight,
+                                       float total_weight)
+{
+    m_goal_model = model;
+    m_location_weight = model == COMBINED ? location_weight : 1.0f;
+    m_total_weight = model == COMBINED ? total_weight : 0.0f;
+    ++m_data_generation;
+}
+
+void kwa::MatchEstimator::setGoalCap(int goal_cap)
+{
+    if (goal_cap == m_goal_cap) return;
+    m_goal_cap = goal_cap;
+    m_requires_rebuild = true;
+    // the matrix only tracks changed teams, the cap changes all of them
+    resetCaches();
+}
+
+void kwa::MatchEstimator::usePoissonCache(bool enabled)
+{
+    static const PoissonCache shared_cache;
+    m_poisson_cache = enabled ? &shared_cache : nullptr;
+    ++m_data_generation;
+}
+
+void kwa::MatchEstimator::useEstimationTable(eTableLookup lookup)
+{
+    m_table_lookup = lookup;
+    if (lookup == TABLE_OFF)
+        m_estimation_table.reset();
+    else if (!m_estimation_table)
+        m_estimation_table = EstimationTable::shared(m_system_points);
+    ++m_data_generation;
+}
+
+void kwa::MatchEstimator::useEstimationCache(size_t capacity)
+{
+    if (capacity == 0)
+        m_estimation_cache.reset();
+    else
+        m_estimation_cache.reset(new EstimationCache(capacity));
+    m_cache_generation = m_data_generation;
+}
+
+kwa::EstimationError kwa::MatchEstimator::measureEstimationTableError() const
+{
+    if (!m_estimation_table) return EstimationError{};
+    return m_estimation_table->measureError(m_table_lookup ==
+                                            TABLE_INTERPOLATED);
+}
 
 void kwa::MatchEstimator::addMatch(int date, const char* home_team,
                                    const char* guest_team, int home_goals,
@@ -13,18 +201,77 @@ void kwa::MatchEstimator::addMatch(int date, const char* home_team,
     m.home_goals = home_goals;
     m.guest_goals = guest_goals;
 
-    m_matches.insert(std::upper_bound(m_matches.begin(), m_matches.end(), m,
-                                      [](auto& lhs, auto& rhs) {
-                                          return lhs.day < rhs.day;
-                                      }),
-                     m);
+    auto it = std::upper_bound(
+        m_matches.begin(), m_matches.end(), m,
+        [](auto& lhs, auto& rhs) { return lhs.day < rhs.day; });
+
+    // inserting into the range that is already part of the statistics
+    // invalidates their prefix sums
+    if ((size_t)std::distance(m_matches.begin(), it) <
+        m_team_statistics.matchCount())
+        m_requires_rebuild = true;
+
+    m_matches.insert(it, m);
+    m_changed_teams.push_back(m.home_team);
+    m_changed_teams.push_back(m.guest_team);
+    ++m_data_generation;
+}
+
+void kwa::MatchEstimator::addMatches(gsl::span<const MatchResult> matches)
+{
+    const auto old_size = m_matches.size();
+    const auto indexed_count = m_team_statistics.matchCount();
+    ++m_data_generation;
+    m_matches.reserve(old_size + (size_t)matches.size());
+
+    for (auto& match : matches) {
+        if (indexed_count > 0 && indexed_count <= old_size &&
+            match.date < m_matches[indexed_count - 1].day)
+            m_requires_rebuild = true;
+
+        kwa::MatchData m;
+        m.day = match.date;
+        m.home_team = m_team_register.registerTeam(match.home_team);
+        m.guest_team = m_team_register.registerTeam(match.guest_team);
+        m.home_goals = match.home_goals;
+        m.guest_goals = match.guest_goals;
+        m_matches.push_back(m);
+        m_changed_teams.push_back(m.home_team);
+        m_changed_teams.push_back(m.guest_team);
+    }
+
+    // stable sort and merge keep the order of addMatch() for equal dates
+    auto by_day = [](auto& lhs, auto& rhs) { return lhs.day < rhs.day; };
+    auto first_new = m_matches.begin() + (std::ptrdiff_t)old_size;
+    if (!std::is_sorted(first_new, m_matches.end(), by_day))
+        std::stable_sort(first_new, m_matches.end(), by_day);
+    if (first_new != m_matches.begin() && first_new != m_matches.end() &&
+        by_day(*first_new, *(first_new - 1)))
+        std::inplace_merge(m_matches.begin(), first_new, m_matches.end(),
+                           by_day);
 }
 
 void kwa::MatchEstimator::recalculateTeamStatistics()
 {
-    m_team_statistics.clear();
+    const auto indexed_count = m_team_statistics.matchCount();
+    if (!m_requires_rebuild && indexed_count == m_matches.size() &&
+        m_team_statistics.teamCount() == m_team_register.size())
+        return;
+
+    ++m_data_generation;
+    if (m_requires_rebuild || indexed_count > m_matches.size()) {
+        m_team_statistics.clear();
+        m_team_statistics.setTeamCount(m_team_register.size());
+        m_team_statistics.addMatches(m_matches, m_goal_cap);
+        m_requires_rebuild = false;
+        return;
+    }
+
     m_team_statistics.setTeamCount(m_team_register.size());
-    m_team_statistics.addMatches(m_matches, 4);
+    m_team_statistics.addMatches(
+        gsl::span<const MatchData>(m_matches).subspan(
+            (std::ptrdiff_t)indexed_count),
+        m_goal_cap);
 }
 
 void kwa::MatchEstimator::estimate(MatchEstimation& out, const char* home_team,
@@ -39,20 +286,86 @@ void kwa::MatchEstimator::clear()
     m_team_statistics.clear();
     m_matches.clear();
     m_team_register.clear();
+    m_requires_rebuild = false;
+    resetCaches();
+}
+
+void kwa::MatchEstimator::resetCaches()
+{
+    m_prediction_matrix = PredictionMatrix();
+    m_changed_teams.clear();
+    ++m_data_generation;
 }
 
 bool kwa::MatchEstimator::hasHomeStatistics(const char* team_name) const
 {
     auto id = m_team_register.getId(team_name);
     if (id == INVALID_TEAM_ID) return false;
-    return m_team_statistics.hasHomeStats(id, m_max_date);
+    return hasTeamStatistics(id, TeamStats::HOME, queryContext());
 }
 
 bool kwa::MatchEstimator::hasGuestStatistics(const char* team_name) const
 {
     auto id = m_team_register.getId(team_name);
     if (id == INVALID_TEAM_ID) return false;
-    return m_team_statistics.hasGuestStats(id, m_max_date);
+    return hasTeamStatistics(id, TeamStats::AWAY, queryContext());
+}
+
+bool kwa::MatchEstimator::hasHomeStatistics(const char* team_name,
+                                            const QueryContext& context) const
+{
+    auto id = m_team_register.getId(team_name);
+    if (id == INVALID_TEAM_ID) return false;
+    return hasTeamStatistics(id, TeamStats::HOME, context);
+}
+
+bool kwa::MatchEstimator::hasGuestStatistics(const char* team_name,
+                                             const QueryContext& context) const
+{
+    auto id = m_team_register.getId(team_name);
+    if (id == INVALID_TEAM_ID) return false;
+    return hasTeamStatistics(id, TeamStats::AWAY, context);
+}
+
+bool kwa::MatchEstimator::hasHomeStatistics(TeamId team,
+                                            const QueryContext& context) const
+{
+    return hasTeamStatistics(team, TeamStats::HOME, context);
+}
+
+bool kwa::MatchEstimator::hasGuestStatistics(TeamId team,
+                                             const QueryContext& context) const
+{
+    return hasTeamStatistics(team, TeamStats::AWAY, context);
+}
+
+bool kwa::MatchEstimator::hasTeamStatistics(TeamId team,
+                                            TeamStats::eLocation location,
+                                            const QueryContext& context) const
+{
+    const bool home = location == TeamStats::HOME;
+    const int min_date = context.min_date;
+    const int max_date = context.max_date;
+    if (min_date >= 0) {
+        return home ? m_team_statistics.hasHomeStatsBetween(team, min_date,
+                                                            max_date)
+                    : m_team_statistics.hasGuestStatsBetween(team, min_date,
+                                                             max_date);
+    }
+    return home ? m_team_statistics.hasHomeStats(team, max_date)
+                : m_team_statistics.hasGuestStats(team, max_date);
+}
+
+kwa::QueryContext kwa::MatchEstimator::queryContext() const
+{
+    QueryContext context;
+    context.min_date = m_min_date;
+    context.max_date = m_max_date;
+    context.system_points = m_system_points;
+    context.goal_model = m_goal_model;
+    context.location_weight = m_location_weight;
+    context.total_weight = m_total_weight;
+    return context;
 }
 
 // namespace
@@ -70,46 +383,468 @@ bool kwa::MatchEstimator::hasGuestStatistics(const char* team_name) const
 void kwa::MatchEstimator::estimate(MatchEstimation& out, TeamId home_id,
                                    TeamId guest_id)
 {
-    if (m_matches.size() != m_team_statistics.matchCount())
+    if (m_requires_rebuild ||
+        m_matches.size() != m_team_statistics.matchCount())
         recalculateTeamStatistics();
 
+    if (!m_estimation_cache) {
+        estimateCurrent(out, home_id, guest_id, queryContext());
+        return;
+    }
+
+    if (m_cache_generation != m_data_generation) {
+        m_estimation_cache->clear();
+        m_cache_generation = m_data_generation;
+    }
+    const EstimationCache::Key key{home_id, guest_id, m_min_date, m_max_date};
+    if (auto cached = m_estimation_cache->find(key)) {
+        out = *cached;
+        ++m_cache_hits;
+        return;
+    }
+    estimateCurrent(out, home_id, guest_id, queryContext());
+    m_estimation_cache->insert(key, out);
+    ++m_cache_misses;
+}
+
+void kwa::MatchEstimator::estimate(MatchEstimation& out, const char* home_team,
+                                   const char* guest_team,
+                                   const QueryContext& context) const
+{
+    estimate(out, m_team_register.getId(home_team),
+             m_team_register.getId(guest_team), context);
+}
+
+void kwa::MatchEstimator::estimate(MatchEstimation& out, TeamId home_id,
+                                   TeamId guest_id,
+                                   const QueryContext& context) const
+{
+    assert(!m_requires_rebuild &&
+           m_matches.size() == m_team_statistics.matchCount());
+    estimateCurrent(out, home_id, guest_id, context);
+}
+
+void kwa::MatchEstimator::estimateCurrent(MatchEstimation& out,
+                                          TeamId home_id, TeamId guest_id,
+                                          const QueryContext& context) const
+{
     kwa::LeagueStats league_stats;
     kwa::TeamStats home_stats, guest_stats;
 
-    getStatistics(home_id, guest_id, home_stats, guest_stats, league_stats);
+    getStatistics(home_id, guest_id, context, home_stats, guest_stats,
+                  league_stats);
 
     kwa::GoalDistribution home_distr, guest_distr;
-    float home_ev =
-        kwa::CalculateHomeGoalEvSimple(home_stats, guest_stats, league_stats);
-    float guest_ev =
-        kwa::CalculateGuestGoalEvSimple(home_stats, guest_stats, league_stats);
-    kwa::FillPoissonDistribution(home_distr, home_ev);
-    kwa::FillPoissonDistribution(guest_distr, guest_ev);
+    float home_ev, guest_ev;
+    calculateGoalEvs(home_stats, guest_stats, league_stats, context, home_ev,
+                     guest_ev);
 
-    out.three_way_probabilities =
-        kwa::CalculateThreeWayBet(home_distr, guest_distr, home_ev, guest_ev);
+    const EstimationTable* table = estimationTable(context);
+    if (table && table->contains(home_ev, guest_ev)) {
+        EstimationTable::Entry entry;
+        if (m_table_lookup == TABLE_INTERPOLATED)
+            table->lookupInterpolated(home_ev, guest_ev, entry);
+        else
+            table->lookupNearest(home_ev, guest_ev, entry);
 
-    auto best_bet = kwa::CalculateBestBet(home_distr, guest_distr, home_ev,
-                                          guest_ev, m_system_points);
+        out.three_way_probabilities = entry.three_way;
+        out.best_result_bet_home_goals = entry.best_home_goals;
+        out.best_result_bet_guest_goals = entry.best_guest_goals;
+        out.best_result_bet_ev = entry.best_bet_ev;
+        out.truncation_error = entry.truncation_error;
+        return;
+    }
+
+    if (m_poisson_cache != nullptr) {
+        m_poisson_cache->fill(home_distr, home_ev);
+        m_poisson_cache->fill(guest_distr, guest_ev);
+    } else {
+        kwa::FillPoissonDistribution(home_distr, home_ev);
+        kwa::FillPoissonDistribution(guest_distr, guest_ev);
+    }
+
+    int home_cap = (int)home_distr.size();
+    int guest_cap = (int)guest_distr.size();
+    float home_tail, guest_tail;
+    if (m_tail_epsilon > 0.0f) {
+        home_cap =
+            kwa::TruncateDistribution(home_distr, m_tail_epsilon, home_tail);
+        guest_cap =
+            kwa::TruncateDistribution(guest_distr, m_tail_epsilon, guest_tail);
+    } else {
+        home_tail = 1.0f - std::accumulate(home_distr.begin(),
+                                           home_distr.end(), 0.0f);
+        guest_tail = 1.0f - std::accumulate(guest_distr.begin(),
+                                            guest_distr.end(), 0.0f);
+    }
+    out.truncation_error = std::max(
+        0.0f, 1.0f - (1.0f - home_tail) * (1.0f - guest_tail));
+
+    kwa::ScoreMatrix scores;
+    kwa::FillScoreMatrix(scores, make_span(home_distr, home_cap),
+                         make_span(guest_distr, guest_cap), home_ev, guest_ev,
+                         context.correction);
+
+    out.three_way_probabilities = kwa::CalculateThreeWayBet(scores);
+
+    auto best_bet = kwa::CalculateBestBet(scores, context.system_points);
 
     out.best_result_bet_home_goals = best_bet.home_goals;
     out.best_result_bet_guest_goals = best_bet.guest_goals;
     out.best_result_bet_ev = best_bet.ev;
 }
 
+void kwa::MatchEstimator::estimateMany(
+    gsl::span<const std::pair<TeamId, TeamId>> matches,
+    MatchEstimationBatch& out)
+{
+    if (m_requires_rebuild ||
+        m_matches.size() != m_team_statistics.matchCount())
+        recalculateTeamStatistics();
+    estimateManyCurrent(matches, queryContext(), out);
+}
+
+void kwa::MatchEstimator::estimateManyCurrent(
+    gsl::span<const std::pair<TeamId, TeamId>> matches,
+    const QueryContext& context, MatchEstimationBatch& out) const
+{
+    kwa::LeagueStats league_stats;
+    getLeagueStatistics(context, league_stats);
+
+    // every team is queried once per location, in order of the ids
+    std::vector<TeamId> home_teams, guest_teams;
+    home_teams.reserve((size_t)matches.size());
+    guest_teams.reserve((size_t)matches.size());
+    for (auto& match : matches) {
+        home_teams.push_back(match.first);
+        guest_teams.push_back(match.second);
+    }
+    auto query_teams = [this, &context](std::vector<TeamId>& teams,
+                                        TeamStats::eLocation location) {
+        std::sort(teams.begin(), teams.end());
+        teams.erase(std::unique(teams.begin(), teams.end()), teams.end());
+        std::vector<TeamStats> stats(teams.size());
+        for (size_t i = 0; i < teams.size(); ++i)
+            getTeamStatistics(teams[i], location, context, stats[i]);
+        return stats;
+    };
+    const auto home_stats = query_teams(home_teams, TeamStats::HOME);
+    const auto guest_stats = query_teams(guest_teams, TeamStats::AWAY);
+    auto find_stats = [](const std::vector<TeamId>& teams,
+                         const std::vector<TeamStats>& stats,
+                         TeamId team) -> const TeamStats& {
+        auto it = std::lower_bound(teams.begin(), teams.end(), team);
+        return stats[(size_t)std::distance(teams.begin(), it)];
+    };
+
+    std::vector<float> home_evs((size_t)matches.size());
+    std::vector<float> guest_evs((size_t)matches.size());
+    for (std::ptrdiff_t i = 0; i < matches.size(); ++i) {
+        calculateGoalEvs(find_stats(home_teams, home_stats, matches[i].first),
+                         find_stats(guest_teams, guest_stats,
+                                    matches[i].second),
+                         league_stats, context, home_evs[(size_t)i],
+                         guest_evs[(size_t)i]);
+    }
+
+    estimateGoalEvs(home_evs, guest_evs, context, out);
+}
+
+void kwa::MatchEstimator::estimateTipOutcomes(gsl::span<const MatchTip> tips,
+                                              std::vector<TipOutcome>& out)
+{
+    if (m_requires_rebuild ||
+        m_matches.size() != m_team_statistics.matchCount())
+        recalculateTeamStatistics();
+    estimateTipOutcomes(tips, queryContext(), out);
+}
+
+void kwa::MatchEstimator::estimateTipOutcomes(
+    gsl::span<const MatchTip> tips, const QueryContext& context,
+    std::vector<TipOutcome>& out) const
+{
+    assert(!m_requires_rebuild &&
+           m_matches.size() == m_team_statistics.matchCount());
+
+    kwa::LeagueStats league_stats;
+    getLeagueStatistics(context, league_stats);
+
+    out.resize((size_t)tips.size());
+    for (std::ptrdiff_t i = 0; i < tips.size(); ++i) {
+        const auto& tip = tips[i];
+        kwa::ScoreMatrix scores;
+        getScoreMatrix(tip.home_team, tip.guest_team, league_stats, context,
+                       scores);
+        out[(size_t)i] =
+            kwa::CalculateTipOutcome(scores, tip.home_goals, tip.guest_goals);
+    }
+}
+
+void kwa::MatchEstimator::expectedGoals(TeamId home_id, TeamId guest_id,
+                                        const QueryContext& context,
+                                        float& home_ev, float& guest_ev) const
+{
+    assert(!m_requires_rebuild &&
+           m_matches.size() == m_team_statistics.matchCount());
+
+    kwa::LeagueStats league_stats;
+    kwa::TeamStats home_stats, guest_stats;
+    getStatistics(home_id, guest_id, context, home_stats, guest_stats,
+                  league_stats);
+    calculateGoalEvs(home_stats, guest_stats, league_stats, context, home_ev,
+                     guest_ev);
+}
+
+const kwa::PredictionMatrix& kwa::MatchEstimator::predictionMatrix()
+{
+    if (m_requires_rebuild ||
+        m_matches.size() != m_team_statistics.matchCount())
+        recalculateTeamStatistics();
+
+    auto& matrix = m_prediction_matrix;
+    const QueryContext context = queryContext();
+    const size_t team_count = m_team_register.size();
+    const PredictionMatrix::Settings settings{
+        m_min_date,      m_max_date,     (int)m_goal_model,
+        m_location_weight, m_total_weight, (int)m_table_lookup};
+    const bool update_all =
+        team_count != matrix.m_team_count ||
+        std::memcmp(&settings, &matrix.m_settings, sizeof(settings)) != 0;
+
+    std::vector<TeamId> teams;
+    if (update_all) {
+        matrix.m_team_count = team_count;
+        matrix.m_settings = settings;
+        matrix.m_estimations.assign(team_count * team_count, MatchEstimation{});
+        matrix.m_home_stats.assign(team_count, TeamStats{});
+        matrix.m_guest_stats.assign(team_count, TeamStats{});
+        matrix.m_has_home_stats.assign(team_count, 0);
+        matrix.m_has_guest_stats.assign(team_count, 0);
+        teams.resize(team_count);
+        std::iota(teams.begin(), teams.end(), 0);
+    } else {
+        teams.swap(m_changed_teams);
+        std::sort(teams.begin(), teams.end());
+        teams.erase(std::unique(teams.begin(), teams.end()), teams.end());
+    }
+    m_changed_teams.clear();
+
+    // rows and columns of teams whose statistics changed
+    std::vector<char> changed(team_count, 0);
+    auto update_stats = [this, &context](TeamId team,
+                                         TeamStats::eLocation location,
+                                         char& has_stats, TeamStats& stats) {
+        TeamStats new_stats{};
+        const char has_new_stats =
+            hasTeamStatistics(team, location, context) ? 1 : 0;
+        if (has_new_stats)
+            getTeamStatistics(team, location, context, new_stats);
+        if (has_new_stats == has_stats &&
+            std::memcmp(&new_stats, &stats, sizeof(stats)) == 0)
+            return false;
+        has_stats = has_new_stats;
+        stats = new_stats;
+        return true;
+    };
+    for (TeamId team : teams) {
+        const auto t = (size_t)team;
+        const bool home_changed =
+            update_stats(team, TeamStats::HOME, matrix.m_has_home_stats[t],
+                         matrix.m_home_stats[t]);
+        const bool guest_changed =
+            update_stats(team, TeamStats::AWAY, matrix.m_has_guest_stats[t],
+                         matrix.m_guest_stats[t]);
+        changed[t] = update_all || home_changed || guest_changed;
+    }
+
+    LeagueStats league_stats{};
+    if (team_count > 0) getLeagueStatistics(context, league_stats);
+    if (std::memcmp(&league_stats, &matrix.m_league_stats,
+                    sizeof(league_stats)) != 0) {
+        matrix.m_league_stats = league_stats;
+        std::fill(changed.begin(), changed.end(), 1);
+    }
+
+    std::vector<size_t> cells;
+    std::vector<float> home_evs, guest_evs;
+    for (size_t h = 0; h < team_count; ++h) {
+        for (size_t g = 0; g < team_count; ++g) {
+            if (!(changed[h] || changed[g]) ||
+                !matrix.isValid((TeamId)h, (TeamId)g))
+                continue;
+            float home_ev, guest_ev;
+            calculateGoalEvs(matrix.m_home_stats[h], matrix.m_guest_stats[g],
+                             league_stats, context, home_ev, guest_ev);
+            cells.push_back(h * team_count + g);
+            home_evs.push_back(home_ev);
+            guest_evs.push_back(guest_ev);
+        }
+    }
+
+    parallelFor(m_thread_pool, cells.size(), MIN_ESTIMATIONS_PER_THREAD,
+                [&](size_t begin, size_t end) {
+                    const auto offset = (std::ptrdiff_t)begin;
+                    const auto count = (std::ptrdiff_t)(end - begin);
+                    MatchEstimationBatch batch;
+                    estimateGoalEvs(
+                        gsl::span<const float>(home_evs).subspan(offset, count),
+                        gsl::span<const float>(guest_evs).subspan(offset, count),
+                        context, batch);
+                    for (size_t i = begin; i < end; ++i) {
+                        const size_t k = i - begin;
+                        auto& out = matrix.m_estimations[cells[i]];
+                        out.three_way_probabilities = {
+                            {batch.home_win[k], batch.draw[k],
+                             batch.guest_win[k]}};
+                        out.best_result_bet_home_goals =
+                            batch.best_result_bet_home_goals[k];
+                        out.best_result_bet_guest_goals =
+                            batch.best_result_bet_guest_goals[k];
+                        out.best_result_bet_ev = batch.best_result_bet_ev[k];
+                        out.truncation_error = batch.truncation_error[k];
+                    }
+                });
+    return matrix;
+}
+
+void kwa::MatchEstimator::estimateGoalEvs(gsl::span<const float> home_evs,
+                                          gsl::span<const float> guest_evs,
+                                          const QueryContext& context,
+                                          MatchEstimationBatch& out) const
+{
+    const EstimationTable* table = estimationTable(context);
+    if (!table) {
+        kwa::EstimateBatch(home_evs, guest_evs, context.system_points, out,
+                           BATCH_KERNEL_AUTO, context.correction);
+        return;
+    }
+
+    // table lookups, expected goals out of the grid are estimated in a batch
+    const size_t count = (size_t)home_evs.size();
+    out.resize(count);
+    std::vector<size_t> exact_indices;
+    std::vector<float> exact_home_evs, exact_guest_evs;
+    for (size_t i = 0; i < count; ++i) {
+        if (!table->contains(home_evs[i], guest_evs[i])) {
+            exact_indices.push_back(i);
+            exact_home_evs.push_back(home_evs[i]);
+            exact_guest_evs.push_back(guest_evs[i]);
+            continue;
+        }
+
+        EstimationTable::Entry entry;
+        if (m_table_lookup == TABLE_INTERPOLATED)
+            table->lookupInterpolated(home_evs[i], guest_evs[i], entry);
+        else
+            table->lookupNearest(home_evs[i], guest_evs[i], entry);
+        out.home_win[i] = entry.three_way[0];
+        out.draw[i] = entry.three_way[1];
+        out.guest_win[i] = entry.three_way[2];
+        out.best_result_bet_home_goals[i] = entry.best_home_goals;
+        out.best_result_bet_guest_goals[i] = entry.best_guest_goals;
+        out.best_result_bet_ev[i] = entry.best_bet_ev;
+        out.truncation_error[i] = entry.truncation_error;
+    }
+    if (exact_indices.empty()) return;
+
+    MatchEstimationBatch exact;
+    kwa::EstimateBatch(exact_home_evs, exact_guest_evs, context.system_points,
+                       exact, BATCH_KERNEL_AUTO, context.correction);
+    for (size_t k = 0; k < exact_indices.size(); ++k) {
+        const size_t i = exact_indices[k];
+        out.home_win[i] = exact.home_win[k];
+        out.draw[i] = exact.draw[k];
+        out.guest_win[i] = exact.guest_win[k];
+        out.best_result_bet_home_goals[i] = exact.best_result_bet_home_goals[k];
+        out.best_result_bet_guest_goals[i] =
+            exact.best_result_bet_guest_goals[k];
+        out.best_result_bet_ev[i] = exact.best_result_bet_ev[k];
+        out.truncation_error[i] = exact.truncation_error[k];
+    }
+}
+
 void kwa::MatchEstimator::getStatistics(TeamId home_id, TeamId guest_id,
+                                        const QueryContext& context,
                                         TeamStats& home_stats,
                                         TeamStats& guest_stats,
                                         LeagueStats& league_stats) const
 {
-    if (m_max_date < 0) {
-        m_team_statistics.getHomeStats(home_id, home_stats);
-        m_team_statistics.getGuestStats(guest_id, guest_stats);
-        m_team_statistics.getLeagueStats(league_stats);
+    getTeamStatistics(home_id, TeamStats::HOME, context, home_stats);
+    getTeamStatistics(guest_id, TeamStats::AWAY, context, guest_stats);
+    getLeagueStatistics(context, league_stats);
+}
+
+void kwa::MatchEstimator::getTeamStatistics(TeamId team,
+                                            TeamStats::eLocation location,
+                                            const QueryContext& context,
+                                            TeamStats& out) const
+{
+    queryTeamStats(m_team_statistics,
+                   location == TeamStats::HOME ? HOME_QUERIES : GUEST_QUERIES,
+                   team, context, out);
+    if (context.goal_model == COMBINED)
+        queryTeamStats(m_team_statistics, TOTAL_QUERIES, team, context, out);
+}
+
+void kwa::MatchEstimator::getLeagueStatistics(const QueryContext& context,
+                                              LeagueStats& out) const
+{
+    if (context.min_date >= 0)
+        m_team_statistics.getLeagueStatsBetween(context.min_date,
+                                                context.max_date, out);
+    else if (context.max_date < 0)
+        m_team_statistics.getLeagueStats(out);
+    else
+        m_team_statistics.getLeagueStatsBefore(context.max_date, out);
+}
+
+void kwa::MatchEstimator::getScoreMatrix(TeamId home_id, TeamId guest_id,
+                                         const LeagueStats& league_stats,
+                                         const QueryContext& context,
+                                         ScoreMatrix& out) const
+{
+    kwa::TeamStats home_stats, guest_stats;
+    getTeamStatistics(home_id, TeamStats::HOME, context, home_stats);
+    getTeamStatistics(guest_id, TeamStats::AWAY, context, guest_stats);
+    float home_ev, guest_ev;
+    calculateGoalEvs(home_stats, guest_stats, league_stats, context, home_ev,
+                     guest_ev);
+    kwa::FillScoreMatrix(out, home_ev, guest_ev, context.correction);
+}
+
+const kwa::EstimationTable*
+kwa::MatchEstimator::estimationTable(const QueryContext& context) const
+{
+    // the table is built for the system points of the estimator and the
+    // default correction
+    const auto& points = context.system_points;
+    if (!m_estimation_table ||
+        context.correction != DEFAULT_POISSON_CORRECTION ||
+        points.result != m_system_points.result ||
+        points.difference != m_system_points.difference ||
+        points.tendency != m_system_points.tendency)
+        return nullptr;
+    return m_estimation_table.get();
+}
+
+void kwa::MatchEstimator::calculateGoalEvs(const TeamStats& home_stats,
+                                           const TeamStats& guest_stats,
+                                           const LeagueStats& league_stats,
+                                           const QueryContext& context,
+                                           float& home_ev,
+                                           float& guest_ev) const
+{
+    if (context.goal_model == COMBINED) {
+        home_ev = kwa::CalculateHomeGoalEvCombined(
+            home_stats, guest_stats, league_stats, context.location_weight,
+            context.total_weight);
+        guest_ev = kwa::CalculateGuestGoalEvCombined(
+            home_stats, guest_stats, league_stats, context.location_weight,
+            context.total_weight);
     } else {
-        m_team_statistics.getHomeStatsBefore(home_id, m_max_date, home_stats);
-        m_team_statistics.getGuestStatsBefore(guest_id, m_max_date,
-                                              guest_stats);
-        m_team_statistics.getLeagueStatsBefore(m_max_date, league_stats);
+        home_ev = kwa::CalculateHomeGoalEvSimple(home_stats, guest_stats,
+                                                 league_stats);
+        guest_ev = kwa::CalculateGuestGoalEvSimple(home_stats, guest_stats,
+                                                   league_stats);
     }
 }
@@ -0,0 +1,154 @@
+#include "parameter_sweep.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <random>
+
+void kwa::MakeSweepGrid(const SweepGrid& grid, std::vector<SweepParameters>& out)
+{
+    out.clear();
+    for (int goal_cap : grid.goal_caps) {
+        for (size_t window_size : grid.window_sizes) {
+            for (float correction : grid.corrections) {
+                SweepParameters parameters;
+                parameters.goal_cap = goal_cap;
+                parameters.window_size = window_size;
+                parameters.correction = correction;
+                for (auto goal_model : grid.goal_models) {
+                    parameters.goal_model = goal_model;
+                    if (goal_model != MatchEstimator::COMBINED) {
+                        parameters.location_weight = 1.0f;
+                        parameters.total_weight = 0.0f;
+                        out.push_back(parameters);
+                        continue;
+                    }
+                    for (float location_weight : grid.location_weights) {
+                        for (float total_weight : grid.total_weights) {
+                            parameters.location_weight = location_weight;
+                            parameters.total_weight = total_weight;
+                            out.push_back(parameters);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void kwa::MakeRandomSweep(const SweepGrid& grid, size_t count, uint32_t seed,
+                          std::vector<SweepParameters>& out)
+{
+    std::mt19937 rng(seed);
+    auto pick = [&rng](const auto& values) {
+        assert(!values.empty());
+        std::uniform_int_distribution<size_t> index(0, values.size() - 1);
+        return values[index(rng)];
+    };
+    auto uniform = [&rng](const std::vector<float>& values) {
+        assert(!values.empty());
+        const auto range = std::minmax_element(values.begin(), values.end());
+        std::uniform_real_distribution<float> value(*range.first,
+                                                    *range.second);
+        return value(rng);
+    };
+
+    out.clear();
+    for (size_t i = 0; i < count; ++i) {
+        SweepParameters parameters;
+        parameters.goal_cap = pick(grid.goal_caps);
+        parameters.window_size = pick(grid.window_sizes);
+        parameters.goal_model = pick(grid.goal_models);
+        parameters.correction = uniform(grid.corrections);
+        if (parameters.goal_model == MatchEstimator::COMBINED) {
+            parameters.location_weight = uniform(grid.location_weights);
+            parameters.total_weight = uniform(grid.total_weights);
+        }
+        out.push_back(parameters);
+    }
+}
+
+void kwa::ParameterSweep::run(const MatchEstimator& estimator,
+                              gsl::span<const SweepParameters> parameters,
+                              const BacktestSettings& settings,
+                              std::vector<SweepResult>& out)
+{
+    out.resize((size_t)parameters.size());
+    for (std::ptrdiff_t i = 0; i < parameters.size(); ++i)
+        out[(size_t)i].parameters = parameters[i];
+
+    // the goal cap is part of the statistics, all other parameters are part
+    // of the query context
+    std::vector<int> goal_caps;
+    for (const auto& set : parameters) goal_caps.push_back(set.goal_cap);
+    std::sort(goal_caps.begin(), goal_caps.end());
+    goal_caps.erase(std::unique(goal_caps.begin(), goal_caps.end()),
+                    goal_caps.end());
+
+    std::vector<BacktestSettings> cap_settings;
+    std::vector<size_t> cap_indices;
+    std::vector<BacktestResult> results;
+    for (int goal_cap : goal_caps) {
+        cap_settings.clear();
+        cap_indices.clear();
+        for (std::ptrdiff_t i = 0; i < parameters.size(); ++i) {
+            const auto& set = parameters[i];
+            if (set.goal_cap != goal_cap) continue;
+            BacktestSettings backtest = settings;
+            backtest.context.window_size = set.window_size;
+            backtest.context.goal_model = set.goal_model;
+            backtest.context.location_weight = set.location_weight;
+            backtest.context.total_weight = set.total_weight;
+            backtest.context.correction = set.correction;
+            cap_settings.push_back(backtest);
+            cap_indices.push_back((size_t)i);
+        }
+
+        if (goal_cap == estimator.goalCap()) {
+            m_backtester.run(estimator, cap_settings, results);
+        } else {
+            MatchEstimator capped = estimator;
+            capped.setGoalCap(goal_cap);
+            capped.recalculateTeamStatistics();
+            m_backtester.run(capped, cap_settings, results);
+        }
+        for (size_t k = 0; k < cap_indices.size(); ++k)
+            out[cap_indices[k]].points = results[k].total;
+    }
+
+    // best first, ties keep the order of the parameter sets
+    std::stable_sort(out.begin(), out.end(),
+                     [](const SweepResult& a, const SweepResult& b) {
+                         return a.points.points > b.points.points;
+                     });
+}
+
+bool kwa::writeSweepReport(gsl::span<const SweepResult> results,
+                           const char* file_name)
+{
+    std::ofstream file(file_name, std::ios::trunc);
+    if (!file) return false;
+
+    file << "Rank,Points,PointsPerBet,Bets,ResultHits,DifferenceHits,"
+            "TendencyHits,GoalCap,WindowSize,GoalModel,LocationWeight,"
+            "TotalWeight,Correction\n";
+    for (std::ptrdiff_t i = 0; i < results.size(); ++i) {
+        const auto& points = results[i].points;
+        const auto& set = results[i].parameters;
+        const float per_bet =
+            points.bet_count > 0 ? points.points / (float)points.bet_count
+                                 : 0.0f;
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "%d,%.1f,%.4f,%zu,%zu,%zu,%zu,%d,%zu,%s,%.3f,%.3f,%.3f\n",
+                      (int)i + 1, points.points, per_bet, points.bet_count,
+                      points.result_hits, points.difference_hits,
+                      points.tendency_hits, set.goal_cap, set.window_size,
+                      set.goal_model == MatchEstimator::COMBINED ? "Combined"
+                                                                 : "Simple",
+                      set.location_weight, set.total_weight, set.correction);
+        file << line;
+    }
+    return (bool)file;
+}
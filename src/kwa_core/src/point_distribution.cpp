@@ -0,0 +1,97 @@
+#include "point_distribution.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+int wholePoints(float points)
+{
+    assert(points >= 0.0f && std::round(points) == points);
+    return (int)std::lround(points);
+}
+
+/**
+ * out[k + offset] += factor * in[k] for all k, the inner loop of every
+ * convolution. Plain loops over contiguous doubles, which the compiler
+ * vectorizes.
+ */
+void addScaled(const std::vector<double>& in, double factor, size_t offset,
+               std::vector<double>& out)
+{
+    if (factor == 0.0) return;
+    assert(offset + in.size() <= out.size());
+    const double* src = in.data();
+    double* dst = out.data() + offset;
+    const size_t count = in.size();
+    for (size_t k = 0; k < count; ++k) dst[k] += factor * src[k];
+}
+} // namespace
+
+kwa::PointDistribution::PointDistribution() : m_probabilities(1, 1.0) {}
+
+void kwa::PointDistribution::addMatch(const TipOutcome& outcome,
+                                      const BetSystemPoints& system_points)
+{
+    addMatches({&outcome, 1}, system_points);
+}
+
+void kwa::PointDistribution::addMatches(gsl::span<const TipOutcome> outcomes,
+                                        const BetSystemPoints& system_points)
+{
+    const size_t tendency = (size_t)wholePoints(system_points.tendency);
+    const size_t difference = (size_t)wholePoints(system_points.difference);
+    const size_t result = (size_t)wholePoints(system_points.result);
+    const size_t max_step = std::max(std::max(tendency, difference), result);
+
+    // one sparse convolution with the four outcomes per match
+    for (const auto& outcome : outcomes) {
+        // the miss takes the rounding of the float outcomes, so the total
+        // stays one over a whole season
+        const double hits = (double)outcome.tendency +
+                            (double)outcome.difference + (double)outcome.result;
+        m_buffer.assign(m_probabilities.size() + max_step, 0.0);
+        addScaled(m_probabilities, std::max(0.0, 1.0 - hits), 0, m_buffer);
+        addScaled(m_probabilities, outcome.tendency, tendency, m_buffer);
+        addScaled(m_probabilities, outcome.difference, difference, m_buffer);
+        addScaled(m_probabilities, outcome.result, result, m_buffer);
+        m_probabilities.swap(m_buffer);
+    }
+}
+
+void kwa::PointDistribution::add(const PointDistribution& other)
+{
+    m_buffer.assign(m_probabilities.size() + other.m_probabilities.size() - 1,
+                    0.0);
+    for (size_t k = 0; k < other.m_probabilities.size(); ++k)
+        addScaled(m_probabilities, other.m_probabilities[k], k, m_buffer);
+    m_probabilities.swap(m_buffer);
+}
+
+void kwa::PointDistribution::clear()
+{
+    m_probabilities.assign(1, 1.0);
+}
+
+double kwa::PointDistribution::probability(int points) const
+{
+    if (points < 0 || points > maxPoints()) return 0.0;
+    return m_probabilities[(size_t)points];
+}
+
+double kwa::PointDistribution::probabilityAtLeast(int points) const
+{
+    const size_t first = (size_t)std::max(0, points);
+    if (first >= m_probabilities.size()) return 0.0;
+    double sum = 0.0;
+    for (size_t k = first; k < m_probabilities.size(); ++k)
+        sum += m_probabilities[k];
+    return std::min(1.0, sum);
+}
+
+double kwa::PointDistribution::mean() const
+{
+    double sum = 0.0;
+    for (size_t k = 0; k < m_probabilities.size(); ++k)
+        sum += (double)k * m_probabilities[k];
+    return sum;
+}
@@ -0,0 +1,43 @@
+#include "score_sampler.h"
+#include <algorithm>
+#include <vector>
+
+void kwa::ScoreSampler::build(const ScoreMatrix& scores)
+{
+    // scaled to a mean of 1 per cell, the correction may make cells negative
+    std::array<double, CELL_COUNT> weights{};
+    double sum = 0.0;
+    for (int i = 0; i < scores.home_size; ++i) {
+        for (int j = 0; j < scores.guest_size; ++j) {
+            const double prop = std::max(0.0f, scores.at(i, j));
+            weights[(size_t)(i * (int)(MAX_GOALS + 1) + j)] = prop;
+            sum += prop;
+        }
+    }
+    for (auto& weight : weights) weight *= (double)CELL_COUNT / sum;
+
+    std::vector<uint8_t> small, large;
+    for (size_t i = 0; i < CELL_COUNT; ++i)
+        (weights[i] < 1.0 ? small : large).push_back((uint8_t)i);
+    while (!small.empty() && !large.empty()) {
+        const uint8_t low = small.back();
+        const uint8_t high = large.back();
+        small.pop_back();
+        threshold[low] = (uint32_t)(weights[low] * 4294967296.0);
+        alias[low] = high;
+        weights[high] -= 1.0 - weights[low];
+        if (weights[high] < 1.0) {
+            large.pop_back();
+            small.push_back(high);
+        }
+    }
+    // left overs are 1 up to rounding
+    for (uint8_t i : small) {
+        threshold[i] = UINT32_MAX;
+        alias[i] = i;
+    }
+    for (uint8_t i : large) {
+        threshold[i] = UINT32_MAX;
+        alias[i] = i;
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "calculations.h"
+#include <cstdint>
+
+namespace kwa {
+/**
+ * Counter-based random numbers: the n-th number of a stream is a SplitMix64
+ * mix of the stream key and n only, so every stream (e.g. one simulated
+ * season) gives the same numbers no matter which thread draws them.
+ */
+class CounterRng
+{
+public:
+    CounterRng(uint64_t seed, uint64_t stream)
+        : m_key(mix(seed ^ mix(stream * GOLDEN_GAMMA))), m_counter(0)
+    {}
+
+    uint64_t next() { return mix(m_key + GOLDEN_GAMMA * ++m_counter); }
+
+private:
+    static constexpr const uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ull;
+
+    /// SplitMix64 finalizer, a bijective 64 bit mix
+    static uint64_t mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t m_key;
+    uint64_t m_counter;
+};
+
+/**
+ * Walker alias table of the scores of a match, draws a score with one random
+ * number in O(1). Cells are indexed home_goals * (MAX_GOALS + 1) +
+ * guest_goals.
+ */
+struct ScoreSampler
+{
+    static constexpr const size_t CELL_COUNT = MAX_POSSIBLE_RESULTS;
+
+    /// keep the cell if the low 32 bits of the random number are below
+    std::array<uint32_t, CELL_COUNT> threshold;
+    std::array<uint8_t, CELL_COUNT> alias;
+
+    void build(const ScoreMatrix& scores);
+
+    size_t sample(uint64_t random) const
+    {
+        const size_t cell = (size_t)(((random >> 32) * CELL_COUNT) >> 32);
+        return (uint32_t)random < threshold[cell] ? cell : alias[cell];
+    }
+
+    static int homeGoals(size_t cell) { return (int)(cell / (MAX_GOALS + 1)); }
+    static int guestGoals(size_t cell) { return (int)(cell % (MAX_GOALS + 1)); }
+};
+} // namespace kwa
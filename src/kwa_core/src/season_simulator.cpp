@@ -0,0 +1,177 @@
+#include "season_simulator.h"
+#include <algorithm>
+#include <atomic>
+#include "score_sampler.h"
+#include "thread_pool.h"
+
+namespace {
+constexpr const uint64_t SEASONS_PER_TASK = 1024;
+
+struct TableRow
+{
+    int points;
+    int goals;
+    int against;
+};
+
+void addResult(TableRow& home, TableRow& guest, int home_goals,
+               int guest_goals)
+{
+    home.goals += home_goals;
+    home.against += guest_goals;
+    guest.goals += guest_goals;
+    guest.against += home_goals;
+    if (home_goals > guest_goals)
+        home.points += 3;
+    else if (home_goals < guest_goals)
+        guest.points += 3;
+    else {
+        ++home.points;
+        ++guest.points;
+    }
+}
+} // namespace
+
+kwa::SeasonSimulator::SeasonSimulator(size_t thread_count)
+    : m_pool(new ThreadPool(thread_count))
+{
+}
+
+kwa::SeasonSimulator::~SeasonSimulator() = default;
+
+bool kwa::SeasonSimulator::run(
+    const MatchEstimator& estimator,
+    gsl::span<const std::pair<TeamId, TeamId>> fixtures,
+    const SeasonSimulationSettings& settings, SeasonSimulationResult& out)
+{
+    const QueryContext& context = settings.context;
+    out = SeasonSimulationResult();
+
+    // the table: teams of the current season and of the fixtures
+    const auto matches = estimator.matches();
+    auto in_season = [&](const MatchData& match) {
+        return settings.season_start >= 0 &&
+               match.day >= settings.season_start &&
+               (context.max_date < 0 || match.day < context.max_date);
+    };
+    std::vector<char> in_table(estimator.teamRegister().size(), 0);
+    for (const auto& match : matches) {
+        if (!in_season(match)) continue;
+        in_table[(size_t)match.home_team] = 1;
+        in_table[(size_t)match.guest_team] = 1;
+    }
+    for (const auto& fixture : fixtures) {
+        if (!estimator.hasHomeStatistics(fixture.first, context) ||
+            !estimator.hasGuestStatistics(fixture.second, context))
+            return false;
+        in_table[(size_t)fixture.first] = 1;
+        in_table[(size_t)fixture.second] = 1;
+    }
+
+    std::vector<uint32_t> table_index(in_table.size());
+    for (size_t t = 0; t < in_table.size(); ++t) {
+        if (!in_table[t]) continue;
+        table_index[t] = (uint32_t)out.teams.size();
+        out.teams.push_back((TeamId)t);
+    }
+    const size_t team_count = out.teams.size();
+
+    std::vector<TableRow> current(team_count, TableRow{0, 0, 0});
+    for (const auto& match : matches) {
+        if (!in_season(match)) continue;
+        addResult(current[table_index[(size_t)match.home_team]],
+                  current[table_index[(size_t)match.guest_team]],
+                  match.home_goals, match.guest_goals);
+    }
+
+    // the score matrix of estimate() without truncation
+    const size_t fixture_count = (size_t)fixtures.size();
+    std::vector<ScoreSampler> samplers(fixture_count);
+    std::vector<std::pair<uint32_t, uint32_t>> fixture_rows(fixture_count);
+    for (size_t f = 0; f < fixture_count; ++f) {
+        const auto& fixture = fixtures[(std::ptrdiff_t)f];
+        float home_ev, guest_ev;
+        estimator.expectedGoals(fixture.first, fixture.second, context,
+                                home_ev, guest_ev);
+        ScoreMatrix scores;
+        FillScoreMatrix(scores, home_ev, guest_ev, context.correction);
+        samplers[f].build(scores);
+        fixture_rows[f] = {table_index[(size_t)fixture.first],
+                           table_index[(size_t)fixture.second]};
+    }
+
+    // every task reduces its seasons locally and adds them atomically
+    std::vector<std::atomic<uint64_t>> position_counts(team_count * team_count);
+    std::vector<std::atomic<uint64_t>> most_goals_counts(team_count);
+    std::vector<std::atomic<uint64_t>> point_sums(team_count);
+    for (auto& count : position_counts) count = 0;
+    for (auto& count : most_goals_counts) count = 0;
+    for (auto& sum : point_sums) sum = 0;
+
+    const uint64_t season_count = settings.season_count;
+    const size_t task_count =
+        (size_t)((season_count + SEASONS_PER_TASK - 1) / SEASONS_PER_TASK);
+    m_pool->run(task_count, [&](size_t task) {
+        std::vector<uint32_t> positions(team_count * team_count, 0);
+        std::vector<uint32_t> most_goals(team_count, 0);
+        std::vector<uint64_t> points(team_count, 0);
+        std::vector<TableRow> table;
+        std::vector<std::pair<uint64_t, uint32_t>> ranking(team_count);
+
+        const uint64_t first = task * SEASONS_PER_TASK;
+        const uint64_t last = std::min(season_count, first + SEASONS_PER_TASK);
+        for (uint64_t season = first; season < last; ++season) {
+            CounterRng rng(settings.seed, season);
+            table = current;
+            for (size_t f = 0; f < fixture_count; ++f) {
+                const size_t score = samplers[f].sample(rng.next());
+                addResult(table[fixture_rows[f].first],
+                          table[fixture_rows[f].second],
+                          ScoreSampler::homeGoals(score),
+                          ScoreSampler::guestGoals(score));
+            }
+
+            // points, goal difference, goals, then a random tie break
+            int max_goals = 0;
+            for (size_t t = 0; t < team_count; ++t) {
+                const auto& row = table[t];
+                const uint64_t key =
+                    (uint64_t)row.points << 48 |
+                    (uint64_t)(row.goals - row.against + 32768) << 32 |
+                    (uint64_t)row.goals << 16 | (rng.next() & 0xFFFF);
+                ranking[t] = {key, (uint32_t)t};
+                points[t] += (uint64_t)row.points;
+                max_goals = std::max(max_goals, row.goals);
+            }
+            std::sort(ranking.begin(), ranking.end(),
+                      [](const std::pair<uint64_t, uint32_t>& a,
+                         const std::pair<uint64_t, uint32_t>& b) {
+                          return a.first > b.first ||
+                                 (a.first == b.first && a.second < b.second);
+                      });
+            for (size_t p = 0; p < team_count; ++p)
+                ++positions[ranking[p].second * team_count + p];
+            for (size_t t = 0; t < team_count; ++t)
+                most_goals[t] += table[t].goals == max_goals ? 1 : 0;
+        }
+
+        for (size_t i = 0; i < positions.size(); ++i) {
+            if (positions[i] > 0) position_counts[i] += positions[i];
+        }
+        for (size_t t = 0; t < team_count; ++t) {
+            most_goals_counts[t] += most_goals[t];
+            point_sums[t] += points[t];
+        }
+    });
+
+    out.season_count = season_count;
+    out.position_counts.assign(position_counts.begin(), position_counts.end());
+    out.most_goals_counts.assign(most_goals_counts.begin(),
+                                 most_goals_counts.end());
+    for (size_t t = 0; t < team_count; ++t) {
+        out.expected_points.push_back(
+            season_count > 0 ? (double)point_sums[t] / (double)season_count
+                             : 0.0);
+    }
+    return true;
+}
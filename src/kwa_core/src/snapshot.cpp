@@ -0,0 +1,314 @@
+#include "kwa_core.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+/*
+ * Snapshot file layout, all values in native byte order:
+ *
+ *   SnapshotHeader
+ *   BlockEntry[block_count]     offset and byte size of every block
+ *   blocks                      each block starts 8 byte aligned
+ *
+ * The blocks are raw arrays in the order of the Block enum below. Per team
+ * columns of StatsProvider are stored as one values array of all teams plus
+ * an offsets array with team_count + 1 entries.
+ */
+namespace {
+const char SNAPSHOT_MAGIC[8] = {'K', 'W', 'A', 'S', 'N', 'A', 'P', '\0'};
+const uint32_t SNAPSHOT_VERSION = 3;
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t block_count;
+    /// goal cap the statistics have been built with
+    int32_t goal_cap;
+};
+
+struct BlockEntry
+{
+    uint64_t offset;
+    uint64_t size;
+};
+
+uint64_t alignBlock(uint64_t offset)
+{
+    return (offset + 7) & ~uint64_t(7);
+}
+
+/**
+ * Gives typed access to the blocks of a mapped snapshot file.
+ */
+class BlockReader
+{
+public:
+    BlockReader(const kwa::MappedFile& file, std::vector<BlockEntry> entries)
+        : m_file(file), m_entries(std::move(entries))
+    {}
+
+    /**
+     * Returns the block as array of T. Marks the reader invalid and returns
+     * an empty span if the block size is not a multiple of sizeof(T).
+     */
+    template<typename T>
+    gsl::span<const T> block(uint32_t index)
+    {
+        auto& entry = m_entries[index];
+        if (entry.size % sizeof(T) != 0) {
+            m_valid = false;
+            return {};
+        }
+        return {reinterpret_cast<const T*>(m_file.data() + entry.offset),
+                (std::ptrdiff_t)(entry.size / sizeof(T))};
+    }
+
+    bool valid() const { return m_valid; }
+
+private:
+    const kwa::MappedFile& m_file;
+    std::vector<BlockEntry> m_entries;
+    bool m_valid = true;
+};
+
+bool checkOffsets(gsl::span<const uint32_t> offsets, size_t team_count,
+                  size_t value_count)
+{
+    if ((size_t)offsets.size() != team_count + 1) return false;
+    if (offsets[0] != 0 || offsets[offsets.size() - 1] != value_count)
+        return false;
+    return std::is_sorted(offsets.begin(), offsets.end());
+}
+} // namespace
+
+namespace kwa {
+struct SnapshotAccess
+{
+    using PerTeamData = StatsProvider::PerTeamData;
+    using Column = std::vector<int> PerTeamData::*;
+
+    static constexpr Column columns[] = {
+        &PerTeamData::home_goals, &PerTeamData::home_against, &PerTeamData::away_goals,
+        &PerTeamData::away_against, &PerTeamData::home_dates, &PerTeamData::guest_dates,
+        &PerTeamData::total_goals,  &PerTeamData::total_against, &PerTeamData::total_dates,
+    };
+    static constexpr size_t column_count = sizeof(columns) / sizeof(columns[0]);
+
+    enum Block : uint32_t
+    {
+        MATCHES = 0,
+        TEAM_NAME_OFFSETS,
+        TEAM_NAMES,
+        TEAM_COLUMNS,
+        OVERALL_COLUMNS = TEAM_COLUMNS + 2 * column_count,
+        BLOCK_COUNT = OVERALL_COLUMNS + column_count,
+    };
+
+    static bool save(const MatchEstimator& estimator, const char* file_name);
+    static bool load(MatchEstimator& estimator, const char* file_name);
+
+    /**
+     * Checks that the goals, against and dates columns of every location have
+     * the same length, i.e. one entry per match.
+     */
+    static bool hasConsistentColumns(const PerTeamData& data)
+    {
+        auto same_size = [](const std::vector<int>& goals,
+                            const std::vector<int>& against,
+                            const std::vector<int>& dates) {
+            return goals.size() == against.size() &&
+                   goals.size() == dates.size();
+        };
+        return same_size(data.home_goals, data.home_against, data.home_dates) &&
+               same_size(data.away_goals, data.away_against, data.guest_dates) &&
+               same_size(data.total_goals, data.total_against, data.total_dates) &&
+               data.total_goals.size() ==
+                   data.home_goals.size() + data.away_goals.size();
+    }
+};
+
+constexpr SnapshotAccess::Column SnapshotAccess::columns[];
+} // namespace kwa
+
+bool kwa::SnapshotAccess::save(const MatchEstimator& estimator,
+                               const char* file_name)
+{
+    const auto& stats = estimator.m_team_statistics;
+    const auto& team_register = estimator.m_team_register;
+    if (estimator.m_requires_rebuild ||
+        estimator.m_matches.size() != stats.matchCount())
+        return false;
+
+    struct BlockData
+    {
+        const void* data;
+        uint64_t size;
+    };
+    std::vector<BlockData> blocks(BLOCK_COUNT);
+    auto set_block = [&blocks](uint32_t block, const auto& vec) {
+        blocks[block] = {vec.data(), vec.size() * sizeof(vec[0])};
+    };
+
+    set_block(MATCHES, estimator.m_matches);
+
+    std::vector<uint32_t> name_offsets{0};
+    std::vector<char> names;
+    for (size_t i = 0; i < team_register.size(); ++i) {
+        auto name = team_register.teamName((TeamId)i);
+        names.insert(names.end(), name.begin(), name.end());
+        name_offsets.push_back((uint32_t)names.size());
+    }
+    set_block(TEAM_NAME_OFFSETS, name_offsets);
+    set_block(TEAM_NAMES, names);
+
+    std::vector<std::vector<uint32_t>> column_offsets(column_count);
+    std::vector<std::vector<int>> column_values(column_count);
+    for (size_t c = 0; c < column_count; ++c) {
+        column_offsets[c].push_back(0);
+        for (auto& team : stats.m_team_data) {
+            auto& column = team.*columns[c];
+            column_values[c].insert(column_values[c].end(), column.begin(),
+                                    column.end());
+            column_offsets[c].push_back((uint32_t)column_values[c].size());
+        }
+        set_block(TEAM_COLUMNS + 2 * (uint32_t)c, column_offsets[c]);
+        set_block(TEAM_COLUMNS + 2 * (uint32_t)c + 1, column_values[c]);
+        set_block(OVERALL_COLUMNS + (uint32_t)c,
+                  stats.m_overall_stats.*columns[c]);
+    }
+
+    SnapshotHeader header;
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.block_count = BLOCK_COUNT;
+    header.goal_cap = estimator.m_goal_cap;
+
+    std::vector<BlockEntry> entries(BLOCK_COUNT);
+    uint64_t offset = sizeof(SnapshotHeader) + BLOCK_COUNT * sizeof(BlockEntry);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        offset = alignBlock(offset);
+        entries[i] = {offset, blocks[i].size};
+        offset += blocks[i].size;
+    }
+
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    const char padding[8] = {};
+    uint64_t written = 0;
+    auto write = [&file, &written](const void* data, uint64_t size) {
+        file.write(static_cast<const char*>(data), (std::streamsize)size);
+        written += size;
+    };
+    write(&header, sizeof(header));
+    write(entries.data(), entries.size() * sizeof(BlockEntry));
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        write(padding, entries[i].offset - written);
+        write(blocks[i].data, blocks[i].size);
+    }
+
+    return file.good();
+}
+
+bool kwa::SnapshotAccess::load(MatchEstimator& estimator,
+                               const char* file_name)
+{
+    MappedFile file;
+    if (!file.open(file_name)) return false;
+    if (file.size() < sizeof(SnapshotHeader)) return false;
+
+    SnapshotHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+        return false;
+    if (header.version != SNAPSHOT_VERSION) return false;
+    if (header.byte_order != SNAPSHOT_BYTE_ORDER) return false;
+    if (header.block_count != BLOCK_COUNT) return false;
+    if (file.size() <
+        sizeof(SnapshotHeader) + BLOCK_COUNT * sizeof(BlockEntry))
+        return false;
+
+    std::vector<BlockEntry> entries(BLOCK_COUNT);
+    std::memcpy(entries.data(), file.data() + sizeof(SnapshotHeader),
+                BLOCK_COUNT * sizeof(BlockEntry));
+    for (auto& entry : entries) {
+        if (entry.offset % 8 != 0 || entry.offset > file.size() ||
+            entry.size > file.size() - entry.offset)
+            return false;
+    }
+
+    BlockReader reader(file, std::move(entries));
+    auto matches = reader.block<MatchData>(MATCHES);
+    auto name_offsets = reader.block<uint32_t>(TEAM_NAME_OFFSETS);
+    auto names = reader.block<char>(TEAM_NAMES);
+    if (!reader.valid() || name_offsets.size() == 0) return false;
+
+    const size_t team_count = (size_t)name_offsets.size() - 1;
+    if (!checkOffsets(name_offsets, team_count, (size_t)names.size()))
+        return false;
+    for (const auto& match : matches) {
+        if (match.home_team < 0 || (size_t)match.home_team >= team_count ||
+            match.guest_team < 0 || (size_t)match.guest_team >= team_count)
+            return false;
+    }
+
+    TeamRegister team_register;
+    for (size_t i = 0; i < team_count; ++i) {
+        auto first = names.data() + name_offsets[(std::ptrdiff_t)i];
+        auto last = names.data() + name_offsets[(std::ptrdiff_t)i + 1];
+        auto id = team_register.registerTeam(
+            gsl::cstring_span<>(first, last - first));
+        if ((size_t)id != i) return false;
+    }
+
+    StatsProvider stats(team_count);
+    for (size_t c = 0; c < column_count; ++c) {
+        auto offsets = reader.block<uint32_t>(TEAM_COLUMNS + 2 * (uint32_t)c);
+        auto values = reader.block<int>(TEAM_COLUMNS + 2 * (uint32_t)c + 1);
+        auto overall = reader.block<int>(OVERALL_COLUMNS + (uint32_t)c);
+        if (!reader.valid() ||
+            !checkOffsets(offsets, team_count, (size_t)values.size()))
+            return false;
+
+        for (size_t t = 0; t < team_count; ++t) {
+            (stats.m_team_data[t].*columns[c])
+                .assign(values.data() + offsets[(std::ptrdiff_t)t],
+                        values.data() + offsets[(std::ptrdiff_t)t + 1]);
+        }
+        (stats.m_overall_stats.*columns[c]).assign(overall.begin(),
+                                                   overall.end());
+    }
+    for (const auto& team : stats.m_team_data) {
+        if (!hasConsistentColumns(team)) return false;
+    }
+    const auto& overall = stats.m_overall_stats;
+    if (overall.home_against.size() != overall.home_goals.size() ||
+        overall.home_dates.size() != overall.home_goals.size())
+        return false;
+    if (stats.matchCount() != (size_t)matches.size()) return false;
+    stats.rebuildDateIndexes();
+
+    estimator.m_matches.assign(matches.begin(), matches.end());
+    estimator.m_team_register = std::move(team_register);
+    estimator.m_team_statistics = std::move(stats);
+    estimator.m_goal_cap = header.goal_cap;
+    estimator.m_requires_rebuild = false;
+    estimator.resetCaches();
+    return true;
+}
+
+bool kwa::saveSnapshot(const MatchEstimator& estimator, const char* file_name)
+{
+    return SnapshotAccess::save(estimator, file_name);
+}
+
+bool kwa::loadSnapshot(MatchEstimator& estimator, const char* file_name)
+{
+    return SnapshotAccess::load(estimator, file_name);
+}
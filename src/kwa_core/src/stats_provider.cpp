@@ -1,6 +1,41 @@
 #include "stats_provider.h"
 
-void kwa::StatsProvider::clear() { m_team_data.clear(); }
+namespace {
+/**
+ * Returns the sum of the values in [begin, end) from their prefix sums.
+ */
+int rangeSum(const std::vector<int>& prefix_sums, size_t begin, size_t end)
+{
+    assert(begin < end && end <= prefix_sums.size());
+    return prefix_sums[end - 1] - (begin > 0 ? prefix_sums[begin - 1] : 0);
+}
+
+/**
+ * Fills one location of out with the matches in [begin, end) of prefix summed
+ * goals. Returns the number of matches or -1 if the range is empty.
+ */
+int fillTeamStats(const std::vector<int>& goals,
+                  const std::vector<int>& against, size_t begin, size_t end,
+                  kwa::TeamStats::eLocation location, kwa::TeamStats& out)
+{
+    if (begin >= end) return -1;
+
+    int count = static_cast<int>(end - begin);
+    out.goal_avg[location] = (float)rangeSum(goals, begin, end) / (float)count;
+    out.against_avg[location] =
+        (float)rangeSum(against, begin, end) / (float)count;
+    out.match_count[location] = (float)count;
+
+    return count;
+}
+} // namespace
+
+void kwa::StatsProvider::clear()
+{
+    m_team_data.clear();
+    m_overall_stats = PerTeamData{};
+    m_league_index.clear();
+}
 void kwa::StatsProvider::setTeamCount(size_t team_count)
 {
     m_team_data.resize(team_count);
@@ -15,6 +50,8 @@ void kwa::StatsProvider::addMatches(gsl::span<const MatchData> matches,
                                     int goal_cap)
 {
     auto& overall = m_overall_stats;
+    assert(matches.size() == 0 || overall.home_dates.empty() ||
+           overall.home_dates.back() <= matches[0].day);
 
     for (auto& m : matches) {
         registerTeam(m.home_team);
@@ -33,14 +70,27 @@ void kwa::StatsProvider::addMatches(gsl::span<const MatchData> matches,
 
         add_summed(home.home_goals, home_goals);
         add_summed(home.home_against, guest_goals);
+        home.home_index.append(m.day, home.home_dates.size());
         home.home_dates.push_back(m.day);
 
         add_summed(guest.away_goals, guest_goals);
         add_summed(guest.away_against, home_goals);
+        guest.guest_index.append(m.day, guest.guest_dates.size());
         guest.guest_dates.push_back(m.day);
 
+        add_summed(home.total_goals, home_goals);
+        add_summed(home.total_against, guest_goals);
+        home.total_index.append(m.day, home.total_dates.size());
+        home.total_dates.push_back(m.day);
+
+        add_summed(guest.total_goals, guest_goals);
+        add_summed(guest.total_against, home_goals);
+        guest.total_index.append(m.day, guest.total_dates.size());
+        guest.total_dates.push_back(m.day);
+
         add_summed(overall.home_goals, home_goals);
         add_summed(overall.home_against, guest_goals);
+        m_league_index.append(m.day, overall.home_dates.size());
         overall.home_dates.push_back(m.day);
     }
 }
@@ -50,10 +100,7 @@ bool kwa::StatsProvider::hasHomeStats(TeamId team, int max_date) const
     if ((size_t)team >= m_team_data.size()) return false;
     auto& team_data = getTeamData(team);
     if (max_date < 0) return team_data.home_goals.size() > 0;
-    auto it = std::lower_bound(team_data.home_dates.begin(),
-                               team_data.home_dates.end(), max_date);
-
-    return (it != team_data.home_dates.begin());
+    return team_data.home_index.lowerBound(team_data.home_dates, max_date) > 0;
 }
 
 bool kwa::StatsProvider::hasGuestStats(TeamId team, int max_date) const
@@ -61,10 +108,8 @@ bool kwa::StatsProvider::hasGuestStats(TeamId team, int max_date) const
     if ((size_t)team >= m_team_data.size()) return false;
     auto& team_data = getTeamData(team);
     if (max_date < 0) return team_data.away_goals.size() > 0;
-    auto it = std::lower_bound(team_data.guest_dates.begin(),
-                               team_data.guest_dates.end(), max_date);
-
-    return (it != team_data.guest_dates.begin());
+    return team_data.guest_index.lowerBound(team_data.guest_dates, max_date) >
+           0;
 }
 
 int kwa::StatsProvider::getHomeStats(TeamId team, TeamStats& out) const
@@ -200,13 +245,11 @@ int kwa::StatsProvider::getLeagueStatsBefore(int before_date,
 {
     auto& team_data = m_overall_stats;
     assert(team_data.home_goals.size() > 0);
-    auto it = std::lower_bound(team_data.home_dates.begin(),
-                               team_data.home_dates.end(), before_date);
-
-    auto distance = std::distance(team_data.home_dates.begin(), it);
-    if (distance < 2) return -1;
+    auto distance =
+        m_league_index.lowerBound(team_data.home_dates, before_date);
+    if (distance < 1) return -1;
 
-    size_t last_match = static_cast<size_t>(distance - 2);
+    size_t last_match = static_cast<size_t>(distance - 1);
 
     int sum_goals = num_matches > last_match
                         ? team_data.home_goals[last_match]
@@ -233,14 +276,12 @@ int kwa::StatsProvider::getLeagueStatsBefore(int before_date,
 {
     auto& team_data = m_overall_stats;
     assert(team_data.home_goals.size() > 0);
-    auto it = std::lower_bound(team_data.home_dates.begin(),
-                               team_data.home_dates.end(), before_date);
-
-    auto distance = std::distance(team_data.home_dates.begin(), it);
-    if (distance < 2) return -1;
+    auto distance =
+        m_league_index.lowerBound(team_data.home_dates, before_date);
+    if (distance < 1) return -1;
 
-    size_t last_match = static_cast<size_t>(distance - 2);
-    int count = static_cast<int>(distance - 1);
+    size_t last_match = static_cast<size_t>(distance - 1);
+    int count = static_cast<int>(distance);
 
     int sum_goals = team_data.home_goals[last_match];
     int sum_against = team_data.home_against[last_match];
@@ -261,10 +302,8 @@ int kwa::StatsProvider::getHomeStatsBefore(TeamId team, int before_date,
     auto& team_data = getTeamData(team);
     assert(team_data.home_goals.size() > 0);
 
-    auto it = std::lower_bound(team_data.home_dates.begin(),
-                               team_data.home_dates.end(), before_date);
-
-    auto distance = std::distance(team_data.home_dates.begin(), it);
+    auto distance =
+        team_data.home_index.lowerBound(team_data.home_dates, before_date);
     if (distance < 1) return -1;
 
     size_t last_match = static_cast<size_t>(distance - 1);
@@ -294,10 +333,8 @@ int kwa::StatsProvider::getGuestStatsBefore(TeamId team, int before_date,
     auto& team_data = getTeamData(team);
     assert(team_data.away_goals.size() > 0);
 
-    auto it = std::lower_bound(team_data.guest_dates.begin(),
-                               team_data.guest_dates.end(), before_date);
-
-    auto distance = std::distance(team_data.guest_dates.begin(), it);
+    auto distance =
+        team_data.guest_index.lowerBound(team_data.guest_dates, before_date);
     if (distance < 1) return -1;
 
     size_t last_match = static_cast<size_t>(distance - 1);
@@ -326,10 +363,8 @@ int kwa::StatsProvider::getHomeStatsBefore(TeamId team, int before_date,
     auto& team_data = getTeamData(team);
     assert(team_data.home_goals.size() > 0);
 
-    auto it = std::lower_bound(team_data.home_dates.begin(),
-                               team_data.home_dates.end(), before_date);
-
-    auto distance = std::distance(team_data.home_dates.begin(), it);
+    auto distance =
+        team_data.home_index.lowerBound(team_data.home_dates, before_date);
     if (distance < 1) return -1;
 
     size_t last_match = static_cast<size_t>(distance - 1);
@@ -351,10 +386,8 @@ int kwa::StatsProvider::getGuestStatsBefore(TeamId team, int before_date,
     auto& team_data = getTeamData(team);
     assert(team_data.away_goals.size() > 0);
 
-    auto it = std::lower_bound(team_data.guest_dates.begin(),
-                               team_data.guest_dates.end(), before_date);
-
-    auto distance = std::distance(team_data.guest_dates.begin(), it);
+    auto distance =
+        team_data.guest_index.lowerBound(team_data.guest_dates, before_date);
     if (distance < 1) return -1;
 
     size_t last_match = static_cast<size_t>(distance - 1);
@@ -370,6 +403,148 @@ int kwa::StatsProvider::getGuestStatsBefore(TeamId team, int before_date,
     return count;
 }
 
+bool kwa::StatsProvider::hasHomeStatsBetween(TeamId team, int from_date,
+                                             int to_date) const
+{
+    if ((size_t)team >= m_team_data.size()) return false;
+    auto& team_data = getTeamData(team);
+    return team_data.home_index.lowerBound(team_data.home_dates, from_date) <
+           countBefore(team_data.home_index, team_data.home_dates, to_date);
+}
+
+bool kwa::StatsProvider::hasGuestStatsBetween(TeamId team, int from_date,
+                                              int to_date) const
+{
+    if ((size_t)team >= m_team_data.size()) return false;
+    auto& team_data = getTeamData(team);
+    return team_data.guest_index.lowerBound(team_data.guest_dates,
+                                            from_date) <
+           countBefore(team_data.guest_index, team_data.guest_dates, to_date);
+}
+
+int kwa::StatsProvider::getHomeStatsBetween(TeamId team, int from_date,
+                                            int to_date, TeamStats& out) const
+{
+    auto& team_data = getTeamData(team);
+    size_t begin =
+        team_data.home_index.lowerBound(team_data.home_dates, from_date);
+    size_t end =
+        countBefore(team_data.home_index, team_data.home_dates, to_date);
+    return fillTeamStats(team_data.home_goals, team_data.home_against, begin,
+                         end, TeamStats::HOME, out);
+}
+
+int kwa::StatsProvider::getGuestStatsBetween(TeamId team, int from_date,
+                                             int to_date, TeamStats& out) const
+{
+    auto& team_data = getTeamData(team);
+    size_t begin =
+        team_data.guest_index.lowerBound(team_data.guest_dates, from_date);
+    size_t end =
+        countBefore(team_data.guest_index, team_data.guest_dates, to_date);
+    return fillTeamStats(team_data.away_goals, team_data.away_against, begin,
+                         end, TeamStats::AWAY, out);
+}
+
+int kwa::StatsProvider::getLeagueStatsBetween(int from_date, int to_date,
+                                              LeagueStats& out) const
+{
+    auto& team_data = m_overall_stats;
+    size_t begin = m_league_index.lowerBound(team_data.home_dates, from_date);
+    size_t end = countBefore(m_league_index, team_data.home_dates, to_date);
+    if (begin >= end) return -1;
+
+    int count = static_cast<int>(end - begin);
+    int sum_goals = rangeSum(team_data.home_goals, begin, end);
+    int sum_against = rangeSum(team_data.home_against, begin, end);
+
+    out.goal_avg[LeagueStats::HOME] = (float)sum_goals / (float)count;
+    out.goal_avg[LeagueStats::AWAY] = (float)sum_against / (float)count;
+    out.goal_avg[LeagueStats::TOTAL] = 0.5f * (out.goal_avg[LeagueStats::HOME] +
+                                               out.goal_avg[LeagueStats::AWAY]);
+    out.match_count = (float)count;
+
+    return count;
+}
+
+bool kwa::StatsProvider::hasTotalStats(TeamId team, int max_date) const
+{
+    if ((size_t)team >= m_team_data.size()) return false;
+    auto& team_data = getTeamData(team);
+    if (max_date < 0) return team_data.total_goals.size() > 0;
+    return team_data.total_index.lowerBound(team_data.total_dates, max_date) >
+           0;
+}
+
+int kwa::StatsProvider::getTotalStats(TeamId team, TeamStats& out) const
+{
+    auto& team_data = getTeamData(team);
+    assert(team_data.total_goals.size() > 0);
+    return fillTeamStats(team_data.total_goals, team_data.total_against, 0,
+                         team_data.total_goals.size(), TeamStats::TOTAL, out);
+}
+
+int kwa::StatsProvider::getTotalStats(TeamId team, size_t num_matches,
+                                      TeamStats& out) const
+{
+    auto& team_data = getTeamData(team);
+    assert(team_data.total_goals.size() > 0);
+    size_t end = team_data.total_goals.size();
+    size_t begin = num_matches >= end ? 0 : end - num_matches;
+    return fillTeamStats(team_data.total_goals, team_data.total_against, begin,
+                         end, TeamStats::TOTAL, out);
+}
+
+int kwa::StatsProvider::getTotalStatsBefore(TeamId team, int before_date,
+                                            TeamStats& out) const
+{
+    auto& team_data = getTeamData(team);
+    size_t end =
+        team_data.total_index.lowerBound(team_data.total_dates, before_date);
+    return fillTeamStats(team_data.total_goals, team_data.total_against, 0,
+                         end, TeamStats::TOTAL, out);
+}
+
+int kwa::StatsProvider::getTotalStatsBefore(TeamId team, int before_date,
+                                            size_t num_matches,
+                                            TeamStats& out) const
+{
+    auto& team_data = getTeamData(team);
+    size_t end =
+        team_data.total_index.lowerBound(team_data.total_dates, before_date);
+    size_t begin = num_matches >= end ? 0 : end - num_matches;
+    return fillTeamStats(team_data.total_goals, team_data.total_against, begin,
+                         end, TeamStats::TOTAL, out);
+}
+
+int kwa::StatsProvider::getTotalStatsBetween(TeamId team, int from_date,
+                                             int to_date, TeamStats& out) const
+{
+    auto& team_data = getTeamData(team);
+    size_t begin =
+        team_data.total_index.lowerBound(team_data.total_dates, from_date);
+    size_t end =
+        countBefore(team_data.total_index, team_data.total_dates, to_date);
+    return fillTeamStats(team_data.total_goals, team_data.total_against, begin,
+                         end, TeamStats::TOTAL, out);
+}
+
+size_t kwa::StatsProvider::countBefore(const DateIndex& index,
+                                       const std::vector<int>& dates, int date)
+{
+    return date < 0 ? dates.size() : index.lowerBound(dates, date);
+}
+
+void kwa::StatsProvider::rebuildDateIndexes()
+{
+    for (auto& team_data : m_team_data) {
+        team_data.home_index.rebuild(team_data.home_dates);
+        team_data.guest_index.rebuild(team_data.guest_dates);
+        team_data.total_index.rebuild(team_data.total_dates);
+    }
+    m_league_index.rebuild(m_overall_stats.home_dates);
+}
+
 void kwa::StatsProvider::registerTeam(TeamId team_id)
 {
     if ((size_t)team_id >= m_team_data.size())
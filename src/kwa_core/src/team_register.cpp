@@ -1,34 +1,114 @@
 #include "kwa_common.h"
 #include "team_register.h"
+#include <cstring>
+
+namespace {
+constexpr const size_t INITIAL_SLOT_COUNT = 64;
+
+/**
+ * Hashes eight bytes per step, team names are mostly longer than that.
+ */
+uint32_t hashName(gsl::cstring_span<> name)
+{
+    const uint64_t multiplier = 0xff51afd7ed558ccdull;
+    const char* pos = name.data();
+    size_t remaining = (size_t)name.size();
+
+    uint64_t hash = 0x9e3779b97f4a7c15ull ^ remaining;
+    uint64_t word;
+    for (; remaining >= 8; remaining -= 8, pos += 8) {
+        std::memcpy(&word, pos, 8);
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 32;
+    }
+    word = 0;
+    if (remaining > 0) std::memcpy(&word, pos, remaining);
+    hash = (hash ^ word) * multiplier;
+    hash ^= hash >> 29;
+    return (uint32_t)hash;
+}
+} // namespace
 
 auto kwa::TeamRegister::registerTeam(const char* name) -> TeamId
 {
-    auto find_it = m_team_ids_by_name.find(name);
-    if (find_it != m_team_ids_by_name.end()) return find_it->second;
+    return registerTeam(
+        gsl::cstring_span<>(name, (std::ptrdiff_t)std::strlen(name)));
+}
+
+auto kwa::TeamRegister::registerTeam(gsl::cstring_span<> name) -> TeamId
+{
+    // keep the load factor at or below one half
+    if (2 * (size() + 1) > m_slots.size()) grow();
+
+    const uint32_t hash = hashName(name);
+    const size_t slot = findSlot(name, hash);
+    if (m_slots[slot].id != INVALID_TEAM_ID) return m_slots[slot].id;
 
-    TeamId id = static_cast<TeamId>(m_team_names.size());
-    m_team_names.push_back(name);
-    m_team_ids_by_name.emplace(name, id);
+    TeamId id = static_cast<TeamId>(size());
+    m_names.insert(m_names.end(), name.begin(), name.end());
+    m_names.push_back('\0');
+    m_name_offsets.push_back((uint32_t)m_names.size());
+    m_slots[slot] = {hash, id};
     return id;
 }
 
 auto kwa::TeamRegister::getId(const char* name) const -> TeamId
 {
-    auto find_it = m_team_ids_by_name.find(name);
-    if (find_it == m_team_ids_by_name.end()) return INVALID_TEAM_ID;
+    // strlen() is much faster than the character loop of gsl::ensure_z()
+    return getId(gsl::cstring_span<>(name, (std::ptrdiff_t)std::strlen(name)));
+}
 
-    return find_it->second;
+auto kwa::TeamRegister::getId(gsl::cstring_span<> name) const -> TeamId
+{
+    if (m_slots.empty()) return INVALID_TEAM_ID;
+    return m_slots[findSlot(name, hashName(name))].id;
 }
 
-auto kwa::TeamRegister::teamName(TeamId id) const -> const std::string &
+auto kwa::TeamRegister::teamName(TeamId id) const -> gsl::cstring_span<>
 {
     assert(id != INVALID_TEAM_ID);
-    assert(id < (int)m_team_names.size());
-    return m_team_names[(size_t)id];
+    assert(id < (int)size());
+    const uint32_t first = m_name_offsets[(size_t)id];
+    const uint32_t last = m_name_offsets[(size_t)id + 1] - 1;
+    return {m_names.data() + first, (std::ptrdiff_t)(last - first)};
 }
 
 void kwa::TeamRegister::clear()
 {
-    m_team_ids_by_name.clear();
-    m_team_names.clear();
+    m_names.clear();
+    m_name_offsets.assign(1, 0);
+    m_slots.clear();
+}
+
+auto kwa::TeamRegister::findSlot(gsl::cstring_span<> name,
+                                 uint32_t hash) const -> size_t
+{
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        auto& slot = m_slots[i];
+        if (slot.id == INVALID_TEAM_ID) return i;
+        if (slot.hash != hash) continue;
+
+        const uint32_t first = m_name_offsets[(size_t)slot.id];
+        const uint32_t length = m_name_offsets[(size_t)slot.id + 1] - first - 1;
+        if (length == (uint32_t)name.size() &&
+            (length == 0 ||
+             std::memcmp(m_names.data() + first, name.data(), length) == 0))
+            return i;
+    }
+}
+
+void kwa::TeamRegister::grow()
+{
+    std::vector<Slot> slots(
+        m_slots.empty() ? INITIAL_SLOT_COUNT : 2 * m_slots.size(),
+        Slot{0, INVALID_TEAM_ID});
+    const size_t mask = slots.size() - 1;
+    for (auto& slot : m_slots) {
+        if (slot.id == INVALID_TEAM_ID) continue;
+        size_t i = slot.hash & mask;
+        while (slots[i].id != INVALID_TEAM_ID) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+    m_slots = std::move(slots);
 }
@@ -0,0 +1,106 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <cassert>
+
+kwa::ThreadPool::ThreadPool(size_t thread_count)
+{
+    if (thread_count == 0)
+        thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    for (size_t i = 0; i < thread_count; ++i)
+        m_queues.emplace_back(new Queue());
+    // the last queue belongs to the thread calling run()
+    for (size_t i = 0; i + 1 < thread_count; ++i)
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+kwa::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) thread.join();
+}
+
+void kwa::ThreadPool::run(size_t task_count,
+                          const std::function<void(size_t)>& task)
+{
+    if (task_count == 0) return;
+    assert(m_pending == 0);
+
+    m_task = &task;
+    m_pending = task_count;
+    const size_t queue_count = m_queues.size();
+    for (size_t i = 0; i < queue_count; ++i) {
+        const size_t begin = task_count * i / queue_count;
+        const size_t end = task_count * (i + 1) / queue_count;
+        std::lock_guard<std::mutex> lock(m_queues[i]->mutex);
+        for (size_t t = begin; t < end; ++t) m_queues[i]->tasks.push_back(t);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_batch;
+    }
+    m_wake.notify_all();
+
+    runTasks(queue_count - 1);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_pending == 0; });
+    m_task = nullptr;
+}
+
+void kwa::ThreadPool::workerLoop(size_t queue)
+{
+    uint64_t batch = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_batch != batch; });
+            if (m_stop) return;
+            batch = m_batch;
+        }
+        runTasks(queue);
+    }
+}
+
+bool kwa::ThreadPool::takeTask(size_t queue, size_t& out)
+{
+    {
+        auto& own = *m_queues[queue];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            out = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // steal the oldest task of another queue, the owner works from the back
+    const size_t queue_count = m_queues.size();
+    for (size_t i = 1; i < queue_count; ++i) {
+        auto& other = *m_queues[(queue + i) % queue_count];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.tasks.empty()) {
+            out = other.tasks.front();
+            other.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void kwa::ThreadPool::runTasks(size_t queue)
+{
+    size_t task;
+    while (takeTask(queue, task)) {
+        (*m_task)(task);
+        if (--m_pending == 0) {
+            // lock so run() cannot miss the notification
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done.notify_all();
+        }
+    }
+}
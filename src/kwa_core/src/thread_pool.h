@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kwa {
+/**
+ * Fixed set of worker threads running batches of indexed tasks. Every worker
+ * owns a queue of task indices, a batch is split into contiguous ranges, one
+ * per queue. Workers take tasks from the back of their own queue and steal
+ * from the front of the others' once it is empty, so uneven tasks (e.g.
+ * matchdays with more history) keep all threads busy.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * Starts thread_count - 1 workers, the thread calling run() is the last
+     * one. 0 uses as many threads as there are cores.
+     */
+    explicit ThreadPool(size_t thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t threadCount() const { return m_queues.size(); }
+
+    /**
+     * Calls task(i) for all i in [0, task_count) and returns when all calls
+     * are done. Tasks run concurrently in any order. MUST NOT be called from
+     * a task or from several threads at once.
+     */
+    void run(size_t task_count, const std::function<void(size_t)>& task);
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    const std::function<void(size_t)>* m_task = nullptr;
+    std::atomic<size_t> m_pending{0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    uint64_t m_batch = 0;
+    bool m_stop = false;
+
+    void workerLoop(size_t queue);
+    bool takeTask(size_t queue, size_t& out);
+    void runTasks(size_t queue);
+};
+} // namespace kwa
@@ -0,0 +1,262 @@
+#include "tip_optimizer.h"
+#include <algorithm>
+#include <limits>
+#include "score_sampler.h"
+#include "thread_pool.h"
+
+namespace {
+constexpr const uint64_t SCENARIOS_PER_TASK = 256;
+// every pass tries all candidates of all matches once
+constexpr const int MAX_SEARCH_PASSES = 8;
+
+struct Candidate
+{
+    int home_goals;
+    int guest_goals;
+    double ev;
+};
+
+/**
+ * Share of the first place: all of it ahead of the best opponent, an equal
+ * share with the tied opponents.
+ */
+double winShare(float points, float best_opponent, uint32_t tied)
+{
+    if (points > best_opponent) return 1.0;
+    return points == best_opponent ? 1.0 / (double)(tied + 1) : 0.0;
+}
+} // namespace
+
+kwa::TipOptimizer::TipOptimizer(size_t thread_count)
+    : m_pool(new ThreadPool(thread_count))
+{
+}
+
+kwa::TipOptimizer::~TipOptimizer() = default;
+
+bool kwa::TipOptimizer::run(const MatchEstimator& estimator,
+                            gsl::span<const PoolMatch> matches,
+                            const TipOptimizerSettings& settings,
+                            TipOptimizerResult& out)
+{
+    const QueryContext& context = settings.context;
+    const BetSystemPoints& system_points = context.system_points;
+    out = TipOptimizerResult();
+    for (const auto& match : matches) {
+        if (!estimator.hasHomeStatistics(match.home_team, context) ||
+            !estimator.hasGuestStatistics(match.guest_team, context))
+            return false;
+    }
+
+    // one score matrix per match for the sampler and all candidates
+    const size_t match_count = (size_t)matches.size();
+    const size_t candidate_count = std::max<size_t>(
+        1, std::min<size_t>(settings.candidate_count, MAX_POSSIBLE_RESULTS));
+    std::vector<ScoreSampler> samplers(match_count);
+    std::vector<Candidate> candidates(match_count * candidate_count);
+    // crowd tips of all matches, the shares summed up
+    std::vector<CrowdTip> crowd;
+    std::vector<size_t> crowd_offsets(match_count + 1, 0);
+    std::vector<Candidate> tips;
+    for (size_t m = 0; m < match_count; ++m) {
+        const auto& match = matches[(std::ptrdiff_t)m];
+        float home_ev, guest_ev;
+        estimator.expectedGoals(match.home_team, match.guest_team, context,
+                                home_ev, guest_ev);
+        ScoreMatrix scores;
+        FillScoreMatrix(scores, home_ev, guest_ev, context.correction);
+        samplers[m].build(scores);
+
+        tips.clear();
+        for (int i = 0; i < scores.home_size; ++i) {
+            for (int j = 0; j < scores.guest_size; ++j) {
+                const TipOutcome outcome = CalculateTipOutcome(scores, i, j);
+                tips.push_back({i, j, CalculateTipEV(outcome, system_points)});
+            }
+        }
+        std::stable_sort(tips.begin(), tips.end(),
+                         [](const Candidate& a, const Candidate& b) {
+                             return a.ev > b.ev;
+                         });
+        std::copy_n(tips.begin(), candidate_count,
+                    candidates.begin() + (std::ptrdiff_t)(m * candidate_count));
+
+        float share_sum = 0.0f;
+        for (const auto& tip : match.crowd) share_sum += tip.share;
+        if (match.crowd.empty() || share_sum <= 0.0f) {
+            crowd.push_back({tips[0].home_goals, tips[0].guest_goals, 1.0f});
+        } else {
+            float share = 0.0f;
+            for (const auto& tip : match.crowd) {
+                share += tip.share / share_sum;
+                crowd.push_back({tip.home_goals, tip.guest_goals, share});
+            }
+            crowd.back().share = 1.0f;
+        }
+        crowd_offsets[m + 1] = crowd.size();
+    }
+
+    std::vector<float> leads = settings.opponent_leads;
+    if (leads.empty()) leads.assign(settings.opponent_count, 0.0f);
+
+    // simulates the results and the opponents' tips of the scenarios drawn
+    // from the random streams first_stream + s, our points for every
+    // candidate at [(s * match_count + m) * candidate_count + c]
+    const uint64_t scenario_count = settings.scenario_count;
+    const size_t task_count = (size_t)(
+        (scenario_count + SCENARIOS_PER_TASK - 1) / SCENARIOS_PER_TASK);
+    std::vector<float> points(
+        (size_t)scenario_count * match_count * candidate_count);
+    std::vector<float> best_opponent((size_t)scenario_count);
+    std::vector<uint32_t> tied_opponents((size_t)scenario_count);
+    auto simulate = [&](uint64_t first_stream) {
+        m_pool->run(task_count, [&](size_t task) {
+            std::vector<float> crowd_points(crowd.size());
+            const uint64_t first = task * SCENARIOS_PER_TASK;
+            const uint64_t last =
+                std::min(scenario_count, first + SCENARIOS_PER_TASK);
+            for (uint64_t s = first; s < last; ++s) {
+                CounterRng rng(settings.seed, first_stream + s);
+                float* our_points =
+                    points.data() + (size_t)s * match_count * candidate_count;
+                for (size_t m = 0; m < match_count; ++m) {
+                    const size_t cell = samplers[m].sample(rng.next());
+                    const int home_goals = ScoreSampler::homeGoals(cell);
+                    const int guest_goals = ScoreSampler::guestGoals(cell);
+                    for (size_t c = 0; c < candidate_count; ++c) {
+                        const auto& tip = candidates[m * candidate_count + c];
+                        *our_points++ = CalculateTipPoints(
+                            CalculateTipHit(tip.home_goals, tip.guest_goals,
+                                            home_goals, guest_goals),
+                            system_points);
+                    }
+                    for (size_t k = crowd_offsets[m]; k < crowd_offsets[m + 1];
+                         ++k) {
+                        crowd_points[k] = CalculateTipPoints(
+                            CalculateTipHit(crowd[k].home_goals,
+                                            crowd[k].guest_goals, home_goals,
+                                            guest_goals),
+                            system_points);
+                    }
+                }
+
+                float best = -std::numeric_limits<float>::infinity();
+                uint32_t tied = 0;
+                for (float lead : leads) {
+                    float total = lead;
+                    for (size_t m = 0; m < match_count; ++m) {
+                        size_t k = crowd_offsets[m];
+                        if (crowd_offsets[m + 1] - k > 1) {
+                            const float u =
+                                (float)(rng.next() >> 40) / 16777216.0f;
+                            while (crowd[k].share <= u) ++k;
+                        }
+                        total += crowd_points[k];
+                    }
+                    if (total > best) {
+                        best = total;
+                        tied = 1;
+                    } else if (total == best) {
+                        ++tied;
+                    }
+                }
+                best_opponent[(size_t)s] = best;
+                tied_opponents[(size_t)s] = tied;
+            }
+        });
+    };
+    simulate(0);
+
+    // our points of the current tips per scenario, starting with the best
+    // result bets
+    std::vector<size_t> choices(match_count, 0);
+    std::vector<float> totals((size_t)scenario_count, 0.0f);
+    for (size_t s = 0; s < totals.size(); ++s) {
+        for (size_t m = 0; m < match_count; ++m)
+            totals[s] += points[(s * match_count + m) * candidate_count];
+    }
+
+    // win probability of every candidate of a match with all other tips
+    // kept, partial sums per task are added in task order so the result does
+    // not depend on the threads
+    std::vector<double> partial(task_count * candidate_count);
+    std::vector<double> probabilities(candidate_count);
+    auto evaluate = [&](size_t m) {
+        m_pool->run(task_count, [&](size_t task) {
+            double* sums = partial.data() + task * candidate_count;
+            std::fill(sums, sums + candidate_count, 0.0);
+            const uint64_t first = task * SCENARIOS_PER_TASK;
+            const uint64_t last =
+                std::min(scenario_count, first + SCENARIOS_PER_TASK);
+            for (uint64_t s = first; s < last; ++s) {
+                const float* match_points =
+                    points.data() +
+                    ((size_t)s * match_count + m) * candidate_count;
+                const float others =
+                    totals[(size_t)s] - match_points[choices[m]];
+                for (size_t c = 0; c < candidate_count; ++c) {
+                    sums[c] += winShare(others + match_points[c],
+                                        best_opponent[(size_t)s],
+                                        tied_opponents[(size_t)s]);
+                }
+            }
+        });
+        std::fill(probabilities.begin(), probabilities.end(), 0.0);
+        for (size_t task = 0; task < task_count; ++task) {
+            for (size_t c = 0; c < candidate_count; ++c)
+                probabilities[c] += partial[task * candidate_count + c];
+        }
+        for (auto& probability : probabilities)
+            probability /= (double)std::max<uint64_t>(1, scenario_count);
+    };
+
+    for (int pass = 0; pass < MAX_SEARCH_PASSES; ++pass) {
+        bool changed = false;
+        for (size_t m = 0; m < match_count; ++m) {
+            evaluate(m);
+            size_t best = choices[m];
+            for (size_t c = 0; c < candidate_count; ++c) {
+                if (probabilities[c] > probabilities[best]) best = c;
+            }
+            if (best == choices[m]) continue;
+
+            for (size_t s = 0; s < totals.size(); ++s) {
+                const float* match_points =
+                    points.data() + (s * match_count + m) * candidate_count;
+                totals[s] += match_points[best] - match_points[choices[m]];
+            }
+            choices[m] = best;
+            changed = true;
+        }
+        if (!changed) break;
+    }
+
+    // the search picked the tips that did best on its own scenarios, so their
+    // win probability there is too high. The tips and the best result bets
+    // are measured on fresh scenarios of the next streams instead.
+    simulate(scenario_count);
+    auto winProbability = [&](const std::vector<size_t>& tips_of_matches) {
+        double sum = 0.0;
+        for (size_t s = 0; s < (size_t)scenario_count; ++s) {
+            float total = 0.0f;
+            for (size_t m = 0; m < match_count; ++m) {
+                total += points[(s * match_count + m) * candidate_count +
+                                tips_of_matches[m]];
+            }
+            sum += winShare(total, best_opponent[s], tied_opponents[s]);
+        }
+        return sum / (double)std::max<uint64_t>(1, scenario_count);
+    };
+    out.win_probability = winProbability(choices);
+    out.best_bet_win_probability =
+        winProbability(std::vector<size_t>(match_count, 0));
+    for (size_t m = 0; m < match_count; ++m) {
+        const auto& match = matches[(std::ptrdiff_t)m];
+        const auto& tip = candidates[m * candidate_count + choices[m]];
+        out.tips.push_back({match.home_team, match.guest_team, tip.home_goals,
+                            tip.guest_goals});
+        out.expected_points += tip.ev;
+        out.best_bet_expected_points += candidates[m * candidate_count].ev;
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+#include "kwa_core/backtester.h"
+#include "gtest/gtest.h"
+#include "test_league.h"
+
+namespace {
+// three seasons from August to May
+const kwa_test::TestLeague LEAGUE{6, 2015};
+
+TEST(Backtester, calculate_bet_points)
+{
+    const kwa::BetSystemPoints points{4.0f, 3.0f, 2.0f};
+    EXPECT_EQ(4.0f, kwa::CalculateBetPoints(2, 1, 2, 1, points));
+    EXPECT_EQ(3.0f, kwa::CalculateBetPoints(2, 1, 3, 2, points));
+    EXPECT_EQ(3.0f, kwa::CalculateBetPoints(2, 1, 1, 0, points));
+    EXPECT_EQ(2.0f, kwa::CalculateBetPoints(2, 1, 4, 0, points));
+    EXPECT_EQ(4.0f, kwa::CalculateBetPoints(1, 1, 1, 1, points));
+    EXPECT_EQ(2.0f, kwa::CalculateBetPoints(1, 1, 0, 0, points));
+    EXPECT_EQ(0.0f, kwa::CalculateBetPoints(1, 1, 1, 0, points));
+    EXPECT_EQ(0.0f, kwa::CalculateBetPoints(0, 1, 1, 0, points));
+}
+
+TEST(Backtester, equals_single_threaded_replay)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::addLeagueRounds(estimator, 0, 29, LEAGUE);
+    estimator.recalculateTeamStatistics();
+
+    // the way it is done without the backtester
+    kwa::MatchEstimator replay = estimator;
+    kwa::BacktestPoints expected;
+    for (const auto& match : estimator.matches()) {
+        ++expected.match_count;
+        replay.setMaxDate(match.day);
+        auto home = estimator.teamRegister().teamName(match.home_team).data();
+        auto guest = estimator.teamRegister().teamName(match.guest_team).data();
+        if (!replay.hasHomeStatistics(home) || !replay.hasGuestStatistics(guest)) continue;
+
+        kwa::MatchEstimation estimation;
+        replay.estimate(estimation, home, guest);
+        ++expected.bet_count;
+        const float points = kwa::CalculateBetPoints(
+            estimation.best_result_bet_home_goals, estimation.best_result_bet_guest_goals,
+            match.home_goals, match.guest_goals, {4.0f, 3.0f, 2.0f});
+        expected.points += points;
+        expected.result_hits += points == 4.0f ? 1 : 0;
+    }
+
+    for (size_t threads : {1, 4}) {
+        kwa::Backtester backtester(threads);
+        kwa::BacktestResult result;
+        backtester.run(estimator, kwa::BacktestSettings(), result);
+        EXPECT_EQ(expected.match_count, result.total.match_count);
+        EXPECT_EQ(expected.bet_count, result.total.bet_count);
+        EXPECT_FLOAT_EQ(expected.points, result.total.points);
+        EXPECT_EQ(expected.result_hits, result.total.result_hits);
+        EXPECT_GE(result.total.bet_count, result.total.result_hits +
+                                              result.total.difference_hits +
+                                              result.total.tendency_hits);
+    }
+}
+
+TEST(Backtester, splits_seasons_and_teams)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::addLeagueRounds(estimator, 0, 29, LEAGUE);
+    estimator.recalculateTeamStatistics();
+
+    kwa::Backtester backtester(3);
+    kwa::BacktestResult result;
+    backtester.run(estimator, kwa::BacktestSettings(), result);
+    ASSERT_EQ(3, result.seasons.size());
+    EXPECT_EQ(2015, result.seasons[0].season);
+    EXPECT_EQ(2017, result.seasons[2].season);
+
+    float season_points = 0.0f;
+    size_t season_bets = 0;
+    for (const auto& season : result.seasons) {
+        EXPECT_EQ(30, season.points.match_count);
+        season_points += season.points.points;
+        season_bets += season.points.bet_count;
+    }
+    EXPECT_FLOAT_EQ(result.total.points, season_points);
+    EXPECT_EQ(result.total.bet_count, season_bets);
+    // the first matchday has no history
+    EXPECT_LT(result.seasons[0].points.bet_count, 30);
+
+    // every match counts for both teams
+    ASSERT_EQ(estimator.teamRegister().size(), result.teams.size());
+    float team_points = 0.0f;
+    for (const auto& team : result.teams) team_points += team.points;
+    EXPECT_FLOAT_EQ(2.0f * result.total.points, team_points);
+
+    // a date range and calendar years
+    kwa::BacktestSettings settings;
+    settings.first_date = kwa::match_date(2016, 7, 1);
+    settings.last_date = kwa::match_date(2017, 7, 1);
+    settings.season_start_month = 1;
+    backtester.run(estimator, settings, result);
+    ASSERT_EQ(2, result.seasons.size());
+    EXPECT_EQ(2016, result.seasons[0].season);
+    EXPECT_EQ(2017, result.seasons[1].season);
+    EXPECT_EQ(30, result.total.match_count);
+    EXPECT_EQ(30, result.total.bet_count);
+}
+} // namespace
@@ -0,0 +1,101 @@
+#include "kwa_core/batch_estimation.h"
+#include "calculations.h"
+#include "gtest/gtest.h"
+#include <random>
+
+namespace {
+const kwa::BetSystemPoints SYSTEM_POINTS{4.0f, 3.0f, 2.0f};
+
+void expectEqualsSingleEstimations(kwa::eBatchKernel kernel)
+{
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<float> ev_distr(0.2f, 4.0f);
+    std::vector<float> home_evs, guest_evs;
+    // not a multiple of any vector width
+    for (int i = 0; i < 203; ++i) {
+        home_evs.push_back(ev_distr(rng));
+        guest_evs.push_back(ev_distr(rng));
+    }
+
+    kwa::MatchEstimationBatch batch;
+    kwa::EstimateBatch(home_evs, guest_evs, SYSTEM_POINTS, batch, kernel);
+    ASSERT_EQ(home_evs.size(), batch.size());
+
+    for (size_t i = 0; i < home_evs.size(); ++i) {
+        kwa::GoalDistribution home_distr, guest_distr;
+        kwa::FillPoissonDistribution(home_distr, home_evs[i]);
+        kwa::FillPoissonDistribution(guest_distr, guest_evs[i]);
+
+        auto three_way =
+            kwa::CalculateThreeWayBet(home_distr, guest_distr, home_evs[i], guest_evs[i]);
+        EXPECT_NEAR(three_way[0], batch.home_win[i], 1e-5f);
+        EXPECT_NEAR(three_way[1], batch.draw[i], 1e-5f);
+        EXPECT_NEAR(three_way[2], batch.guest_win[i], 1e-5f);
+        float kept_home = 0.0f, kept_guest = 0.0f;
+        for (size_t k = 0; k < home_distr.size(); ++k) {
+            kept_home += home_distr[k];
+            kept_guest += guest_distr[k];
+        }
+        EXPECT_NEAR(1.0f - kept_home * kept_guest, batch.truncation_error[i], 1e-5f);
+
+        auto best_bet = kwa::CalculateBestBet(home_distr, guest_distr, home_evs[i],
+                                              guest_evs[i], SYSTEM_POINTS);
+        EXPECT_NEAR(best_bet.ev, batch.best_result_bet_ev[i], 1e-5f);
+        // rounding may only flip results with equal EV
+        float batch_bet_ev = kwa::CalculateBetEV(
+            batch.best_result_bet_home_goals[i], batch.best_result_bet_guest_goals[i], home_distr,
+            guest_distr, home_evs[i], guest_evs[i], SYSTEM_POINTS);
+        EXPECT_NEAR(best_bet.ev, batch_bet_ev, 1e-5f);
+    }
+}
+
+TEST(BatchEstimation, scalar_kernel)
+{
+    expectEqualsSingleEstimations(kwa::BATCH_KERNEL_SCALAR);
+}
+
+TEST(BatchEstimation, sse2_kernel)
+{
+    if (!kwa::IsBatchKernelSupported(kwa::BATCH_KERNEL_SSE2)) return;
+    expectEqualsSingleEstimations(kwa::BATCH_KERNEL_SSE2);
+}
+
+TEST(BatchEstimation, avx2_kernel)
+{
+    if (!kwa::IsBatchKernelSupported(kwa::BATCH_KERNEL_AVX2)) return;
+    expectEqualsSingleEstimations(kwa::BATCH_KERNEL_AVX2);
+}
+
+TEST(BatchEstimation, correction)
+{
+    const float home_evs[] = {0.4f, 1.3f, 2.7f};
+    const float guest_evs[] = {0.9f, 1.1f, 0.3f};
+    for (float correction : {0.0f, 0.05f, 0.2f}) {
+        kwa::MatchEstimationBatch batch;
+        kwa::EstimateBatch(home_evs, guest_evs, SYSTEM_POINTS, batch, kwa::BATCH_KERNEL_AUTO,
+                           correction);
+        for (size_t i = 0; i < 3; ++i) {
+            kwa::GoalDistribution home_distr, guest_distr;
+            kwa::FillPoissonDistribution(home_distr, home_evs[i]);
+            kwa::FillPoissonDistribution(guest_distr, guest_evs[i]);
+            kwa::ScoreMatrix scores;
+            kwa::FillScoreMatrix(scores, home_distr, guest_distr, home_evs[i], guest_evs[i],
+                                 correction);
+
+            auto three_way = kwa::CalculateThreeWayBet(scores);
+            EXPECT_NEAR(three_way[1], batch.draw[i], 1e-5f);
+            EXPECT_NEAR(kwa::CalculateBestBet(scores, SYSTEM_POINTS).ev,
+                        batch.best_result_bet_ev[i], 1e-5f);
+        }
+    }
+}
+
+TEST(BatchEstimation, auto_kernel_and_empty_input)
+{
+    expectEqualsSingleEstimations(kwa::BATCH_KERNEL_AUTO);
+
+    kwa::MatchEstimationBatch batch;
+    kwa::EstimateBatch({}, {}, SYSTEM_POINTS, batch);
+    EXPECT_EQ(0, batch.size());
+}
+} // namespace
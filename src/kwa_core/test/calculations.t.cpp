@@ -0,0 +1,161 @@
+#include "calculations.h"
+#include "gtest/gtest.h"
+#include <cmath>
+#include <random>
+
+namespace {
+const kwa::BetSystemPoints SYSTEM_POINTS{4.0f, 3.0f, 2.0f};
+
+/**
+ * The former O(N^4) search, CalculateBetEV() for every result.
+ */
+kwa::KicktippBet bruteForceBestBet(const kwa::GoalDistribution& home_distr,
+                                   const kwa::GoalDistribution& guest_distr, float home_ev,
+                                   float guest_ev, int home_cap, int guest_cap)
+{
+    kwa::KicktippBet out{0, 0, 0.0f, 0.0f};
+    for (int i = 0; i < home_cap; ++i) {
+        for (int j = 0; j < guest_cap; ++j) {
+            float ev = kwa::CalculateBetEV(i, j, kwa::make_span(home_distr, home_cap),
+                                           kwa::make_span(guest_distr, guest_cap), home_ev,
+                                           guest_ev, SYSTEM_POINTS);
+            if (ev > out.ev) out = {i, j, ev, 0.0f};
+        }
+    }
+    return out;
+}
+
+TEST(Calculations, best_bet_equals_brute_force)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> ev_distr(0.3f, 3.5f);
+    for (int n = 0; n < 200; ++n) {
+        float home_ev = ev_distr(rng);
+        float guest_ev = ev_distr(rng);
+        int home_cap = n % 3 == 0 ? 6 : (int)kwa::MAX_GOALS + 1;
+        int guest_cap = n % 5 == 0 ? 4 : (int)kwa::MAX_GOALS + 1;
+
+        kwa::GoalDistribution home_distr, guest_distr;
+        kwa::FillPoissonDistribution(home_distr, home_ev);
+        kwa::FillPoissonDistribution(guest_distr, guest_ev);
+
+        auto expected =
+            bruteForceBestBet(home_distr, guest_distr, home_ev, guest_ev, home_cap, guest_cap);
+        auto actual = kwa::CalculateBestBet(home_distr, guest_distr, home_ev, guest_ev,
+                                            SYSTEM_POINTS, home_cap, guest_cap);
+
+        EXPECT_NEAR(expected.ev, actual.ev, 1e-5f);
+        // different summation order may only flip results with equal EV
+        float actual_ev = kwa::CalculateBetEV(
+            actual.home_goals, actual.guest_goals, kwa::make_span(home_distr, home_cap),
+            kwa::make_span(guest_distr, guest_cap), home_ev, guest_ev, SYSTEM_POINTS);
+        EXPECT_NEAR(expected.ev, actual_ev, 1e-5f);
+    }
+}
+
+TEST(Calculations, three_way_bet_from_score_matrix)
+{
+    kwa::GoalDistribution home_distr, guest_distr;
+    kwa::FillPoissonDistribution(home_distr, 1.7f);
+    kwa::FillPoissonDistribution(guest_distr, 0.9f);
+
+    kwa::ScoreMatrix scores;
+    kwa::FillScoreMatrix(scores, home_distr, guest_distr, 1.7f, 0.9f);
+    auto three_way = kwa::CalculateThreeWayBet(scores);
+    auto expected = kwa::CalculateThreeWayBet(home_distr, guest_distr, 1.7f, 0.9f);
+    for (size_t i = 0; i < 3; ++i) EXPECT_FLOAT_EQ(expected[i], three_way[i]);
+
+    // the correction moves probability between the low scores only
+    EXPECT_NEAR(1.0f, three_way[0] + three_way[1] + three_way[2], 1e-3f);
+    EXPECT_FLOAT_EQ(home_distr[0] * guest_distr[0] * (1.0f + 0.1f * 1.7f * 0.9f),
+                    scores.at(0, 0));
+    EXPECT_FLOAT_EQ(home_distr[3] * guest_distr[2], scores.at(3, 2));
+}
+
+TEST(Calculations, tip_hits_follow_kicktipp_rules)
+{
+    EXPECT_EQ(kwa::TIP_RESULT, kwa::CalculateTipHit(2, 1, 2, 1));
+    EXPECT_EQ(kwa::TIP_DIFFERENCE, kwa::CalculateTipHit(2, 1, 3, 2));
+    EXPECT_EQ(kwa::TIP_TENDENCY, kwa::CalculateTipHit(2, 1, 4, 0));
+    EXPECT_EQ(kwa::TIP_TENDENCY, kwa::CalculateTipHit(1, 1, 0, 0));
+    EXPECT_EQ(kwa::TIP_MISS, kwa::CalculateTipHit(1, 1, 1, 0));
+    EXPECT_EQ(kwa::TIP_MISS, kwa::CalculateTipHit(0, 1, 1, 0));
+
+    // the outcomes of a tip give the expected points of CalculateBetEV()
+    kwa::GoalDistribution home_distr, guest_distr;
+    kwa::FillPoissonDistribution(home_distr, 1.7f);
+    kwa::FillPoissonDistribution(guest_distr, 0.9f);
+    kwa::ScoreMatrix scores;
+    kwa::FillScoreMatrix(scores, 1.7f, 0.9f);
+    const kwa::BetSystemPoints points{4.0f, 3.0f, 2.0f};
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            const auto outcome = kwa::CalculateTipOutcome(scores, i, j);
+            EXPECT_NEAR(kwa::CalculateBetEV(i, j, home_distr, guest_distr, 1.7f, 0.9f, points),
+                        kwa::CalculateTipEV(outcome, points), 1e-3f);
+        }
+    }
+}
+
+TEST(Calculations, poisson_distribution)
+{
+    for (float lambda : {0.0f, 0.4f, 1.5f, 3.2f, 7.9f}) {
+        kwa::GoalDistribution distr;
+        kwa::FillPoissonDistribution(distr, lambda);
+        for (int k = 0; k < (int)distr.size(); ++k) {
+            double expected = std::pow((double)lambda, k) * std::exp(-(double)lambda) /
+                              std::tgamma((double)k + 1.0);
+            EXPECT_NEAR(expected, distr[(size_t)k], 1e-6);
+            EXPECT_NEAR(expected, kwa::CalculatePoissonProbability(lambda, k), 1e-6);
+        }
+    }
+    // beyond 12! the former int factorial overflowed
+    EXPECT_NEAR(std::pow(20.0, 20) * std::exp(-20.0) / std::tgamma(21.0),
+                kwa::CalculatePoissonProbability(20.0f, 20), 1e-6);
+}
+
+TEST(Calculations, poisson_cache)
+{
+    kwa::PoissonCache cache(4.0f, 100);
+    kwa::GoalDistribution cached, exact;
+
+    cache.fill(cached, 1.234f);
+    kwa::FillPoissonDistribution(exact, 1.23f);
+    for (size_t k = 0; k < exact.size(); ++k) EXPECT_FLOAT_EQ(exact[k], cached[k]);
+
+    // out of range lambdas are computed
+    cache.fill(cached, 5.5f);
+    kwa::FillPoissonDistribution(exact, 5.5f);
+    for (size_t k = 0; k < exact.size(); ++k) EXPECT_FLOAT_EQ(exact[k], cached[k]);
+}
+
+TEST(Calculations, truncate_distribution)
+{
+    kwa::GoalDistribution distr;
+    kwa::FillPoissonDistribution(distr, 0.8f);
+    const auto full = distr;
+
+    float tail = 0.0f;
+    const int cap = kwa::TruncateDistribution(distr, 1e-3f, tail);
+    ASSERT_LT(cap, (int)distr.size());
+
+    float kept = 0.0f, dropped = 0.0f;
+    for (int k = 0; k < (int)full.size(); ++k) (k < cap ? kept : dropped) += full[(size_t)k];
+    EXPECT_LT(tail, 1e-3f);
+    EXPECT_NEAR(dropped, tail, 1e-6f);
+    // the previous cap would have dropped too much
+    EXPECT_GE(1.0f - (kept - full[(size_t)cap - 1]), 1e-3f);
+
+    float sum = 0.0f;
+    for (int k = 0; k < cap; ++k) {
+        EXPECT_FLOAT_EQ(full[(size_t)k] / kept, distr[(size_t)k]);
+        sum += distr[(size_t)k];
+    }
+    EXPECT_NEAR(1.0f, sum, 1e-6f);
+
+    // a huge epsilon keeps one goal
+    kwa::FillPoissonDistribution(distr, 0.8f);
+    EXPECT_EQ(1, kwa::TruncateDistribution(distr, 1.0f, tail));
+    EXPECT_FLOAT_EQ(1.0f, distr[0]);
+}
+} // namespace
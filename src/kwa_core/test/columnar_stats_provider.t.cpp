@@ -0,0 +1,116 @@
+#include "kwa_core/columnar_stats_provider.h"
+#include "kwa_core/stats_provider.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+
+namespace {
+std::vector<kwa::MatchData> createRandomSeasons(size_t count, int team_count)
+{
+    std::vector<kwa::MatchData> out;
+    for (size_t i = 0; i < count; ++i) {
+        kwa::MatchData m;
+        m.day = kwa::match_date(2000 + std::rand() % 15, 1 + std::rand() % 12, 1 + std::rand() % 28);
+        m.home_team = std::rand() % team_count;
+        m.guest_team = std::rand() % team_count;
+        m.home_goals = std::rand() % 8;
+        m.guest_goals = std::rand() % 6;
+        out.push_back(m);
+    }
+    std::sort(out.begin(), out.end(), [](auto lhs, auto rhs) { return lhs.day < rhs.day; });
+    return out;
+}
+
+template<typename Provider>
+void expectSameStats(const kwa::StatsProvider& expected, const Provider& actual,
+                     gsl::span<const kwa::MatchData> matches, int team_count)
+{
+    ASSERT_EQ(expected.matchCount(), actual.matchCount());
+
+    for (size_t i = 0; i < (size_t)matches.size(); i += 13) {
+        int date = matches[(std::ptrdiff_t)i].day;
+        size_t num_matches = 1 + i % 7;
+
+        kwa::LeagueStats e_league{}, a_league{};
+        int count = expected.getLeagueStatsBefore(date, num_matches, e_league);
+        EXPECT_EQ(count, actual.getLeagueStatsBefore(date, num_matches, a_league));
+        if (count > 0) {
+            EXPECT_FLOAT_EQ(e_league.goal_avg[kwa::LeagueStats::HOME],
+                            a_league.goal_avg[kwa::LeagueStats::HOME]);
+        }
+        count = expected.getLeagueStatsBefore(date, e_league);
+        EXPECT_EQ(count, actual.getLeagueStatsBefore(date, a_league));
+        if (count > 0) {
+            EXPECT_FLOAT_EQ(e_league.goal_avg[kwa::LeagueStats::AWAY],
+                            a_league.goal_avg[kwa::LeagueStats::AWAY]);
+        }
+
+        for (kwa::TeamId team = 0; team < team_count; ++team) {
+            ASSERT_EQ(expected.hasHomeStats(team, date), actual.hasHomeStats(team, date));
+            ASSERT_EQ(expected.hasGuestStats(team, date), actual.hasGuestStats(team, date));
+
+            kwa::TeamStats e, a;
+            if (expected.hasHomeStats(team, date)) {
+                EXPECT_EQ(expected.getHomeStatsBefore(team, date, num_matches, e),
+                          actual.getHomeStatsBefore(team, date, num_matches, a));
+                EXPECT_FLOAT_EQ(e.goal_avg[kwa::TeamStats::HOME], a.goal_avg[kwa::TeamStats::HOME]);
+                EXPECT_FLOAT_EQ(e.against_avg[kwa::TeamStats::HOME],
+                                a.against_avg[kwa::TeamStats::HOME]);
+            }
+            if (expected.hasGuestStats(team, date)) {
+                EXPECT_EQ(expected.getGuestStatsBefore(team, date, e),
+                          actual.getGuestStatsBefore(team, date, a));
+                EXPECT_FLOAT_EQ(e.goal_avg[kwa::TeamStats::AWAY], a.goal_avg[kwa::TeamStats::AWAY]);
+                EXPECT_FLOAT_EQ(e.against_avg[kwa::TeamStats::AWAY],
+                                a.against_avg[kwa::TeamStats::AWAY]);
+            }
+        }
+    }
+
+    for (kwa::TeamId team = 0; team < team_count; ++team) {
+        kwa::TeamStats e, a;
+        if (!expected.hasHomeStats(team)) continue;
+        EXPECT_EQ(expected.getHomeStats(team, 5, e), actual.getHomeStats(team, 5, a));
+        EXPECT_FLOAT_EQ(e.goal_avg[kwa::TeamStats::HOME], a.goal_avg[kwa::TeamStats::HOME]);
+        EXPECT_EQ(expected.getHomeStats(team, e), actual.getHomeStats(team, a));
+        EXPECT_FLOAT_EQ(e.against_avg[kwa::TeamStats::HOME], a.against_avg[kwa::TeamStats::HOME]);
+    }
+}
+
+TEST(ColumnarStatsProvider, constr_is_empty)
+{
+    kwa::ColumnarStatsProvider provider{};
+    EXPECT_EQ(0, provider.matchCount());
+    EXPECT_EQ(0, provider.teamCount());
+    EXPECT_FALSE(provider.hasHomeStats(0));
+}
+
+TEST(ColumnarStatsProvider, same_stats_as_stats_provider)
+{
+    const int team_count = 12;
+    auto matches = createRandomSeasons(600, team_count);
+    kwa::StatsProvider expected{};
+    expected.addMatches(matches, 4);
+
+    kwa::ColumnarStatsProvider columnar{};
+    ASSERT_TRUE(columnar.build(matches, 4));
+    EXPECT_EQ(team_count, columnar.teamCount());
+    expectSameStats(expected, columnar, matches, team_count);
+
+    kwa::CompactStatsProvider compact{};
+    ASSERT_TRUE(compact.build(matches, 4));
+    expectSameStats(expected, compact, matches, team_count);
+    EXPECT_LT(compact.memoryUsage(), columnar.memoryUsage());
+}
+
+TEST(ColumnarStatsProvider, compact_rejects_dates_out_of_range)
+{
+    kwa::MatchData matches[] = {{kwa::match_date(1820, 1, 1), 0, 1, 1, 0},
+                                {kwa::match_date(2016, 1, 1), 0, 1, 1, 0}};
+    kwa::CompactStatsProvider compact{};
+    EXPECT_FALSE(compact.build(matches));
+    EXPECT_EQ(0, compact.matchCount());
+
+    kwa::ColumnarStatsProvider columnar{};
+    EXPECT_TRUE(columnar.build(matches));
+}
+} // namespace
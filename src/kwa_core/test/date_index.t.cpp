@@ -0,0 +1,79 @@
+#include "kwa_core/date_index.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+std::vector<int> createDates(size_t count, std::mt19937& rng)
+{
+    std::vector<int> out;
+    kwa::DayOrdinal day = kwa::match_ordinal(kwa::match_date(1995, 8, 1));
+    for (size_t i = 0; i < count; ++i) {
+        // several matches per day and gaps like a winter break
+        day += rng() % 4 == 0 ? (int)(rng() % 60) : (int)(rng() % 2);
+        out.push_back(kwa::ordinal_match_date(day));
+    }
+    return out;
+}
+
+TEST(DayOrdinal, valid_dates)
+{
+    EXPECT_TRUE(kwa::is_valid_match_date(kwa::match_date(2016, 2, 29)));
+    EXPECT_FALSE(kwa::is_valid_match_date(kwa::match_date(2015, 2, 29)));
+    EXPECT_TRUE(kwa::is_valid_match_date(kwa::match_date(2000, 2, 29)));
+    EXPECT_FALSE(kwa::is_valid_match_date(kwa::match_date(1900, 2, 29)));
+    EXPECT_TRUE(kwa::is_valid_match_date(kwa::match_date(2016, 8, 31)));
+    EXPECT_FALSE(kwa::is_valid_match_date(kwa::match_date(2016, 9, 31)));
+    EXPECT_FALSE(kwa::is_valid_match_date(kwa::match_date(2016, 13, 1)));
+    EXPECT_FALSE(kwa::is_valid_match_date(kwa::match_date(2016, 1, 0)));
+    EXPECT_FALSE(kwa::is_valid_match_date(3));
+}
+
+TEST(DayOrdinal, ordinal_round_trip)
+{
+    for (kwa::DayOrdinal day = -800; day < 25000; day += 7) {
+        int date = kwa::ordinal_match_date(day);
+        ASSERT_TRUE(kwa::is_valid_match_date(date));
+        ASSERT_EQ(day, kwa::match_ordinal(date));
+    }
+}
+
+TEST(DateIndex, lower_bound_equals_binary_search)
+{
+    std::mt19937 rng(5);
+    auto dates = createDates(2000, rng);
+
+    for (int shift : {0, 3, 5}) {
+        kwa::DateIndex index(shift);
+        for (size_t i = 0; i < dates.size(); ++i) index.append(dates[i], i);
+        ASSERT_TRUE(index.isEnabled());
+
+        kwa::DayOrdinal first = kwa::match_ordinal(dates.front()) - 3;
+        kwa::DayOrdinal last = kwa::match_ordinal(dates.back()) + 3;
+        for (kwa::DayOrdinal day = first; day <= last; ++day) {
+            int date = kwa::ordinal_match_date(day);
+            auto expected = std::lower_bound(dates.begin(), dates.end(), date) - dates.begin();
+            ASSERT_EQ((size_t)expected, index.lowerBound(dates, date));
+        }
+        // dates that are no calendar dates are searched
+        int date = kwa::match_date(2001, 2, 30);
+        auto expected = std::lower_bound(dates.begin(), dates.end(), date) - dates.begin();
+        EXPECT_EQ((size_t)expected, index.lowerBound(dates, date));
+    }
+}
+
+TEST(DateIndex, invalid_dates_disable_index)
+{
+    std::vector<int> dates = {3, 5, 5, 9};
+    kwa::DateIndex index(3);
+    index.rebuild(dates);
+    EXPECT_FALSE(index.isEnabled());
+    EXPECT_EQ(1, index.lowerBound(dates, 5));
+    EXPECT_EQ(3, index.lowerBound(dates, 6));
+    EXPECT_EQ(4, index.lowerBound(dates, 10));
+
+    index.clear();
+    EXPECT_TRUE(index.isEnabled());
+    EXPECT_EQ(0, index.lowerBound({}, kwa::match_date(2016, 1, 1)));
+}
+} // namespace
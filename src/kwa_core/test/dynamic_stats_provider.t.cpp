@@ -0,0 +1,173 @@
+#include "kwa_core/dynamic_stats_provider.h"
+#include "kwa_core/stats_provider.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+const int TEAM_COUNT = 8;
+
+/**
+ * At most one match per day, so "before date" and "last n matches" boundaries
+ * never split a day.
+ */
+std::vector<kwa::MatchData> createSeason(size_t count, std::mt19937& rng)
+{
+    std::vector<kwa::MatchData> out;
+    int year = 2015, month = 7, day = 1;
+    for (size_t i = 0; i < count; ++i) {
+        kwa::MatchData match;
+        match.day = kwa::match_date(year, month, day);
+        match.home_team = (int)(rng() % TEAM_COUNT);
+        match.guest_team = (match.home_team + 1 + (int)(rng() % (TEAM_COUNT - 1))) % TEAM_COUNT;
+        match.home_goals = (int)(rng() % 7);
+        match.guest_goals = (int)(rng() % 5);
+        out.push_back(match);
+
+        day += 1 + (int)(rng() % 3);
+        if (day > 28) {
+            day -= 28;
+            year += month / 12;
+            month = month % 12 + 1;
+        }
+    }
+    return out;
+}
+
+void expectEqualStats(const kwa::StatsProvider& expected, const kwa::DynamicStatsProvider& actual,
+                      gsl::span<const kwa::MatchData> matches)
+{
+    ASSERT_EQ(expected.matchCount(), actual.matchCount());
+
+    kwa::LeagueStats expected_league, actual_league;
+    EXPECT_EQ(expected.getLeagueStats(expected_league), actual.getLeagueStats(actual_league));
+    EXPECT_FLOAT_EQ(expected_league.goal_avg[kwa::LeagueStats::HOME],
+                    actual_league.goal_avg[kwa::LeagueStats::HOME]);
+    EXPECT_FLOAT_EQ(expected_league.goal_avg[kwa::LeagueStats::AWAY],
+                    actual_league.goal_avg[kwa::LeagueStats::AWAY]);
+
+    for (kwa::TeamId team = 0; team < TEAM_COUNT; ++team) {
+        for (auto& m : matches) {
+            ASSERT_EQ(expected.hasHomeStats(team, m.day), actual.hasHomeStats(team, m.day));
+            ASSERT_EQ(expected.hasGuestStats(team, m.day), actual.hasGuestStats(team, m.day));
+
+            kwa::TeamStats e, a;
+            if (expected.hasHomeStats(team, m.day)) {
+                EXPECT_EQ(expected.getHomeStatsBefore(team, m.day, e),
+                          actual.getHomeStatsBefore(team, m.day, a));
+                EXPECT_FLOAT_EQ(e.goal_avg[kwa::TeamStats::HOME], a.goal_avg[kwa::TeamStats::HOME]);
+                EXPECT_FLOAT_EQ(e.against_avg[kwa::TeamStats::HOME],
+                                a.against_avg[kwa::TeamStats::HOME]);
+
+                EXPECT_EQ(expected.getHomeStatsBefore(team, m.day, 3, e),
+                          actual.getHomeStatsBefore(team, m.day, 3, a));
+                EXPECT_FLOAT_EQ(e.goal_avg[kwa::TeamStats::HOME], a.goal_avg[kwa::TeamStats::HOME]);
+            }
+            if (expected.hasGuestStats(team, m.day)) {
+                EXPECT_EQ(expected.getGuestStatsBefore(team, m.day, e),
+                          actual.getGuestStatsBefore(team, m.day, a));
+                EXPECT_FLOAT_EQ(e.goal_avg[kwa::TeamStats::AWAY], a.goal_avg[kwa::TeamStats::AWAY]);
+                EXPECT_FLOAT_EQ(e.against_avg[kwa::TeamStats::AWAY],
+                                a.against_avg[kwa::TeamStats::AWAY]);
+
+                EXPECT_EQ(expected.getGuestStatsBefore(team, m.day, 2, e),
+                          actual.getGuestStatsBefore(team, m.day, 2, a));
+                EXPECT_FLOAT_EQ(e.against_avg[kwa::TeamStats::AWAY],
+                                a.against_avg[kwa::TeamStats::AWAY]);
+            }
+        }
+    }
+}
+
+TEST(MatchOrdinal, counts_days_since_epoch)
+{
+    EXPECT_EQ(0, kwa::match_ordinal(kwa::match_date(1970, 1, 1)));
+    EXPECT_EQ(-1, kwa::match_ordinal(kwa::match_date(1969, 12, 31)));
+    EXPECT_EQ(2, kwa::match_ordinal(kwa::match_date(2000, 3, 1)) -
+                     kwa::match_ordinal(kwa::match_date(2000, 2, 28)));
+    EXPECT_EQ(365, kwa::match_ordinal(kwa::match_date(2016, 1, 1)) -
+                       kwa::match_ordinal(kwa::match_date(2015, 1, 1)));
+}
+
+TEST(DynamicStatsProvider, constr_is_empty)
+{
+    kwa::DynamicStatsProvider provider{};
+    EXPECT_EQ(0, provider.matchCount());
+    EXPECT_EQ(0, provider.teamCount());
+    EXPECT_FALSE(provider.hasHomeStats(0));
+}
+
+TEST(DynamicStatsProvider, unordered_inserts_equal_sorted_stats_provider)
+{
+    std::mt19937 rng(17);
+    auto matches = createSeason(300, rng);
+
+    kwa::StatsProvider expected{};
+    expected.addMatches(matches, 4);
+
+    auto shuffled = matches;
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+    kwa::DynamicStatsProvider actual{4};
+    actual.addMatches(shuffled);
+
+    expectEqualStats(expected, actual, matches);
+}
+
+TEST(DynamicStatsProvider, corrections_and_removals)
+{
+    std::mt19937 rng(3);
+    auto matches = createSeason(200, rng);
+
+    kwa::DynamicStatsProvider actual{};
+    actual.addMatches(matches);
+
+    // correct some results and remove a postponed match
+    for (size_t i = 0; i < matches.size(); i += 7) {
+        auto corrected = matches[i];
+        corrected.home_goals = (corrected.home_goals + 2) % 6;
+        actual.updateMatch(matches[i], corrected);
+        matches[i] = corrected;
+    }
+    actual.removeMatch(matches[42]);
+    matches.erase(matches.begin() + 42);
+
+    kwa::StatsProvider expected{};
+    expected.addMatches(matches);
+    expectEqualStats(expected, actual, matches);
+}
+
+TEST(DynamicStatsProvider, league_stats_before)
+{
+    kwa::DynamicStatsProvider provider{};
+    kwa::MatchData matches[] = {{kwa::match_date(2016, 1, 3), 1, 2, 3, 1},
+                                {kwa::match_date(2016, 1, 1), 3, 2, 0, 1},
+                                {kwa::match_date(2016, 1, 2), 1, 2, 2, 3}};
+    provider.addMatches(matches);
+
+    kwa::LeagueStats stats;
+    EXPECT_EQ(-1, provider.getLeagueStatsBefore(kwa::match_date(2016, 1, 1), stats));
+    EXPECT_EQ(2, provider.getLeagueStatsBefore(kwa::match_date(2016, 1, 3), stats));
+    EXPECT_FLOAT_EQ(1.0f, stats.goal_avg[kwa::LeagueStats::HOME]);
+    EXPECT_FLOAT_EQ(2.0f, stats.goal_avg[kwa::LeagueStats::AWAY]);
+    EXPECT_FLOAT_EQ(2.0f, stats.match_count);
+}
+
+TEST(DynamicStatsProvider, grows_over_long_date_ranges)
+{
+    kwa::DynamicStatsProvider provider{};
+    kwa::MatchData first{kwa::match_date(2016, 1, 1), 0, 1, 1, 0};
+    kwa::MatchData early{kwa::match_date(1990, 8, 1), 0, 1, 3, 0};
+    kwa::MatchData late{kwa::match_date(2030, 5, 1), 0, 1, 5, 0};
+    provider.addMatch(first);
+    provider.addMatch(late);
+    provider.addMatch(early);
+
+    kwa::TeamStats stats;
+    EXPECT_EQ(3, provider.getHomeStats(0, stats));
+    EXPECT_FLOAT_EQ(3.0f, stats.goal_avg[kwa::TeamStats::HOME]);
+    EXPECT_EQ(2, provider.getHomeStatsBefore(0, kwa::match_date(2030, 5, 1), stats));
+    EXPECT_FLOAT_EQ(2.0f, stats.goal_avg[kwa::TeamStats::HOME]);
+    EXPECT_EQ(1, provider.getHomeStatsBefore(0, kwa::match_date(2030, 5, 1), 1, stats));
+    EXPECT_FLOAT_EQ(1.0f, stats.goal_avg[kwa::TeamStats::HOME]);
+}
+} // namespace
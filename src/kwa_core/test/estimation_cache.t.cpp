@@ -0,0 +1,63 @@
+#include "estimation_cache.h"
+#include "gtest/gtest.h"
+#include <list>
+#include <random>
+
+namespace {
+kwa::MatchEstimation makeEstimation(float ev)
+{
+    kwa::MatchEstimation out{};
+    out.best_result_bet_ev = ev;
+    return out;
+}
+
+TEST(EstimationCache, evicts_least_recently_used)
+{
+    kwa::EstimationCache cache(2);
+    cache.insert({0, 1, -1, -1}, makeEstimation(1.0f));
+    cache.insert({1, 0, -1, -1}, makeEstimation(2.0f));
+    ASSERT_NE(nullptr, cache.find({0, 1, -1, -1}));
+
+    // 1:0 is the least recently used one now
+    cache.insert({0, 1, -1, 20180101}, makeEstimation(3.0f));
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(nullptr, cache.find({1, 0, -1, -1}));
+    ASSERT_NE(nullptr, cache.find({0, 1, -1, -1}));
+    EXPECT_EQ(1.0f, cache.find({0, 1, -1, -1})->best_result_bet_ev);
+    ASSERT_NE(nullptr, cache.find({0, 1, -1, 20180101}));
+    EXPECT_EQ(3.0f, cache.find({0, 1, -1, 20180101})->best_result_bet_ev);
+
+    cache.clear();
+    EXPECT_EQ(0, cache.size());
+    EXPECT_EQ(nullptr, cache.find({0, 1, -1, -1}));
+}
+
+TEST(EstimationCache, equals_reference_lru)
+{
+    const size_t capacity = 37;
+    kwa::EstimationCache cache(capacity);
+    // most recently used first
+    std::list<std::pair<int, float>> reference;
+
+    std::mt19937 rng(5);
+    for (int i = 0; i < 20000; ++i) {
+        const int team = (int)(rng() % 60);
+        const kwa::EstimationCache::Key key{team, team + 1, -1, team % 3};
+
+        auto it = std::find_if(reference.begin(), reference.end(),
+                               [team](auto& entry) { return entry.first == team; });
+        auto cached = cache.find(key);
+        ASSERT_EQ(it != reference.end(), cached != nullptr);
+        if (cached) {
+            EXPECT_EQ(it->second, cached->best_result_bet_ev);
+            reference.splice(reference.begin(), reference, it);
+            continue;
+        }
+
+        cache.insert(key, makeEstimation((float)i));
+        reference.emplace_front(team, (float)i);
+        if (reference.size() > capacity) reference.pop_back();
+        ASSERT_EQ(reference.size(), cache.size());
+    }
+}
+} // namespace
@@ -0,0 +1,80 @@
+#include "estimation_table.h"
+#include "calculations.h"
+#include "kwa_core/match_estimator.h"
+#include "gtest/gtest.h"
+
+namespace {
+const kwa::BetSystemPoints SYSTEM_POINTS{4.0f, 3.0f, 2.0f};
+
+TEST(EstimationTable, grid_nodes_equal_exact_estimations)
+{
+    kwa::EstimationTable table(SYSTEM_POINTS, 3.0f, 10);
+    for (float home_ev : {0.0f, 0.7f, 1.5f, 3.0f}) {
+        for (float guest_ev : {0.2f, 1.1f, 2.4f}) {
+            kwa::GoalDistribution home_distr, guest_distr;
+            kwa::FillPoissonDistribution(home_distr, home_ev);
+            kwa::FillPoissonDistribution(guest_distr, guest_ev);
+            kwa::ScoreMatrix scores;
+            kwa::FillScoreMatrix(scores, home_distr, guest_distr, home_ev, guest_ev);
+            const auto three_way = kwa::CalculateThreeWayBet(scores);
+            const auto best_bet = kwa::CalculateBestBet(scores, SYSTEM_POINTS);
+
+            kwa::EstimationTable::Entry nearest, interpolated;
+            table.lookupNearest(home_ev, guest_ev, nearest);
+            table.lookupInterpolated(home_ev, guest_ev, interpolated);
+            for (auto& entry : {nearest, interpolated}) {
+                for (size_t k = 0; k < 3; ++k) EXPECT_NEAR(three_way[k], entry.three_way[k], 1e-5f);
+                EXPECT_NEAR(best_bet.ev, entry.best_bet_ev, 1e-5f);
+                EXPECT_NEAR(best_bet.ev,
+                            kwa::CalculateBetEV(entry.best_home_goals, entry.best_guest_goals,
+                                                home_distr, guest_distr, home_ev, guest_ev,
+                                                SYSTEM_POINTS),
+                            1e-5f);
+            }
+        }
+    }
+    EXPECT_TRUE(table.contains(3.0f, 0.0f));
+    EXPECT_FALSE(table.contains(3.1f, 1.0f));
+    EXPECT_FALSE(table.contains(1.0f, -0.1f));
+}
+
+TEST(EstimationTable, interpolation_is_more_accurate_than_nearest_node)
+{
+    kwa::EstimationTable table(SYSTEM_POINTS, 4.0f, 20);
+    const auto nearest = table.measureError(false);
+    const auto interpolated = table.measureError(true);
+
+    EXPECT_LT(nearest.three_way, 0.05f);
+    EXPECT_LT(interpolated.three_way, 2e-3f);
+    EXPECT_LT(interpolated.three_way, nearest.three_way);
+    EXPECT_LT(interpolated.best_bet_ev, nearest.best_bet_ev);
+    // both pick the bet of the nearest node
+    EXPECT_EQ(nearest.best_bet_loss, interpolated.best_bet_loss);
+    EXPECT_LT(interpolated.best_bet_loss, 0.05f);
+}
+
+TEST(EstimationTable, estimator_fast_path)
+{
+    kwa::MatchEstimator estimator{};
+    estimator.addMatch(1, "Munich", "Bremen", 4, 1);
+    estimator.addMatch(2, "Bremen", "Munich", 0, 3);
+    estimator.addMatch(3, "Dortmund", "Bremen", 1, 1);
+    estimator.addMatch(4, "Munich", "Dortmund", 1, 2);
+    estimator.recalculateTeamStatistics();
+    EXPECT_EQ(0.0f, estimator.measureEstimationTableError().three_way);
+
+    kwa::MatchEstimation exact, table;
+    estimator.estimate(exact, "Munich", "Bremen");
+    estimator.useEstimationTable(kwa::MatchEstimator::TABLE_INTERPOLATED);
+    estimator.estimate(table, "Munich", "Bremen");
+
+    const auto error = estimator.measureEstimationTableError();
+    EXPECT_GT(error.three_way, 0.0f);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(exact.three_way_probabilities[i], table.three_way_probabilities[i],
+                    error.three_way + 1e-5f);
+    }
+    EXPECT_NEAR(exact.best_result_bet_ev, table.best_result_bet_ev, error.best_bet_ev + 1e-5f);
+    EXPECT_NEAR(exact.truncation_error, table.truncation_error, 1e-3f);
+}
+} // namespace
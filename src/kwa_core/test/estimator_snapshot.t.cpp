@@ -0,0 +1,75 @@
+#include "kwa_core/estimator_snapshot.h"
+#include "gtest/gtest.h"
+#include "test_league.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+TEST(EstimatorSnapshot, equals_estimator_and_ignores_later_changes)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::addLeagueRounds(estimator, 1, 20);
+    estimator.setGoalModel(kwa::MatchEstimator::COMBINED);
+    // the snapshot brings the statistics up to date on its own
+    const kwa::EstimatorSnapshot snapshot(estimator);
+    EXPECT_EQ(estimator.matchCount(), snapshot.matchCount());
+    EXPECT_TRUE(snapshot.hasHomeStatistics("Munich"));
+    EXPECT_FALSE(snapshot.hasGuestStatistics("Freiburg"));
+
+    kwa::MatchEstimation expected, actual;
+    estimator.estimate(expected, "Munich", "Bremen");
+    snapshot.estimate(actual, "Munich", "Bremen");
+    EXPECT_EQ(expected.three_way_probabilities, actual.three_way_probabilities);
+    EXPECT_EQ(expected.best_result_bet_ev, actual.best_result_bet_ev);
+
+    estimator.addMatch(21, "Munich", "Bremen", 0, 6);
+    estimator.setGoalModel(kwa::MatchEstimator::SIMPLE);
+    estimator.estimate(expected, "Munich", "Bremen");
+    kwa::MatchEstimation unchanged;
+    snapshot.estimate(unchanged, "Munich", "Bremen");
+    EXPECT_EQ(actual.best_result_bet_ev, unchanged.best_result_bet_ev);
+    EXPECT_NE(expected.best_result_bet_ev, unchanged.best_result_bet_ev);
+
+    const std::pair<kwa::TeamId, kwa::TeamId> pairs[] = {
+        {snapshot.teamRegister().getId("Munich"), snapshot.teamRegister().getId("Bremen")}};
+    kwa::MatchEstimationBatch batch;
+    snapshot.estimateMany(pairs, batch);
+    ASSERT_EQ(1, batch.size());
+    EXPECT_NEAR(actual.best_result_bet_ev, batch.best_result_bet_ev[0], 1e-5f);
+}
+
+TEST(EstimatorSnapshot, readers_see_whole_snapshots_while_writer_swaps)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::addLeagueRounds(estimator, 1, 10);
+    kwa::SharedEstimatorSnapshot shared;
+    EXPECT_EQ(nullptr, shared.load());
+    shared.update(estimator);
+
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    auto reader = [&]() {
+        while (!done) {
+            auto snapshot = shared.load();
+            // each snapshot estimates consistently with its own match count
+            kwa::MatchEstimation first, second;
+            snapshot->estimate(first, "Munich", "Bremen");
+            snapshot->estimate(second, "Munich", "Bremen");
+            if (first.best_result_bet_ev != second.best_result_bet_ev ||
+                snapshot->matchCount() % 3 != 0)
+                ++failures;
+        }
+    };
+    std::thread readers[] = {std::thread(reader), std::thread(reader), std::thread(reader)};
+
+    for (int day = 11; day <= 40; ++day) {
+        kwa_test::addLeagueRounds(estimator, day, day);
+        shared.update(estimator);
+    }
+    done = true;
+    for (auto& thread : readers) thread.join();
+
+    EXPECT_EQ(0, failures);
+    EXPECT_EQ(estimator.matchCount(), shared.load()->matchCount());
+}
+} // namespace
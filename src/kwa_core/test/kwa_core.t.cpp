@@ -1,11 +1,238 @@
+#include "kwa_core/kwa_core.h"
 #include "gtest/gtest.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 
 namespace {
+class TempFile
+{
+public:
+    explicit TempFile(const std::string& content)
+        : m_name(::testing::TempDir() + "kwa_core_test_" + std::to_string(s_counter++) + ".csv")
+    {
+        std::ofstream file(m_name, std::ios::binary);
+        file << content;
+    }
+    ~TempFile() { std::remove(m_name.c_str()); }
+
+    const char* name() const { return m_name.c_str(); }
+
+private:
+    static int s_counter;
+    std::string m_name;
+};
+int TempFile::s_counter = 0;
+
+const char* const CSV_CONTENT =
+    "Div,Date,HomeTeam,AwayTeam,FTHG,FTAG,FTR\n"
+    "D1,14/08/15,Bayern Munich,Hamburg,5,0,H\n"
+    "D1,15/08/15,Augsburg,Hertha,0,1,A\n"
+    "D1,15/08/15,Darmstadt,Hannover,2,2,D\r\n"
+    "D1,22/08/15,Hamburg,Stuttgart,3,2,H\n"
+    "D1,21/08/15,Hertha,Werder Bremen,1,1,D";
+
+void expectEqualMatches(const kwa::MatchEstimator& lhs, const kwa::MatchEstimator& rhs)
+{
+    ASSERT_EQ(lhs.matchCount(), rhs.matchCount());
+    ASSERT_EQ(lhs.teamRegister().size(), rhs.teamRegister().size());
+    for (size_t i = 0; i < lhs.teamRegister().size(); ++i) {
+        EXPECT_EQ(gsl::to_string(lhs.teamRegister().teamName((kwa::TeamId)i)),
+                  gsl::to_string(rhs.teamRegister().teamName((kwa::TeamId)i)));
+    }
+    for (size_t i = 0; i < lhs.matchCount(); ++i) {
+        auto& l = lhs.matches()[(std::ptrdiff_t)i];
+        auto& r = rhs.matches()[(std::ptrdiff_t)i];
+        EXPECT_EQ(l.day, r.day);
+        EXPECT_EQ(l.home_team, r.home_team);
+        EXPECT_EQ(l.guest_team, r.guest_team);
+        EXPECT_EQ(l.home_goals, r.home_goals);
+        EXPECT_EQ(l.guest_goals, r.guest_goals);
+    }
+}
+
 TEST(TestTest, Foo)
 {
     int a = 1;
     EXPECT_EQ(1, a);
 }
+
+TEST(LoadMatches, mapped_loader_matches_stream_loader)
+{
+    TempFile file(CSV_CONTENT);
+
+    kwa::MatchEstimator stream_estimator;
+    kwa::MatchEstimator mapped_estimator;
+    ASSERT_TRUE(kwa::loadMatchesFromCSVFile(stream_estimator, file.name()));
+    ASSERT_TRUE(kwa::loadMatchesFromMappedCSVFile(mapped_estimator, file.name()));
+
+    EXPECT_EQ(5, mapped_estimator.matchCount());
+    EXPECT_EQ(kwa::match_date(2015, 8, 14), mapped_estimator.matches()[0].day);
+    EXPECT_STREQ("Werder Bremen", mapped_estimator.teamRegister()
+                                      .teamName(mapped_estimator.matches()[3].guest_team)
+                                      .data());
+    expectEqualMatches(stream_estimator, mapped_estimator);
+}
+
+TEST(LoadMatches, mapped_loader_missing_file_fails)
+{
+    kwa::MatchEstimator estimator;
+    EXPECT_FALSE(kwa::loadMatchesFromMappedCSVFile(estimator, "does/not/exist.csv"));
+    EXPECT_EQ(0, estimator.matchCount());
+}
+
+TEST(LoadMatches, mapped_loader_malformed_row_adds_nothing)
+{
+    TempFile file("Div,Date,HomeTeam,AwayTeam,FTHG,FTAG\n"
+                  "D1,14/08/15,Bayern Munich,Hamburg,5,0\n"
+                  "D1,15/08/15,Augsburg,Hertha,0\n");
+
+    kwa::MatchEstimator estimator;
+    EXPECT_FALSE(kwa::loadMatchesFromMappedCSVFile(estimator, file.name()));
+    EXPECT_EQ(0, estimator.matchCount());
+}
+
+TEST(LoadMatches, mapped_loader_header_only)
+{
+    TempFile file("Div,Date,HomeTeam,AwayTeam,FTHG,FTAG\n");
+
+    kwa::MatchEstimator estimator;
+    EXPECT_TRUE(kwa::loadMatchesFromMappedCSVFile(estimator, file.name()));
+    EXPECT_EQ(0, estimator.matchCount());
+}
+
+TEST(Snapshot, load_restores_matches_teams_and_estimation)
+{
+    TempFile csv(CSV_CONTENT);
+    TempFile snapshot("");
+
+    kwa::MatchEstimator source;
+    ASSERT_TRUE(kwa::loadMatchesFromCSVFile(source, csv.name()));
+    ASSERT_TRUE(kwa::saveSnapshot(source, snapshot.name()));
+
+    kwa::MatchEstimator restored;
+    ASSERT_TRUE(kwa::loadSnapshot(restored, snapshot.name()));
+    expectEqualMatches(source, restored);
+    EXPECT_TRUE(restored.hasHomeStatistics("Hertha"));
+    EXPECT_TRUE(restored.hasGuestStatistics("Werder Bremen"));
+
+    kwa::MatchEstimation expected, actual;
+    source.estimate(expected, "Hamburg", "Hertha");
+    restored.estimate(actual, "Hamburg", "Hertha");
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_FLOAT_EQ(expected.three_way_probabilities[i], actual.three_way_probabilities[i]);
+    }
+    EXPECT_EQ(expected.best_result_bet_home_goals, actual.best_result_bet_home_goals);
+    EXPECT_EQ(expected.best_result_bet_guest_goals, actual.best_result_bet_guest_goals);
+    EXPECT_FLOAT_EQ(expected.best_result_bet_ev, actual.best_result_bet_ev);
+}
+
+TEST(Snapshot, load_restores_goal_cap)
+{
+    TempFile csv(CSV_CONTENT);
+    TempFile snapshot("");
+
+    kwa::MatchEstimator source;
+    ASSERT_TRUE(kwa::loadMatchesFromCSVFile(source, csv.name()));
+    source.setGoalCap(2);
+    source.recalculateTeamStatistics();
+    ASSERT_TRUE(kwa::saveSnapshot(source, snapshot.name()));
+
+    kwa::MatchEstimator restored;
+    ASSERT_TRUE(kwa::loadSnapshot(restored, snapshot.name()));
+    EXPECT_EQ(2, restored.goalCap());
+    restored.recalculateTeamStatistics();
+
+    kwa::MatchEstimation expected, actual;
+    source.estimate(expected, "Hamburg", "Hertha");
+    restored.estimate(actual, "Hamburg", "Hertha");
+    EXPECT_FLOAT_EQ(expected.best_result_bet_ev, actual.best_result_bet_ev);
+}
+
+TEST(Snapshot, load_invalid_file_keeps_estimator)
+{
+    TempFile csv(CSV_CONTENT);
+    kwa::MatchEstimator estimator;
+    ASSERT_TRUE(kwa::loadMatchesFromCSVFile(estimator, csv.name()));
+
+    EXPECT_FALSE(kwa::loadSnapshot(estimator, csv.name()));
+    EXPECT_FALSE(kwa::loadSnapshot(estimator, "does/not/exist.kwa"));
+    EXPECT_EQ(5, estimator.matchCount());
+}
+
+/**
+ * Saves a snapshot of CSV_CONTENT and returns its bytes.
+ */
+std::string snapshotBytes()
+{
+    TempFile csv(CSV_CONTENT);
+    TempFile snapshot("");
+    kwa::MatchEstimator source;
+    EXPECT_TRUE(kwa::loadMatchesFromCSVFile(source, csv.name()));
+    EXPECT_TRUE(kwa::saveSnapshot(source, snapshot.name()));
+    std::ifstream file(snapshot.name(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/**
+ * Returns the file offset of a block, the block table follows the 24 byte
+ * header.
+ */
+size_t blockOffset(const std::string& bytes, size_t block)
+{
+    uint64_t offset;
+    std::memcpy(&offset, bytes.data() + 24 + block * 16, sizeof(offset));
+    return (size_t)offset;
+}
+
+TEST(Snapshot, load_corrupt_file_fails)
+{
+    const std::string bytes = snapshotBytes();
+    {
+        TempFile snapshot(bytes);
+        kwa::MatchEstimator estimator;
+        ASSERT_TRUE(kwa::loadSnapshot(estimator, snapshot.name()));
+    }
+
+    // a match with an unknown home team
+    std::string corrupt = bytes;
+    const int32_t team = 1000;
+    std::memcpy(&corrupt[blockOffset(corrupt, 0) + sizeof(int)], &team, sizeof(team));
+    {
+        TempFile snapshot(corrupt);
+        kwa::MatchEstimator estimator;
+        EXPECT_FALSE(kwa::loadSnapshot(estimator, snapshot.name()));
+    }
+
+    // the home goals of the first team lose their entry, the other columns
+    // keep it
+    corrupt = bytes;
+    const uint32_t offset = 0;
+    std::memcpy(&corrupt[blockOffset(corrupt, 3) + sizeof(uint32_t)], &offset, sizeof(offset));
+    {
+        TempFile snapshot(corrupt);
+        kwa::MatchEstimator estimator;
+        EXPECT_FALSE(kwa::loadSnapshot(estimator, snapshot.name()));
+    }
+
+    // cut off in the middle of the blocks
+    {
+        TempFile snapshot(bytes.substr(0, bytes.size() / 2));
+        kwa::MatchEstimator estimator;
+        EXPECT_FALSE(kwa::loadSnapshot(estimator, snapshot.name()));
+    }
+}
+
+TEST(Snapshot, save_requires_up_to_date_statistics)
+{
+    TempFile snapshot("");
+    kwa::MatchEstimator estimator;
+    estimator.addMatch(1, "Munich", "Bremen", 2, 1);
+    EXPECT_FALSE(kwa::saveSnapshot(estimator, snapshot.name()));
+    estimator.recalculateTeamStatistics();
+    EXPECT_TRUE(kwa::saveSnapshot(estimator, snapshot.name()));
+}
 } // namespace
 
 int main(int argc, char* argv[])
@@ -1,5 +1,8 @@
 #include "kwa_core/match_estimator.h"
+#include "calculations.h"
+#include <thread>
 #include "gtest/gtest.h"
+#include "test_league.h"
 
 namespace {
 TEST(MatchEstimator, def_constr_is_empty)
@@ -38,6 +41,98 @@ TEST(MatchEstimator, add_matches_will_increase_match_count_accordingly)
     EXPECT_TRUE(estimator.hasGuestStatistics("Hamburg"));
 }
 
+TEST(MatchEstimator, add_matches_equals_add_match_in_order)
+{
+    const char* teams[] = {"Munich", "Bremen", "Schalke", "Dortmund", "Hamburg", "Mainz"};
+    std::vector<kwa::MatchResult> batch_a, batch_b;
+    for (int i = 0; i < 200; ++i) {
+        auto& batch = i < 120 ? batch_a : batch_b;
+        batch.push_back({std::rand() % 30, gsl::ensure_z(teams[std::rand() % 6]),
+                         gsl::ensure_z(teams[std::rand() % 6]), i % 5, i % 3});
+    }
+
+    kwa::MatchEstimator single{};
+    for (auto& batch : {batch_a, batch_b}) {
+        for (auto& m : batch) {
+            single.addMatch(m.date, m.home_team.data(), m.guest_team.data(), m.home_goals,
+                            m.guest_goals);
+        }
+    }
+
+    kwa::MatchEstimator bulk{};
+    bulk.addMatches(batch_a);
+    bulk.addMatches(batch_b);
+
+    ASSERT_EQ(single.matchCount(), bulk.matchCount());
+    EXPECT_EQ(single.teamRegister().size(), bulk.teamRegister().size());
+    for (std::ptrdiff_t i = 0; i < (std::ptrdiff_t)single.matchCount(); ++i) {
+        EXPECT_EQ(single.matches()[i].day, bulk.matches()[i].day);
+        EXPECT_EQ(single.matches()[i].home_team, bulk.matches()[i].home_team);
+        EXPECT_EQ(single.matches()[i].guest_team, bulk.matches()[i].guest_team);
+        EXPECT_EQ(single.matches()[i].home_goals, bulk.matches()[i].home_goals);
+        EXPECT_EQ(single.matches()[i].guest_goals, bulk.matches()[i].guest_goals);
+    }
+}
+
+void expectEqualEstimations(kwa::MatchEstimator& lhs, kwa::MatchEstimator& rhs)
+{
+    ASSERT_EQ(lhs.teamRegister().size(), rhs.teamRegister().size());
+    for (size_t h = 0; h < lhs.teamRegister().size(); ++h) {
+        for (size_t g = 0; g < lhs.teamRegister().size(); ++g) {
+            auto home = lhs.teamRegister().teamName((kwa::TeamId)h).data();
+            auto guest = lhs.teamRegister().teamName((kwa::TeamId)g).data();
+            ASSERT_EQ(lhs.hasHomeStatistics(home), rhs.hasHomeStatistics(home));
+            ASSERT_EQ(lhs.hasGuestStatistics(guest), rhs.hasGuestStatistics(guest));
+            if (h == g || !lhs.hasHomeStatistics(home) || !lhs.hasGuestStatistics(guest))
+                continue;
+
+            kwa::MatchEstimation l, r;
+            lhs.estimate(l, home, guest);
+            rhs.estimate(r, home, guest);
+            for (size_t i = 0; i < 3; ++i) {
+                EXPECT_FLOAT_EQ(l.three_way_probabilities[i], r.three_way_probabilities[i]);
+            }
+            EXPECT_EQ(l.best_result_bet_home_goals, r.best_result_bet_home_goals);
+            EXPECT_EQ(l.best_result_bet_guest_goals, r.best_result_bet_guest_goals);
+            EXPECT_FLOAT_EQ(l.best_result_bet_ev, r.best_result_bet_ev);
+        }
+    }
+}
+
+TEST(MatchEstimator, incremental_statistics_equal_full_rebuild)
+{
+    const char* teams[] = {"Munich", "Bremen", "Schalke", "Dortmund", "Hamburg", "Mainz"};
+    kwa::MatchEstimator incremental{};
+    kwa::MatchEstimator full{};
+    for (int day = 1; day <= 40; ++day) {
+        for (int i = 0; i < 3; ++i) {
+            auto home = teams[(day + i) % 6];
+            auto guest = teams[(day * 5 + i + 1) % 6];
+            int home_goals = (day * 7 + i) % 6;
+            int guest_goals = (day * 3 + i) % 4;
+            incremental.addMatch(day, home, guest, home_goals, guest_goals);
+            full.addMatch(day, home, guest, home_goals, guest_goals);
+        }
+        incremental.recalculateTeamStatistics();
+    }
+    // out of order insert falls back to a rebuild
+    incremental.addMatch(3, "Munich", "Freiburg", 6, 0);
+    incremental.recalculateTeamStatistics();
+    full.addMatch(3, "Munich", "Freiburg", 6, 0);
+
+    full.recalculateTeamStatistics();
+    expectEqualEstimations(incremental, full);
+
+    // estimate() picks up new matches on its own
+    incremental.addMatch(41, "Freiburg", "Munich", 1, 1);
+    full.addMatch(41, "Freiburg", "Munich", 1, 1);
+    full.recalculateTeamStatistics();
+    kwa::MatchEstimation estimation;
+    incremental.estimate(estimation, "Munich", "Bremen");
+    EXPECT_TRUE(incremental.hasHomeStatistics("Freiburg"));
+    expectEqualEstimations(incremental, full);
+}
+
 TEST(MatchEstimator, estimate)
 {
     kwa::MatchEstimator estimator{};
@@ -57,6 +152,470 @@ TEST(MatchEstimator, set_max_date)
     estimator.setMaxDate(12);
 }
 
+TEST(MatchEstimator, date_range_limits_statistics)
+{
+    kwa::MatchEstimator estimator{};
+    estimator.addMatch(1, "Munich", "Bremen", 2, 1);
+    estimator.addMatch(3, "Bremen", "Munich", 0, 2);
+    estimator.addMatch(5, "Munich", "Dortmund", 1, 1);
+    estimator.recalculateTeamStatistics();
+
+    estimator.setDateRange(2, -1);
+    EXPECT_TRUE(estimator.hasHomeStatistics("Bremen"));
+    EXPECT_FALSE(estimator.hasGuestStatistics("Bremen"));
+    EXPECT_TRUE(estimator.hasGuestStatistics("Munich"));
+
+    estimator.setDateRange(2, 5);
+    EXPECT_FALSE(estimator.hasHomeStatistics("Munich"));
+    EXPECT_TRUE(estimator.hasHomeStatistics("Bremen"));
+
+    estimator.setDateRange(-1, 3);
+    EXPECT_TRUE(estimator.hasHomeStatistics("Munich"));
+    EXPECT_FALSE(estimator.hasHomeStatistics("Bremen"));
+
+    // the max date replaces the whole range
+    estimator.setDateRange(2, 5);
+    estimator.setMaxDate(3);
+    EXPECT_TRUE(estimator.hasHomeStatistics("Munich"));
+    EXPECT_EQ(-1, estimator.queryContext().min_date);
+    EXPECT_EQ(3, estimator.queryContext().max_date);
+}
+
+TEST(MatchEstimator, combined_goal_model)
+{
+    kwa::MatchEstimator estimator{};
+    estimator.addMatch(1, "Munich", "Bremen", 4, 1);
+    estimator.addMatch(2, "Bremen", "Munich", 0, 3);
+    estimator.addMatch(3, "Dortmund", "Munich", 1, 1);
+    estimator.addMatch(4, "Munich", "Dortmund", 1, 2);
+    estimator.addMatch(5, "Bremen", "Dortmund", 2, 2);
+    estimator.recalculateTeamStatistics();
+
+    kwa::MatchEstimation simple, location_only, combined;
+    estimator.estimate(simple, "Munich", "Dortmund");
+
+    estimator.setGoalModel(kwa::MatchEstimator::COMBINED, 1.0f, 0.0f);
+    estimator.estimate(location_only, "Munich", "Dortmund");
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_FLOAT_EQ(simple.three_way_probabilities[i],
+                        location_only.three_way_probabilities[i]);
+    }
+
+    estimator.setGoalModel(kwa::MatchEstimator::COMBINED, 0.5f, 0.5f);
+    estimator.estimate(combined, "Munich", "Dortmund");
+    EXPECT_NE(simple.three_way_probabilities[0], combined.three_way_probabilities[0]);
+}
+
+TEST(MatchEstimator, poisson_cache_gives_close_estimations)
+{
+    kwa::MatchEstimator estimator{};
+    estimator.addMatch(1, "Munich", "Bremen", 4, 1);
+    estimator.addMatch(2, "Bremen", "Munich", 0, 3);
+    estimator.addMatch(3, "Dortmund", "Bremen", 1, 1);
+    estimator.addMatch(4, "Munich", "Dortmund", 1, 2);
+    estimator.recalculateTeamStatistics();
+
+    kwa::MatchEstimation exact, cached;
+    estimator.estimate(exact, "Munich", "Bremen");
+    estimator.usePoissonCache(true);
+    estimator.estimate(cached, "Munich", "Bremen");
+
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(exact.three_way_probabilities[i], cached.three_way_probabilities[i], 1e-3f);
+    }
+    EXPECT_NEAR(exact.best_result_bet_ev, cached.best_result_bet_ev, 1e-2f);
+}
+
+TEST(MatchEstimator, tail_epsilon_gives_close_estimations)
+{
+    kwa::MatchEstimator estimator{};
+    estimator.addMatch(1, "Munich", "Bremen", 1, 0);
+    estimator.addMatch(2, "Bremen", "Munich", 0, 1);
+    estimator.addMatch(3, "Dortmund", "Bremen", 1, 1);
+    estimator.addMatch(4, "Munich", "Dortmund", 0, 0);
+    estimator.recalculateTeamStatistics();
+
+    kwa::MatchEstimation full, truncated;
+    estimator.estimate(full, "Munich", "Bremen");
+    EXPECT_LT(full.truncation_error, 1e-6f);
+
+    estimator.setTailEpsilon(1e-3f);
+    estimator.estimate(truncated, "Munich", "Bremen");
+    EXPECT_GT(truncated.truncation_error, 0.0f);
+    EXPECT_LT(truncated.truncation_error, 2e-3f);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(full.three_way_probabilities[i], truncated.three_way_probabilities[i],
+                    2e-3f);
+    }
+    EXPECT_EQ(full.best_result_bet_home_goals, truncated.best_result_bet_home_goals);
+    EXPECT_EQ(full.best_result_bet_guest_goals, truncated.best_result_bet_guest_goals);
+    EXPECT_NEAR(full.best_result_bet_ev, truncated.best_result_bet_ev, 1e-2f);
+}
+
+void expectEstimateManyEqualsEstimate(kwa::MatchEstimator& estimator)
+{
+    std::vector<std::pair<kwa::TeamId, kwa::TeamId>> matches;
+    const auto team_count = (kwa::TeamId)estimator.teamRegister().size();
+    for (kwa::TeamId h = team_count - 1; h >= 0; --h) {
+        for (kwa::TeamId g = 0; g < team_count; ++g) {
+            if (h != g) matches.emplace_back(h, g);
+        }
+    }
+
+    kwa::MatchEstimationBatch batch;
+    estimator.estimateMany(matches, batch);
+    ASSERT_EQ(matches.size(), batch.size());
+    for (size_t i = 0; i < matches.size(); ++i) {
+        kwa::MatchEstimation single;
+        estimator.estimate(single, matches[i].first, matches[i].second);
+        EXPECT_NEAR(single.three_way_probabilities[0], batch.home_win[i], 1e-5f);
+        EXPECT_NEAR(single.three_way_probabilities[1], batch.draw[i], 1e-5f);
+        EXPECT_NEAR(single.three_way_probabilities[2], batch.guest_win[i], 1e-5f);
+        EXPECT_NEAR(single.best_result_bet_ev, batch.best_result_bet_ev[i], 1e-5f);
+        EXPECT_NEAR(single.truncation_error, batch.truncation_error[i], 1e-5f);
+    }
+}
+
+TEST(MatchEstimator, estimate_many_equals_estimate)
+{
+    const char* teams[] = {"Munich", "Bremen", "Schalke", "Dortmund", "Hamburg", "Mainz"};
+    kwa::MatchEstimator estimator{};
+    for (int day = 1; day <= 40; ++day) {
+        for (int i = 0; i < 6; ++i) {
+            estimator.addMatch(day, teams[i], teams[(i + 1 + day % 5) % 6], (day * 7 + i) % 5,
+                               (day * 3 + i) % 4);
+        }
+    }
+    estimator.recalculateTeamStatistics();
+    expectEstimateManyEqualsEstimate(estimator);
+
+    estimator.setDateRange(10, 30);
+    estimator.setGoalModel(kwa::MatchEstimator::COMBINED);
+    expectEstimateManyEqualsEstimate(estimator);
+
+    estimator.useEstimationTable(kwa::MatchEstimator::TABLE_INTERPOLATED);
+    expectEstimateManyEqualsEstimate(estimator);
+}
+
+void expectMatrixEqualsEstimations(kwa::MatchEstimator& estimator)
+{
+    const auto& matrix = estimator.predictionMatrix();
+    const auto team_count = (kwa::TeamId)estimator.teamRegister().size();
+    ASSERT_EQ((size_t)team_count, matrix.teamCount());
+    for (kwa::TeamId h = 0; h < team_count; ++h) {
+        for (kwa::TeamId g = 0; g < team_count; ++g) {
+            auto home = estimator.teamRegister().teamName(h).data();
+            auto guest = estimator.teamRegister().teamName(g).data();
+            const bool valid = h != g && estimator.hasHomeStatistics(home) &&
+                               estimator.hasGuestStatistics(guest);
+            ASSERT_EQ(valid, matrix.isValid(h, g));
+            if (!valid) continue;
+
+            kwa::MatchEstimation single;
+            estimator.estimate(single, h, g);
+            for (size_t i = 0; i < 3; ++i) {
+                EXPECT_NEAR(single.three_way_probabilities[i],
+                            matrix.at(h, g).three_way_probabilities[i], 1e-5f);
+            }
+            EXPECT_NEAR(single.best_result_bet_ev, matrix.at(h, g).best_result_bet_ev, 1e-5f);
+            EXPECT_NEAR(single.truncation_error, matrix.at(h, g).truncation_error, 1e-5f);
+        }
+    }
+}
+
+TEST(MatchEstimator, prediction_matrix_follows_new_matches)
+{
+    kwa::MatchEstimator estimator{};
+    EXPECT_EQ(0, estimator.predictionMatrix().teamCount());
+
+    kwa_test::addLeagueRounds(estimator, 1, 20);
+    expectMatrixEqualsEstimations(estimator);
+
+    // new results of a few teams, then of a new team
+    estimator.addMatch(21, "Munich", "Bremen", 3, 3);
+    expectMatrixEqualsEstimations(estimator);
+    estimator.addMatch(5, "Schalke", "Mainz", 0, 4);
+    expectMatrixEqualsEstimations(estimator);
+    estimator.addMatch(22, "Freiburg", "Mainz", 2, 0);
+    expectMatrixEqualsEstimations(estimator);
+
+    // settings the predictions depend on
+    estimator.setDateRange(5, 15);
+    expectMatrixEqualsEstimations(estimator);
+    estimator.setGoalModel(kwa::MatchEstimator::COMBINED);
+    expectMatrixEqualsEstimations(estimator);
+    estimator.useEstimationTable(kwa::MatchEstimator::TABLE_NEAREST);
+    expectMatrixEqualsEstimations(estimator);
+    // the cap only matters with more goals than it
+    estimator.addMatch(10, "Munich", "Bremen", 7, 0);
+    expectMatrixEqualsEstimations(estimator);
+    estimator.setGoalCap(0);
+    expectMatrixEqualsEstimations(estimator);
+
+    // matches out of the date range change nothing
+    const auto munich = estimator.teamRegister().getId("Munich");
+    const auto bremen = estimator.teamRegister().getId("Bremen");
+    const auto before = estimator.predictionMatrix().at(munich, bremen);
+    estimator.addMatch(30, "Munich", "Bremen", 9, 0);
+    const auto after = estimator.predictionMatrix().at(munich, bremen);
+    EXPECT_EQ(before.best_result_bet_ev, after.best_result_bet_ev);
+    expectMatrixEqualsEstimations(estimator);
+
+    estimator.clear();
+    EXPECT_EQ(0, estimator.predictionMatrix().teamCount());
+}
+
+TEST(MatchEstimator, prediction_matrix_of_large_league)
+{
+    // enough pairs to be split over the thread pool
+    kwa::MatchEstimator estimator{};
+    const int team_count = 30;
+    for (int day = 1; day <= 40; ++day) {
+        for (int i = 0; i < team_count; i += 2) {
+            const int home = (i + day) % team_count;
+            const int guest = (home + 1 + day % 7) % team_count;
+            estimator.addMatch(day, ("Team " + std::to_string(home)).c_str(),
+                               ("Team " + std::to_string(guest)).c_str(), (day + i) % 4,
+                               (day * i) % 3);
+        }
+    }
+    expectMatrixEqualsEstimations(estimator);
+    estimator.addMatch(41, "Team 3", "Team 4", 2, 2);
+    expectMatrixEqualsEstimations(estimator);
+}
+
+TEST(MatchEstimator, estimation_cache)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::addLeagueRounds(estimator, 1, 20);
+    estimator.useEstimationCache(4);
+
+    kwa::MatchEstimation exact, cached;
+    estimator.estimate(exact, "Munich", "Bremen");
+    estimator.estimate(cached, "Munich", "Bremen");
+    EXPECT_EQ(1, estimator.estimationCacheHits());
+    EXPECT_EQ(1, estimator.estimationCacheMisses());
+    EXPECT_EQ(exact.best_result_bet_ev, cached.best_result_bet_ev);
+    EXPECT_EQ(exact.three_way_probabilities, cached.three_way_probabilities);
+
+    // the date range is part of the key
+    estimator.setMaxDate(15);
+    estimator.estimate(cached, "Munich", "Bremen");
+    estimator.setMaxDate(-1);
+    estimator.estimate(cached, "Munich", "Bremen");
+    EXPECT_EQ(2, estimator.estimationCacheHits());
+    EXPECT_EQ(2, estimator.estimationCacheMisses());
+
+    // new matches and settings invalidate all results
+    estimator.addMatch(21, "Munich", "Bremen", 5, 0);
+    estimator.estimate(cached, "Munich", "Bremen");
+    EXPECT_EQ(3, estimator.estimationCacheMisses());
+    EXPECT_NE(exact.best_result_bet_ev, cached.best_result_bet_ev);
+    estimator.setGoalModel(kwa::MatchEstimator::COMBINED);
+    estimator.estimate(cached, "Munich", "Bremen");
+    EXPECT_EQ(4, estimator.estimationCacheMisses());
+    estimator.recalculateTeamStatistics();
+    estimator.estimate(cached, "Munich", "Bremen");
+    EXPECT_EQ(3, estimator.estimationCacheHits());
+}
+
+void expectEstimationsEqual(const kwa::MatchEstimation& a, const kwa::MatchEstimation& b)
+{
+    EXPECT_EQ(a.three_way_probabilities, b.three_way_probabilities);
+    EXPECT_EQ(a.best_result_bet_home_goals, b.best_result_bet_home_goals);
+    EXPECT_EQ(a.best_result_bet_guest_goals, b.best_result_bet_guest_goals);
+    EXPECT_EQ(a.best_result_bet_ev, b.best_result_bet_ev);
+}
+
+TEST(MatchEstimator, query_context_equals_estimator_settings)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::addLeagueRounds(estimator, 1, 20);
+    estimator.recalculateTeamStatistics();
+
+    const int ranges[][2] = {{-1, -1}, {-1, 10}, {5, 15}, {12, -1}};
+    for (auto model : {kwa::MatchEstimator::SIMPLE, kwa::MatchEstimator::COMBINED}) {
+        estimator.setGoalModel(model);
+        for (const auto& range : ranges) {
+            kwa::QueryContext context;
+            context.goal_model = model;
+            context.location_weight = model == kwa::MatchEstimator::COMBINED ? 0.5f : 1.0f;
+            context.total_weight = model == kwa::MatchEstimator::COMBINED ? 0.5f : 0.0f;
+            context.min_date = range[0];
+            context.max_date = range[1];
+            estimator.setDateRange(range[0], range[1]);
+            EXPECT_EQ(estimator.hasHomeStatistics("Mainz"),
+                      estimator.hasHomeStatistics("Mainz", context));
+
+            kwa::MatchEstimation expected, actual;
+            estimator.estimate(expected, "Munich", "Bremen");
+            estimator.setDateRange(-1, -1);
+            estimator.estimate(actual, "Munich", "Bremen", context);
+            expectEstimationsEqual(expected, actual);
+        }
+    }
+}
+
+TEST(MatchEstimator, query_context_window_uses_last_matches)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::addLeagueRounds(estimator, 1, 20);
+    // Munich loses its last home matches
+    for (int day = 21; day <= 23; ++day) estimator.addMatch(day, "Munich", "Bremen", 1, 2);
+    estimator.recalculateTeamStatistics();
+
+    kwa::QueryContext all, window, wide_window;
+    window.window_size = 3;
+    wide_window.window_size = 1000;
+    kwa::MatchEstimation all_estimation, window_estimation, wide_estimation;
+    estimator.estimate(all_estimation, "Munich", "Bremen", all);
+    estimator.estimate(window_estimation, "Munich", "Bremen", window);
+    estimator.estimate(wide_estimation, "Munich", "Bremen", wide_window);
+    EXPECT_LT(window_estimation.three_way_probabilities[0],
+              all_estimation.three_way_probabilities[0]);
+    expectEstimationsEqual(all_estimation, wide_estimation);
+
+    // the window ends at the end of the date range
+    kwa::MatchEstimation before_estimation;
+    window.max_date = 21;
+    estimator.estimate(before_estimation, "Munich", "Bremen", window);
+    EXPECT_GT(before_estimation.three_way_probabilities[0],
+              window_estimation.three_way_probabilities[0]);
+
+    // in a range the window applies only if the range has more matches
+    window.min_date = 22;
+    window.max_date = -1;
+    wide_window.min_date = 22;
+    estimator.estimate(window_estimation, "Munich", "Bremen", window);
+    estimator.estimate(wide_estimation, "Munich", "Bremen", wide_window);
+    expectEstimationsEqual(window_estimation, wide_estimation);
+    window.min_date = 10;
+    wide_window.min_date = 10;
+    estimator.estimate(window_estimation, "Munich", "Bremen", window);
+    estimator.estimate(wide_estimation, "Munich", "Bremen", wide_window);
+    EXPECT_LT(window_estimation.three_way_probabilities[0],
+              wide_estimation.three_way_probabilities[0]);
+}
+
+TEST(MatchEstimator, query_context_system_points)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::addLeagueRounds(estimator, 1, 20);
+    estimator.recalculateTeamStatistics();
+
+    kwa::QueryContext context;
+    context.system_points = {10.0f, 0.0f, 1.0f};
+    kwa::MatchEstimation exact, table;
+    estimator.estimate(exact, "Munich", "Bremen", context);
+
+    // the table is built for the points of the estimator, it is not used
+    estimator.useEstimationTable(kwa::MatchEstimator::TABLE_NEAREST);
+    estimator.estimate(table, "Munich", "Bremen", context);
+    expectEstimationsEqual(exact, table);
+
+    kwa::MatchEstimation default_points;
+    estimator.estimate(default_points, "Munich", "Bremen", kwa::QueryContext());
+    EXPECT_NE(exact.best_result_bet_ev, default_points.best_result_bet_ev);
+}
+
+TEST(MatchEstimator, query_context_concurrent_dates)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::addLeagueRounds(estimator, 1, 40);
+    estimator.recalculateTeamStatistics();
+
+    std::vector<kwa::MatchEstimation> expected(40);
+    for (int day = 2; day < 40; ++day) {
+        estimator.setMaxDate(day);
+        if (estimator.hasHomeStatistics("Munich") && estimator.hasGuestStatistics("Bremen"))
+            estimator.estimate(expected[(size_t)day], "Munich", "Bremen");
+    }
+    estimator.setMaxDate(-1);
+
+    const kwa::MatchEstimator& shared = estimator;
+    auto query = [&shared, &expected](int first_day) {
+        for (int day = first_day; day < 40; day += 4) {
+            kwa::QueryContext context;
+            context.max_date = day;
+            if (!shared.hasHomeStatistics("Munich", context) ||
+                !shared.hasGuestStatistics("Bremen", context))
+                continue;
+            kwa::MatchEstimation actual;
+            shared.estimate(actual, "Munich", "Bremen", context);
+            expectEstimationsEqual(expected[(size_t)day], actual);
+        }
+    };
+    std::thread threads[] = {std::thread(query, 2), std::thread(query, 3), std::thread(query, 4),
+                             std::thread(query, 5)};
+    for (auto& thread : threads) thread.join();
+}
+
+TEST(MatchEstimator, goal_cap)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::addLeagueRounds(estimator, 1, 20);
+    estimator.addMatch(21, "Munich", "Bremen", 9, 0);
+    estimator.recalculateTeamStatistics();
+    EXPECT_EQ(4, estimator.goalCap());
+
+    kwa::MatchEstimation capped, uncapped;
+    estimator.estimate(capped, "Munich", "Bremen");
+    estimator.setGoalCap(0);
+    estimator.recalculateTeamStatistics();
+    estimator.estimate(uncapped, "Munich", "Bremen");
+    EXPECT_GT(uncapped.three_way_probabilities[0], capped.three_way_probabilities[0]);
+
+    // a copy keeps the cap
+    kwa::MatchEstimator copy = estimator;
+    EXPECT_EQ(0, copy.goalCap());
+    copy.estimate(capped, "Munich", "Bremen");
+    expectEstimationsEqual(uncapped, capped);
+}
+
+TEST(MatchEstimator, query_context_correction)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::addLeagueRounds(estimator, 1, 20);
+    estimator.recalculateTeamStatistics();
+
+    kwa::QueryContext context = estimator.queryContext();
+    kwa::MatchEstimation corrected, uncorrected;
+    estimator.estimate(corrected, "Munich", "Bremen", context);
+    context.correction = 0.0f;
+    estimator.estimate(uncorrected, "Munich", "Bremen", context);
+    // the correction moves probability to draws
+    EXPECT_GT(corrected.three_way_probabilities[1], uncorrected.three_way_probabilities[1]);
+
+    // the batch path uses the same correction
+    const std::pair<kwa::TeamId, kwa::TeamId> match{estimator.teamRegister().getId("Munich"),
+                                                    estimator.teamRegister().getId("Bremen")};
+    kwa::MatchEstimationBatch batch;
+    estimator.estimateMany({&match, 1}, batch);
+    EXPECT_NEAR(corrected.three_way_probabilities[1], batch.draw[0], 1e-5f);
+}
+
+TEST(MatchEstimator, expected_goals_give_the_scores_of_estimate)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::addLeagueRounds(estimator, 1, 20);
+    estimator.recalculateTeamStatistics();
+
+    kwa::QueryContext context = estimator.queryContext();
+    context.max_date = 15;
+    context.goal_model = kwa::MatchEstimator::COMBINED;
+    float home_ev, guest_ev;
+    estimator.expectedGoals(estimator.teamRegister().getId("Munich"),
+                            estimator.teamRegister().getId("Bremen"), context, home_ev, guest_ev);
+    kwa::ScoreMatrix scores;
+    kwa::FillScoreMatrix(scores, home_ev, guest_ev, context.correction);
+    const auto three_way = kwa::CalculateThreeWayBet(scores);
+
+    kwa::MatchEstimation estimation;
+    estimator.estimate(estimation, "Munich", "Bremen", context);
+    for (size_t i = 0; i < 3; ++i)
+        EXPECT_NEAR(estimation.three_way_probabilities[i], three_way[i], 1e-6f);
+}
+
 TEST(MatchEstimator, clear_sets_match_count_to_zero)
 {
     kwa::MatchEstimator estimator{};
@@ -0,0 +1,103 @@
+#include "kwa_core/parameter_sweep.h"
+#include "gtest/gtest.h"
+#include "test_league.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+TEST(ParameterSweep, grid_has_all_combinations)
+{
+    kwa::SweepGrid grid;
+    grid.goal_caps = {3, 4};
+    grid.window_sizes = {0, 5};
+    grid.goal_models = {kwa::MatchEstimator::SIMPLE, kwa::MatchEstimator::COMBINED};
+    grid.location_weights = {0.3f, 0.7f};
+    grid.total_weights = {0.5f};
+    grid.corrections = {0.0f, 0.1f};
+
+    std::vector<kwa::SweepParameters> parameters;
+    kwa::MakeSweepGrid(grid, parameters);
+    // SIMPLE once, COMBINED once per weight pair
+    EXPECT_EQ(2 * 2 * 2 * (1 + 2), parameters.size());
+    for (const auto& set : parameters) {
+        if (set.goal_model == kwa::MatchEstimator::SIMPLE) {
+            EXPECT_EQ(0.0f, set.total_weight);
+        }
+    }
+}
+
+TEST(ParameterSweep, random_sweep_stays_in_grid)
+{
+    kwa::SweepGrid grid;
+    grid.goal_caps = {3, 5};
+    grid.goal_models = {kwa::MatchEstimator::COMBINED};
+    grid.location_weights = {0.2f, 0.8f};
+    grid.corrections = {0.0f, 0.2f};
+
+    std::vector<kwa::SweepParameters> parameters, same_seed;
+    kwa::MakeRandomSweep(grid, 50, 7, parameters);
+    kwa::MakeRandomSweep(grid, 50, 7, same_seed);
+    ASSERT_EQ(50, parameters.size());
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        const auto& set = parameters[i];
+        EXPECT_TRUE(set.goal_cap == 3 || set.goal_cap == 5);
+        EXPECT_GE(set.location_weight, 0.2f);
+        EXPECT_LE(set.location_weight, 0.8f);
+        EXPECT_GE(set.correction, 0.0f);
+        EXPECT_LE(set.correction, 0.2f);
+        EXPECT_EQ(set.correction, same_seed[i].correction);
+    }
+}
+
+TEST(ParameterSweep, ranks_backtests_of_all_sets)
+{
+    kwa::MatchEstimator estimator{};
+    kwa_test::TestLeague league;
+    league.first_year = 2015;
+    kwa_test::addLeagueRounds(estimator, 0, 19, league);
+    estimator.recalculateTeamStatistics();
+
+    kwa::SweepGrid grid;
+    grid.goal_caps = {2, 4, 0};
+    grid.window_sizes = {0, 3};
+    grid.corrections = {0.0f, 0.1f};
+    std::vector<kwa::SweepParameters> parameters;
+    kwa::MakeSweepGrid(grid, parameters);
+
+    kwa::ParameterSweep sweep(3);
+    std::vector<kwa::SweepResult> results;
+    sweep.run(estimator, parameters, kwa::BacktestSettings(), results);
+    ASSERT_EQ(parameters.size(), results.size());
+
+    kwa::Backtester backtester(1);
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (i > 0) {
+            EXPECT_GE(results[i - 1].points.points, results[i].points.points);
+        }
+
+        // same as a backtest of an estimator with the parameters
+        const auto& set = results[i].parameters;
+        kwa::MatchEstimator single = estimator;
+        single.setGoalCap(set.goal_cap);
+        single.recalculateTeamStatistics();
+        kwa::BacktestSettings settings;
+        settings.context.window_size = set.window_size;
+        settings.context.correction = set.correction;
+        kwa::BacktestResult expected;
+        backtester.run(single, settings, expected);
+        EXPECT_EQ(expected.total.bet_count, results[i].points.bet_count);
+        EXPECT_FLOAT_EQ(expected.total.points, results[i].points.points);
+    }
+
+    const char* const report_name = "parameter_sweep_report.csv";
+    ASSERT_TRUE(kwa::writeSweepReport(results, report_name));
+    std::ifstream report(report_name);
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(report, line)) ++lines;
+    EXPECT_EQ(results.size() + 1, lines);
+    report.close();
+    std::remove(report_name);
+}
+} // namespace
@@ -0,0 +1,122 @@
+#include "kwa_core/point_distribution.h"
+#include "kwa_core/match_estimator.h"
+#include "gtest/gtest.h"
+
+namespace {
+const kwa::BetSystemPoints POINTS{4.0f, 3.0f, 2.0f};
+
+TEST(PointDistribution, single_match)
+{
+    kwa::PointDistribution distribution;
+    EXPECT_EQ(0, distribution.maxPoints());
+    EXPECT_EQ(1.0, distribution.probability(0));
+
+    distribution.addMatch({0.4f, 0.3f, 0.2f, 0.1f}, POINTS);
+    ASSERT_EQ(4, distribution.maxPoints());
+    EXPECT_FLOAT_EQ(0.4f, (float)distribution.probability(0));
+    EXPECT_EQ(0.0, distribution.probability(1));
+    EXPECT_FLOAT_EQ(0.3f, (float)distribution.probability(2));
+    EXPECT_FLOAT_EQ(0.2f, (float)distribution.probability(3));
+    EXPECT_FLOAT_EQ(0.1f, (float)distribution.probability(4));
+    EXPECT_FLOAT_EQ(0.3f, (float)distribution.probabilityAtLeast(3));
+    EXPECT_FLOAT_EQ(1.6f, (float)distribution.mean());
+    EXPECT_EQ(0.0, distribution.probability(5));
+    EXPECT_EQ(0.0, distribution.probabilityAtLeast(5));
+
+    distribution.clear();
+    EXPECT_EQ(0, distribution.maxPoints());
+}
+
+TEST(PointDistribution, equals_enumeration)
+{
+    const std::vector<kwa::TipOutcome> outcomes{{0.5f, 0.25f, 0.15f, 0.1f},
+                                                {0.3f, 0.4f, 0.2f, 0.1f},
+                                                {0.6f, 0.2f, 0.0f, 0.2f}};
+    const int points[] = {0, 2, 3, 4};
+
+    // all 4^3 combinations of the outcomes
+    std::vector<double> expected(13, 0.0);
+    for (int a = 0; a < 4; ++a) {
+        for (int b = 0; b < 4; ++b) {
+            for (int c = 0; c < 4; ++c) {
+                const float* pa = &outcomes[0].miss;
+                const float* pb = &outcomes[1].miss;
+                const float* pc = &outcomes[2].miss;
+                expected[(size_t)(points[a] + points[b] + points[c])] +=
+                    (double)pa[a] * pb[b] * pc[c];
+            }
+        }
+    }
+
+    kwa::PointDistribution distribution;
+    distribution.addMatches(outcomes, POINTS);
+    ASSERT_EQ(12, distribution.maxPoints());
+    for (int k = 0; k <= 12; ++k)
+        EXPECT_NEAR(expected[(size_t)k], distribution.probability(k), 1e-7) << k;
+
+    // the same by adding the distributions of single matches
+    kwa::PointDistribution first, rest;
+    first.addMatch(outcomes[0], POINTS);
+    rest.addMatches({outcomes.data() + 1, 2}, POINTS);
+    first.add(rest);
+    ASSERT_EQ(12, first.maxPoints());
+    for (int k = 0; k <= 12; ++k)
+        EXPECT_NEAR(expected[(size_t)k], first.probability(k), 1e-7) << k;
+}
+
+TEST(PointDistribution, season_of_matchdays)
+{
+    const kwa::TipOutcome outcome{0.45f, 0.35f, 0.1f, 0.1f};
+    const double match_mean = 0.35 * 2.0 + 0.1 * 3.0 + 0.1 * 4.0;
+
+    kwa::PointDistribution matchday;
+    for (int i = 0; i < 9; ++i) matchday.addMatch(outcome, POINTS);
+    kwa::PointDistribution season;
+    for (int i = 0; i < 34; ++i) season.add(matchday);
+
+    EXPECT_EQ(34 * 9 * 4, season.maxPoints());
+    EXPECT_NEAR(34 * 9 * match_mean, season.mean(), 1e-3);
+    EXPECT_NEAR(1.0, season.probabilityAtLeast(0), 1e-9);
+    EXPECT_NEAR(0.5, season.probabilityAtLeast((int)(34 * 9 * match_mean)), 0.05);
+}
+
+TEST(PointDistribution, estimate_tip_outcomes)
+{
+    kwa::MatchEstimator estimator{};
+    const char* teams[] = {"Munich", "Bremen", "Schalke", "Dortmund"};
+    for (int round = 0; round < 6; ++round) {
+        for (int i = 0; i < 4; ++i) {
+            estimator.addMatch(kwa::match_date(2016, 1 + round, 1), teams[i],
+                               teams[(i + 1 + round % 3) % 4], (round + i) % 4, i % 3);
+        }
+    }
+
+    kwa::MatchEstimation estimation;
+    estimator.estimate(estimation, "Munich", "Bremen");
+    const kwa::TeamId munich = estimator.teamRegister().getId("Munich");
+    const kwa::TeamId bremen = estimator.teamRegister().getId("Bremen");
+    const std::vector<kwa::MatchTip> tips{
+        {munich, bremen, estimation.best_result_bet_home_goals,
+         estimation.best_result_bet_guest_goals},
+        {munich, bremen, 1, 1},
+        {munich, bremen, 0, 1}};
+    std::vector<kwa::TipOutcome> outcomes;
+    estimator.estimateTipOutcomes(tips, outcomes);
+    ASSERT_EQ(3, outcomes.size());
+
+    for (const auto& outcome : outcomes) {
+        EXPECT_NEAR(1.0f, outcome.miss + outcome.tendency + outcome.difference + outcome.result,
+                    1e-5f);
+    }
+    // a draw tip has no difference points, the draw probability is its tendency
+    EXPECT_EQ(0.0f, outcomes[1].difference);
+    EXPECT_NEAR(estimation.three_way_probabilities[1], outcomes[1].tendency + outcomes[1].result,
+                1e-3f);
+    EXPECT_NEAR(estimation.three_way_probabilities[2],
+                outcomes[2].tendency + outcomes[2].difference + outcomes[2].result, 1e-3f);
+
+    kwa::PointDistribution distribution;
+    distribution.addMatch(outcomes[0], POINTS);
+    EXPECT_NEAR(estimation.best_result_bet_ev, distribution.mean(), 1e-3);
+}
+} // namespace
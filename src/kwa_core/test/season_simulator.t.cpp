@@ -0,0 +1,107 @@
+#include "kwa_core/season_simulator.h"
+#include "gtest/gtest.h"
+#include "test_league.h"
+
+namespace {
+/**
+ * Six rounds of a league of four teams from August 2016 on, Munich wins
+ * everything.
+ */
+void addHistory(kwa::MatchEstimator& estimator)
+{
+    kwa_test::TestLeague league;
+    league.team_count = 4;
+    league.first_year = 2016;
+    league.munich_wins = true;
+    kwa_test::addLeagueRounds(estimator, 0, 5, league);
+    estimator.recalculateTeamStatistics();
+}
+
+kwa::TeamId id(const kwa::MatchEstimator& estimator, const char* name)
+{
+    return estimator.teamRegister().getId(name);
+}
+
+TEST(SeasonSimulator, no_fixtures_gives_the_current_table)
+{
+    kwa::MatchEstimator estimator{};
+    addHistory(estimator);
+
+    kwa::SeasonSimulationSettings settings;
+    settings.season_start = kwa::match_date(2016, 8, 1);
+    settings.season_count = 100;
+    kwa::SeasonSimulator simulator(2);
+    kwa::SeasonSimulationResult result;
+    ASSERT_TRUE(simulator.run(estimator, {}, settings, result));
+    ASSERT_EQ(4, result.teams.size());
+    EXPECT_EQ(1.0, result.positionProbability((size_t)id(estimator, "Munich"), 0));
+    EXPECT_EQ(18.0, result.expected_points[(size_t)id(estimator, "Munich")]);
+    EXPECT_EQ(100, result.most_goals_counts[(size_t)id(estimator, "Munich")]);
+}
+
+TEST(SeasonSimulator, single_fixture_follows_estimation)
+{
+    kwa::MatchEstimator estimator{};
+    addHistory(estimator);
+
+    // both teams start at zero, the winner of the fixture ends up first
+    const std::pair<kwa::TeamId, kwa::TeamId> fixture{id(estimator, "Bremen"),
+                                                      id(estimator, "Schalke")};
+    kwa::SeasonSimulationSettings settings;
+    settings.season_count = 200000;
+    kwa::SeasonSimulator simulator;
+    kwa::SeasonSimulationResult result;
+    ASSERT_TRUE(simulator.run(estimator, {&fixture, 1}, settings, result));
+    ASSERT_EQ(2, result.teams.size());
+
+    kwa::MatchEstimation estimation;
+    estimator.estimate(estimation, "Bremen", "Schalke");
+    const auto& three_way = estimation.three_way_probabilities;
+    const size_t bremen = result.teams[0] == fixture.first ? 0 : 1;
+    // draws are broken at random
+    EXPECT_NEAR(three_way[0] + 0.5 * three_way[1], result.positionProbability(bremen, 0),
+                0.005);
+    EXPECT_NEAR(3.0 * three_way[0] + three_way[1], result.expected_points[bremen], 0.02);
+    EXPECT_DOUBLE_EQ(1.0, result.positionProbability(bremen, 0) +
+                              result.positionProbability(bremen, 1));
+}
+
+TEST(SeasonSimulator, result_does_not_depend_on_threads)
+{
+    kwa::MatchEstimator estimator{};
+    addHistory(estimator);
+
+    std::vector<std::pair<kwa::TeamId, kwa::TeamId>> fixtures;
+    for (kwa::TeamId h = 0; h < 4; ++h) {
+        for (kwa::TeamId g = 0; g < 4; ++g) {
+            if (h != g) fixtures.emplace_back(h, g);
+        }
+    }
+    kwa::SeasonSimulationSettings settings;
+    settings.season_start = kwa::match_date(2016, 8, 1);
+    settings.season_count = 5000;
+    settings.seed = 42;
+
+    kwa::SeasonSimulationResult single, parallel;
+    kwa::SeasonSimulator(1).run(estimator, fixtures, settings, single);
+    kwa::SeasonSimulator(4).run(estimator, fixtures, settings, parallel);
+    EXPECT_EQ(single.position_counts, parallel.position_counts);
+    EXPECT_EQ(single.most_goals_counts, parallel.most_goals_counts);
+    EXPECT_EQ(single.expected_points, parallel.expected_points);
+
+    // every season has one team on every position
+    for (size_t p = 0; p < 4; ++p) {
+        double sum = 0.0;
+        for (size_t t = 0; t < 4; ++t) sum += single.positionProbability(t, p);
+        EXPECT_NEAR(1.0, sum, 1e-9);
+    }
+    EXPECT_GT(single.positionProbability((size_t)id(estimator, "Munich"), 0), 0.9);
+
+    // a team without statistics
+    estimator.addMatch(kwa::match_date(2017, 3, 1), "Mainz", "Munich", 0, 1);
+    estimator.recalculateTeamStatistics();
+    const std::pair<kwa::TeamId, kwa::TeamId> unknown{id(estimator, "Munich"),
+                                                      id(estimator, "Mainz")};
+    EXPECT_FALSE(kwa::SeasonSimulator(1).run(estimator, {&unknown, 1}, settings, single));
+}
+} // namespace
@@ -386,4 +386,167 @@ TEST(StatsProvider, get_league_stats_max_matches)
         EXPECT_FLOAT_EQ(10.0f / 6.0f, stats.goal_avg[kwa::LeagueStats::TOTAL]);
     }
 }
+
+TEST(StatsProvider, get_league_stats_before)
+{
+    kwa::StatsProvider provider{};
+    kwa::MatchData matches[] = {{0, 3, 2, 0, 1}, {1, 1, 2, 2, 3}, {2, 1, 2, 4, 1}, {3, 1, 3, 0, 0}};
+    provider.addMatches(matches);
+
+    kwa::LeagueStats stats;
+    EXPECT_EQ(-1, provider.getLeagueStatsBefore(0, stats));
+
+    // every match before the date counts, including the last one
+    EXPECT_EQ(1, provider.getLeagueStatsBefore(1, stats));
+    EXPECT_FLOAT_EQ(1.0f, stats.match_count);
+    EXPECT_FLOAT_EQ(0.0f, stats.goal_avg[kwa::LeagueStats::HOME]);
+    EXPECT_FLOAT_EQ(1.0f, stats.goal_avg[kwa::LeagueStats::AWAY]);
+
+    EXPECT_EQ(2, provider.getLeagueStatsBefore(2, stats));
+    EXPECT_FLOAT_EQ(2.0f, stats.match_count);
+    EXPECT_FLOAT_EQ(2.0f / 2.0f, stats.goal_avg[kwa::LeagueStats::HOME]);
+    EXPECT_FLOAT_EQ(4.0f / 2.0f, stats.goal_avg[kwa::LeagueStats::AWAY]);
+    EXPECT_FLOAT_EQ(6.0f / 4.0f, stats.goal_avg[kwa::LeagueStats::TOTAL]);
+
+    EXPECT_EQ(4, provider.getLeagueStatsBefore(10, stats));
+    EXPECT_FLOAT_EQ(6.0f / 4.0f, stats.goal_avg[kwa::LeagueStats::HOME]);
+    EXPECT_FLOAT_EQ(5.0f / 4.0f, stats.goal_avg[kwa::LeagueStats::AWAY]);
+
+    // the last two matches before day 3
+    EXPECT_EQ(2, provider.getLeagueStatsBefore(3, 2, stats));
+    EXPECT_FLOAT_EQ(2.0f, stats.match_count);
+    EXPECT_FLOAT_EQ(6.0f / 2.0f, stats.goal_avg[kwa::LeagueStats::HOME]);
+    EXPECT_FLOAT_EQ(4.0f / 2.0f, stats.goal_avg[kwa::LeagueStats::AWAY]);
+}
+
+TEST(StatsProvider, get_stats_between_equals_filtered_matches)
+{
+    auto matches = createRandomMatches(500, 6, 5);
+    kwa::StatsProvider provider{};
+    provider.addMatches(matches);
+
+    for (int i = 0; i < 50; ++i) {
+        int from_date = matches[(size_t)std::rand() % matches.size()].day;
+        int to_date = i % 5 == 0 ? -1 : matches[(size_t)std::rand() % matches.size()].day;
+        auto in_range = [from_date, to_date](const kwa::MatchData& m) {
+            return m.day >= from_date && (to_date < 0 || m.day < to_date);
+        };
+
+        int league_count = 0, league_goals = 0;
+        for (auto& m : matches) {
+            if (!in_range(m)) continue;
+            ++league_count;
+            league_goals += m.home_goals;
+        }
+        kwa::LeagueStats league;
+        EXPECT_EQ(league_count > 0 ? league_count : -1,
+                  provider.getLeagueStatsBetween(from_date, to_date, league));
+        if (league_count > 0) {
+            EXPECT_FLOAT_EQ((float)league_goals / (float)league_count,
+                            league.goal_avg[kwa::LeagueStats::HOME]);
+        }
+
+        for (kwa::TeamId team = 0; team < 7; ++team) {
+            int count = 0, goals = 0, against = 0;
+            for (auto& m : matches) {
+                if (m.guest_team != team || !in_range(m)) continue;
+                ++count;
+                goals += m.guest_goals;
+                against += m.home_goals;
+            }
+            EXPECT_EQ(count > 0, provider.hasGuestStatsBetween(team, from_date, to_date));
+
+            kwa::TeamStats stats;
+            EXPECT_EQ(count > 0 ? count : -1,
+                      provider.getGuestStatsBetween(team, from_date, to_date, stats));
+            if (count > 0) {
+                EXPECT_FLOAT_EQ((float)goals / (float)count, stats.goal_avg[kwa::TeamStats::AWAY]);
+                EXPECT_FLOAT_EQ((float)against / (float)count,
+                                stats.against_avg[kwa::TeamStats::AWAY]);
+            }
+        }
+    }
+}
+
+TEST(StatsProvider, get_home_stats_between)
+{
+    kwa::StatsProvider provider{};
+    kwa::MatchData matches[] = {{kwa::match_date(2015, 8, 1), 1, 2, 3, 1},
+                                {kwa::match_date(2015, 8, 8), 1, 3, 1, 1},
+                                {kwa::match_date(2016, 8, 6), 1, 2, 0, 2},
+                                {kwa::match_date(2016, 8, 13), 1, 3, 2, 0}};
+    provider.addMatches(matches);
+
+    kwa::TeamStats stats;
+    EXPECT_EQ(2, provider.getHomeStatsBetween(1, kwa::match_date(2016, 7, 1), -1, stats));
+    EXPECT_FLOAT_EQ(1.0f, stats.goal_avg[kwa::TeamStats::HOME]);
+    EXPECT_FLOAT_EQ(1.0f, stats.against_avg[kwa::TeamStats::HOME]);
+
+    EXPECT_EQ(2, provider.getHomeStatsBetween(1, kwa::match_date(2015, 8, 8),
+                                              kwa::match_date(2016, 8, 13), stats));
+    EXPECT_FLOAT_EQ(0.5f, stats.goal_avg[kwa::TeamStats::HOME]);
+    EXPECT_FLOAT_EQ(1.5f, stats.against_avg[kwa::TeamStats::HOME]);
+
+    EXPECT_EQ(-1, provider.getHomeStatsBetween(1, kwa::match_date(2015, 9, 1),
+                                               kwa::match_date(2016, 8, 1), stats));
+    EXPECT_FALSE(provider.hasHomeStatsBetween(1, kwa::match_date(2015, 9, 1),
+                                              kwa::match_date(2016, 8, 1)));
+    EXPECT_TRUE(provider.hasHomeStatsBetween(1, kwa::match_date(2015, 9, 1), -1));
+}
+TEST(StatsProvider, get_total_stats_combines_home_and_away)
+{
+    auto matches = createRandomMatches(400, 5, 5);
+    kwa::StatsProvider provider{};
+    provider.addMatches(matches);
+
+    for (kwa::TeamId team = 0; team < 6; ++team) {
+        std::vector<std::pair<int, int>> team_matches;
+        for (auto& m : matches) {
+            if (m.home_team == team) team_matches.emplace_back(m.home_goals, m.guest_goals);
+            if (m.guest_team == team) team_matches.emplace_back(m.guest_goals, m.home_goals);
+        }
+        ASSERT_TRUE(provider.hasTotalStats(team));
+
+        for (size_t num_matches : {team_matches.size(), (size_t)10, (size_t)1}) {
+            int goals = 0, against = 0;
+            for (size_t i = team_matches.size() - num_matches; i < team_matches.size(); ++i) {
+                goals += team_matches[i].first;
+                against += team_matches[i].second;
+            }
+
+            kwa::TeamStats stats;
+            EXPECT_EQ((int)num_matches, provider.getTotalStats(team, num_matches, stats));
+            EXPECT_FLOAT_EQ((float)num_matches, stats.match_count[kwa::TeamStats::TOTAL]);
+            EXPECT_FLOAT_EQ((float)goals / (float)num_matches,
+                            stats.goal_avg[kwa::TeamStats::TOTAL]);
+            EXPECT_FLOAT_EQ((float)against / (float)num_matches,
+                            stats.against_avg[kwa::TeamStats::TOTAL]);
+        }
+    }
+}
+
+TEST(StatsProvider, get_total_stats_before)
+{
+    kwa::StatsProvider provider{};
+    kwa::MatchData matches[] = {{1, 1, 2, 3, 1}, {2, 2, 1, 1, 1}, {3, 3, 1, 0, 2}, {4, 1, 3, 2, 0}};
+    provider.addMatches(matches);
+
+    kwa::TeamStats stats;
+    EXPECT_FALSE(provider.hasTotalStats(1, 1));
+    EXPECT_TRUE(provider.hasTotalStats(1, 2));
+    EXPECT_EQ(-1, provider.getTotalStatsBefore(1, 1, stats));
+
+    EXPECT_EQ(3, provider.getTotalStatsBefore(1, 4, stats));
+    EXPECT_FLOAT_EQ(6.0f / 3.0f, stats.goal_avg[kwa::TeamStats::TOTAL]);
+    EXPECT_FLOAT_EQ(2.0f / 3.0f, stats.against_avg[kwa::TeamStats::TOTAL]);
+
+    EXPECT_EQ(2, provider.getTotalStatsBefore(1, 4, 2, stats));
+    EXPECT_FLOAT_EQ(3.0f / 2.0f, stats.goal_avg[kwa::TeamStats::TOTAL]);
+
+    EXPECT_EQ(2, provider.getTotalStatsBetween(1, 2, 4, stats));
+    EXPECT_FLOAT_EQ(1.0f / 2.0f, stats.against_avg[kwa::TeamStats::TOTAL]);
+
+    EXPECT_EQ(4, provider.getTotalStats(1, stats));
+    EXPECT_FLOAT_EQ(8.0f / 4.0f, stats.goal_avg[kwa::TeamStats::TOTAL]);
+}
 } // namespace
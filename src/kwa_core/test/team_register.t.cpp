@@ -0,0 +1,66 @@
+#include "kwa_core/team_register.h"
+#include "gtest/gtest.h"
+#include <string>
+
+namespace {
+TEST(TeamRegister, def_constr_is_empty)
+{
+    kwa::TeamRegister team_register;
+    EXPECT_EQ(0, team_register.size());
+    EXPECT_EQ(kwa::INVALID_TEAM_ID, team_register.getId("Munich"));
+}
+
+TEST(TeamRegister, register_team_returns_same_id_for_same_name)
+{
+    kwa::TeamRegister team_register;
+    EXPECT_EQ(0, team_register.registerTeam("Munich"));
+    EXPECT_EQ(1, team_register.registerTeam("Bremen"));
+    EXPECT_EQ(0, team_register.registerTeam("Munich"));
+    EXPECT_EQ(2, team_register.size());
+
+    EXPECT_EQ(1, team_register.getId("Bremen"));
+    EXPECT_EQ(kwa::INVALID_TEAM_ID, team_register.getId("Brem"));
+    EXPECT_STREQ("Bremen", team_register.teamName(1).data());
+    EXPECT_EQ(6, team_register.teamName(1).size());
+}
+
+TEST(TeamRegister, names_do_not_need_zero_termination)
+{
+    const char line[] = "Hertha,Hamburg";
+    kwa::TeamRegister team_register;
+    auto hertha = team_register.registerTeam(gsl::cstring_span<>(line, 6));
+    auto hamburg = team_register.registerTeam(gsl::cstring_span<>(line + 7, 7));
+
+    EXPECT_EQ(hertha, team_register.getId("Hertha"));
+    EXPECT_EQ(hamburg, team_register.getId(gsl::cstring_span<>(line + 7, 7)));
+    EXPECT_STREQ("Hertha", team_register.teamName(hertha).data());
+    EXPECT_EQ(kwa::INVALID_TEAM_ID, team_register.getId(gsl::cstring_span<>(line, 4)));
+}
+
+TEST(TeamRegister, keeps_ids_when_growing)
+{
+    kwa::TeamRegister team_register;
+    for (int i = 0; i < 1000; ++i)
+        ASSERT_EQ(i, team_register.registerTeam(("Team " + std::to_string(i)).c_str()));
+
+    for (int i = 0; i < 1000; ++i) {
+        auto name = "Team " + std::to_string(i);
+        ASSERT_EQ(i, team_register.getId(name.c_str()));
+        ASSERT_EQ(name, gsl::to_string(team_register.teamName(i)));
+    }
+    EXPECT_EQ(kwa::INVALID_TEAM_ID, team_register.getId("Team 1000"));
+}
+
+TEST(TeamRegister, clear_removes_all_teams)
+{
+    kwa::TeamRegister team_register;
+    team_register.registerTeam("Munich");
+    team_register.registerTeam("");
+    EXPECT_EQ(1, team_register.getId(""));
+
+    team_register.clear();
+    EXPECT_EQ(0, team_register.size());
+    EXPECT_EQ(kwa::INVALID_TEAM_ID, team_register.getId("Munich"));
+    EXPECT_EQ(0, team_register.registerTeam("Bremen"));
+}
+} // namespace
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "kwa_core/match_estimator.h"
+
+namespace kwa_test {
+const char* const TEAMS[] = {"Munich", "Bremen", "Schalke", "Dortmund", "Hamburg", "Mainz"};
+
+/**
+ * A synthetic league the tests fill estimators with. The pairings of a round
+ * rotate and the scores follow a fixed pattern, so every run sees the same matches.
+ */
+struct TestLeague {
+    /// Even number of teams, at most 6. Every team plays about once a round.
+    int team_count = 6;
+    /// Year the first season starts in. 0 dates every round by its number
+    /// instead of via kwa::match_date().
+    int first_year = 0;
+    /// Rounds of a season, one a month on the 10th from August on.
+    int season_rounds = 10;
+    /// Munich (the first team) wins all of its matches 3:0.
+    bool munich_wins = false;
+};
+
+/**
+ * Date of a round, see TestLeague::first_year.
+ */
+inline int roundDate(const TestLeague& league, int round)
+{
+    if (league.first_year == 0) return round;
+    const int month = 8 + round % league.season_rounds;
+    const int year = league.first_year + round / league.season_rounds + (month > 12 ? 1 : 0);
+    return kwa::match_date(year, month > 12 ? month - 12 : month, 10);
+}
+
+/**
+ * Adds the rounds first_round to last_round of the league. The team statistics
+ * are not recalculated.
+ */
+inline void addLeagueRounds(kwa::MatchEstimator& estimator, int first_round, int last_round,
+                            const TestLeague& league = TestLeague())
+{
+    const int n = league.team_count;
+    for (int round = first_round; round <= last_round; ++round) {
+        const int date = roundDate(league, round);
+        for (int i = 0; i < n; i += 2) {
+            const int home = (i + round) % n;
+            const int guest = (home + 1 + round % (n - 1)) % n;
+            if (league.munich_wins && (home == 0 || guest == 0))
+                estimator.addMatch(date, TEAMS[home], TEAMS[guest], home == 0 ? 3 : 0,
+                                   home == 0 ? 0 : 3);
+            else
+                estimator.addMatch(date, TEAMS[home], TEAMS[guest], (round * 7 + i) % 5,
+                                   (round * 3 + i) % 4);
+        }
+    }
+}
+} // namespace kwa_test
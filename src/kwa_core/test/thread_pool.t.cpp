@@ -0,0 +1,51 @@
+#include "thread_pool.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <set>
+
+namespace {
+TEST(ThreadPool, runs_every_task_once)
+{
+    kwa::ThreadPool pool(4);
+    EXPECT_EQ(4, pool.threadCount());
+
+    std::vector<std::atomic<int>> calls(1000);
+    for (auto& count : calls) count = 0;
+    pool.run(calls.size(), [&calls](size_t task) { ++calls[task]; });
+    for (auto& count : calls) EXPECT_EQ(1, count);
+
+    // the workers are reused for the next batch
+    pool.run(3, [&calls](size_t task) { ++calls[task]; });
+    EXPECT_EQ(2, calls[2]);
+    EXPECT_EQ(1, calls[3]);
+    pool.run(0, [&calls](size_t task) { ++calls[task]; });
+}
+
+TEST(ThreadPool, idle_threads_steal_tasks)
+{
+    kwa::ThreadPool pool(4);
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    // the first quarter of the tasks is slow, the other threads steal from it
+    pool.run(64, [&](size_t task) {
+        if (task < 16) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+    });
+    EXPECT_GT(threads.size(), 1);
+}
+
+TEST(ThreadPool, single_thread_runs_on_caller)
+{
+    kwa::ThreadPool pool(1);
+    const auto caller = std::this_thread::get_id();
+    std::vector<size_t> order;
+    pool.run(5, [&](size_t task) {
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        order.push_back(task);
+    });
+    // the owner takes its tasks from the back
+    EXPECT_EQ((std::vector<size_t>{4, 3, 2, 1, 0}), order);
+}
+} // namespace
@@ -0,0 +1,117 @@
+#include "kwa_core/tip_optimizer.h"
+#include "gtest/gtest.h"
+#include "test_league.h"
+
+namespace {
+/**
+ * A season of six teams, Munich wins all of its matches.
+ */
+void addSeason(kwa::MatchEstimator& estimator)
+{
+    kwa_test::TestLeague league;
+    league.first_year = 2016;
+    league.munich_wins = true;
+    kwa_test::addLeagueRounds(estimator, 0, 9, league);
+    estimator.recalculateTeamStatistics();
+}
+
+std::vector<kwa::PoolMatch> matchday(const kwa::MatchEstimator& estimator)
+{
+    const auto& teams = estimator.teamRegister();
+    return {{teams.getId("Munich"), teams.getId("Bremen"), {}},
+            {teams.getId("Schalke"), teams.getId("Dortmund"), {{1, 1, 0.6f}, {2, 1, 0.4f}}},
+            {teams.getId("Hamburg"), teams.getId("Mainz"), {}}};
+}
+
+TEST(TipOptimizer, without_opponents_keeps_best_bets)
+{
+    kwa::MatchEstimator estimator{};
+    addSeason(estimator);
+    const auto matches = matchday(estimator);
+
+    kwa::TipOptimizerSettings settings;
+    settings.opponent_count = 0;
+    settings.scenario_count = 1000;
+    kwa::TipOptimizer optimizer(2);
+    kwa::TipOptimizerResult result;
+    ASSERT_TRUE(optimizer.run(estimator, matches, settings, result));
+    ASSERT_EQ(3, result.tips.size());
+    EXPECT_EQ(1.0, result.win_probability);
+    EXPECT_EQ(1.0, result.best_bet_win_probability);
+    EXPECT_FLOAT_EQ((float)result.best_bet_expected_points, (float)result.expected_points);
+
+    for (size_t m = 0; m < matches.size(); ++m) {
+        kwa::MatchEstimation estimation;
+        estimator.estimate(estimation, matches[m].home_team, matches[m].guest_team,
+                           settings.context);
+        EXPECT_EQ(matches[m].home_team, result.tips[m].home_team);
+        EXPECT_EQ(estimation.best_result_bet_home_goals, result.tips[m].home_goals);
+        EXPECT_EQ(estimation.best_result_bet_guest_goals, result.tips[m].guest_goals);
+    }
+}
+
+TEST(TipOptimizer, behind_the_crowd_tips_contrarian)
+{
+    kwa::MatchEstimator estimator{};
+    addSeason(estimator);
+    const auto& teams = estimator.teamRegister();
+    kwa::MatchEstimation estimation;
+    estimator.estimate(estimation, "Munich", "Bremen");
+
+    // all opponents tip the best bet and are one point ahead, the same tip
+    // can never win
+    const std::vector<kwa::PoolMatch> matches{
+        {teams.getId("Munich"), teams.getId("Bremen"), {}}};
+    kwa::TipOptimizerSettings settings;
+    settings.opponent_leads = {1.0f, 1.0f, 1.0f};
+    settings.scenario_count = 5000;
+    kwa::TipOptimizer optimizer(2);
+    kwa::TipOptimizerResult result;
+    ASSERT_TRUE(optimizer.run(estimator, matches, settings, result));
+    ASSERT_EQ(1, result.tips.size());
+    EXPECT_EQ(0.0, result.best_bet_win_probability);
+    EXPECT_GT(result.win_probability, 0.0);
+    EXPECT_LT(result.expected_points, result.best_bet_expected_points);
+    EXPECT_FALSE(result.tips[0].home_goals == estimation.best_result_bet_home_goals &&
+                 result.tips[0].guest_goals == estimation.best_result_bet_guest_goals);
+}
+
+TEST(TipOptimizer, result_does_not_depend_on_threads)
+{
+    kwa::MatchEstimator estimator{};
+    addSeason(estimator);
+    const auto matches = matchday(estimator);
+
+    kwa::TipOptimizerSettings settings;
+    settings.opponent_count = 20;
+    settings.scenario_count = 3000;
+    settings.seed = 7;
+    kwa::TipOptimizerResult single, parallel;
+    ASSERT_TRUE(kwa::TipOptimizer(1).run(estimator, matches, settings, single));
+    ASSERT_TRUE(kwa::TipOptimizer(4).run(estimator, matches, settings, parallel));
+    EXPECT_EQ(single.win_probability, parallel.win_probability);
+    EXPECT_EQ(single.best_bet_win_probability, parallel.best_bet_win_probability);
+    for (size_t m = 0; m < matches.size(); ++m) {
+        EXPECT_EQ(single.tips[m].home_goals, parallel.tips[m].home_goals);
+        EXPECT_EQ(single.tips[m].guest_goals, parallel.tips[m].guest_goals);
+    }
+    // the search starts at the best bets and only accepts improvements, on
+    // fresh matchdays they can be a bit worse by chance
+    EXPECT_GT(single.win_probability, single.best_bet_win_probability - 0.02);
+    EXPECT_LE(single.expected_points, single.best_bet_expected_points + 1e-6);
+
+    // without a choice both are measured on the same fresh matchdays
+    settings.candidate_count = 1;
+    ASSERT_TRUE(kwa::TipOptimizer(2).run(estimator, matches, settings, single));
+    EXPECT_EQ(single.best_bet_win_probability, single.win_probability);
+
+    // a team without statistics
+    estimator.addMatch(kwa::match_date(2017, 1, 1), "Munich", "Augsburg", 1, 0);
+    estimator.recalculateTeamStatistics();
+    const std::vector<kwa::PoolMatch> unknown{
+        {estimator.teamRegister().getId("Augsburg"), estimator.teamRegister().getId("Munich"),
+         {}}};
+    EXPECT_FALSE(kwa::TipOptimizer(1).run(estimator, unknown, settings, single));
+    EXPECT_TRUE(single.tips.empty());
+}
+} // namespace
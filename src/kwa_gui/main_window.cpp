@@ -37,7 +37,7 @@ void MainWindow::onLoadMatches()
 {
     clearMessages();
     const auto current_match_count = m_estimator.matchCount();
-    if(!kwa::loadMatchesFromCSVFile(m_estimator, m_ui->lineEdit->text().toStdString().c_str())) {
+    if(!kwa::loadMatchesFromMappedCSVFile(m_estimator, m_ui->lineEdit->text().toStdString().c_str())) {
         printMessage("[ERROR] Could not load matches from file.");
         return;
     }
@@ -55,11 +55,12 @@ void MainWindow::updateTeamChooser()
     const auto& team_register = m_estimator.teamRegister();
     for(size_t i = 0; i < team_register.size(); ++i) {
         const kwa::TeamId team_id = static_cast<int>(i);
-        if(m_estimator.hasHomeStatistics(team_register.teamName(team_id).c_str())) {
-            m_ui->homeTeamBox->addItem(QString::fromStdString(team_register.teamName(team_id)));
+        const auto team_name = team_register.teamName(team_id);
+        if(m_estimator.hasHomeStatistics(team_name.data())) {
+            m_ui->homeTeamBox->addItem(QString::fromUtf8(team_name.data(), static_cast<int>(team_name.size())));
         }
-        if(m_estimator.hasGuestStatistics(team_register.teamName(team_id).c_str())) {
-            m_ui->guestTeamBox->addItem(QString::fromStdString(team_register.teamName(team_id)));
+        if(m_estimator.hasGuestStatistics(team_name.data())) {
+            m_ui->guestTeamBox->addItem(QString::fromUtf8(team_name.data(), static_cast<int>(team_name.size())));
         }
     }
     if(m_ui->homeTeamBox->count() > 0 && m_ui->guestTeamBox->count() > 0) {